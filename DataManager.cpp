@@ -1,155 +1,476 @@
-#include "DataManager.h"
-#include "CalibrationManager.h"
-#include "config.h"
-#include <time.h>
-
-DataManager::DataManager() {
-}
-
-void DataManager::begin() {
-  Serial.println("[DataManager] Initializing data manager...");
-  count = 0;
-  writeIndex = 0;
-  firstMeasurementTime = 0;
-  Serial.println("[DataManager] Data manager ready");
-}
-
-void DataManager::setCalibrationManager(CalibrationManager* calibMgr) {
-  calibrationMgr = calibMgr;
-  Serial.println("[DataManager] Calibration manager set");
-}
-
-void DataManager::addMeasurement(uint16_t thickness, float risePercentage) {
-  time_t currentTime = time(nullptr);
-  
-  Serial.printf("[DataManager] Adding measurement: %d mm, Rise: %.1f%%, Timestamp: %ld\n", 
-                thickness, risePercentage, currentTime);
-  
-  // First measurement sets the baseline time
-  if (count == 0) {
-    firstMeasurementTime = currentTime;
-  }
-  
-  // Add to circular buffer
-  buffer[writeIndex].timestamp = currentTime;
-  buffer[writeIndex].thickness = thickness;
-  buffer[writeIndex].risePercentage = risePercentage;
-  
-  writeIndex = (writeIndex + 1) % MAX_POINTS;
-  
-  if (count < MAX_POINTS) {
-    count++;
-  }
-  
-  Serial.printf("[DataManager] Total measurements: %d\n", count);
-}
-
-uint16_t DataManager::getCount() {
-  return count;
-}
-
-DataPoint DataManager::getMeasurement(uint16_t index) {
-  if (index >= count) {
-    DataPoint empty = {0, 0, 0.0};
-    return empty;
-  }
-  
-  // Calculate actual buffer index (circular) - add MAX_POINTS to prevent underflow
-  uint16_t bufferIndex = (writeIndex - count + index + MAX_POINTS) % MAX_POINTS;
-  return buffer[bufferIndex];
-}
-
-String DataManager::getAllMeasurementsJSON() {
-  // Pre-allocate: estimate ~60 bytes per measurement to reduce reallocations
-  String json;
-  json.reserve(count * 60 + 10);
-  json = "[";
-  
-  for (uint16_t i = 0; i < count; i++) {
-    DataPoint dp = getMeasurement(i);
-    
-    if (i > 0) json += ",";
-    
-    // Convert timestamp to 24-hour format
-    time_t t = dp.timestamp;
-    struct tm *timeinfo = localtime(&t);
-    
-    char timeBuffer[20];
-    strftime(timeBuffer, sizeof(timeBuffer), "%H:%M:%S", timeinfo);
-    
-    json += "{\"time\":\"";
-    json += timeBuffer;
-    json += "\",\"thickness\":";
-    json += dp.thickness;
-    json += ",\"rise\":";
-    json += dp.risePercentage;
-    json += "}";
-  }
-  
-  json += "]";
-  return json;
-}
-
-uint16_t DataManager::getInitialThickness() {
-  if (count == 0) return 0;
-  return getMeasurement(0).thickness;
-}
-
-uint16_t DataManager::getCurrentThickness() {
-  if (count == 0) return 0;
-  return getMeasurement(count - 1).thickness;
-}
-
-float DataManager::getCurrentRisePercentage() {
-  if (count == 0) return 0.0;
-  return getMeasurement(count - 1).risePercentage;
-}
-
-unsigned long DataManager::getElapsedTime() {
-  if (count == 0) return 0;
-  
-  // If calibration manager is set, use calibration time as reference
-  // Otherwise, fall back to first measurement time
-  unsigned long baselineTime = firstMeasurementTime;
-  if (calibrationMgr != nullptr) {
-    unsigned long calibTime = calibrationMgr->getCalibrationTime();
-    if (calibTime != 0) {
-      baselineTime = calibTime;
-    }
-  }
-  
-  unsigned long now = time(nullptr);
-  return now - baselineTime;
-}
-
-void DataManager::reset() {
-  Serial.println("[DataManager] Resetting all measurement data...");
-  count = 0;
-  writeIndex = 0;
-  firstMeasurementTime = 0;
-  
-  // Clear buffer
-  for (uint16_t i = 0; i < MAX_POINTS; i++) {
-    buffer[i] = {0, 0, 0.0};
-  }
-  
-  Serial.println("[DataManager] Data reset complete");
-}
-
-bool DataManager::hasData() {
-  return count > 0;
-}
-
-unsigned long DataManager::getLastMeasurementTime() {
-  if (count == 0) return 0;
-  return getMeasurement(count - 1).timestamp;
-}
-
-String DataManager::formatTime24H(unsigned long timestamp) {
-  time_t t = timestamp;
-  struct tm *timeinfo = localtime(&t);
-  
-  char buffer[20];
-  strftime(buffer, sizeof(buffer), "%H:%M:%S", timeinfo);
-  return String(buffer);
-}
+#include "DataManager.h"
+#include "CalibrationManager.h"
+#include "config.h"
+#include "Log.h"
+#include <time.h>
+
+DataManager::DataManager() {
+}
+
+void DataManager::begin() {
+  LOG_I(Data, "[DataManager] Initializing data manager...\n");
+  count = 0;
+  writeIndex = 0;
+  rawDropped = false;
+  hourly.reset();
+  sixHourly.reset();
+  resetStats();
+  forecast.reset();
+  firstMeasurementTime = 0;
+  LOG_I(Data, "[DataManager] Data manager ready\n");
+}
+
+void DataManager::setCalibrationManager(CalibrationManager* calibMgr) {
+  calibrationMgr = calibMgr;
+  LOG_I(Data, "[DataManager] Calibration manager set\n");
+}
+
+void DataManager::addMeasurement(uint16_t thickness, RiseFixed rise) {
+  time_t currentTime = time(nullptr);
+  
+  LOG_D(Data, "[DataManager] Adding measurement: %d mm, Rise: %.2f%%, Timestamp: %ld\n", 
+                thickness, riseToPercent(rise), currentTime);
+  
+  // First measurement sets the baseline time
+  if (count == 0) {
+    firstMeasurementTime = currentTime;
+  }
+  
+  // The oldest point is about to be overwritten; drop it from the rate
+  // window first if it is still part of it
+  if (count == MAX_POINTS && stats.windowCount == count) {
+    addToWindow(at(0), -1);
+    stats.windowCount--;
+  }
+  
+  // Add to circular buffer
+  buffer[writeIndex].timestamp = currentTime;
+  buffer[writeIndex].thickness = thickness;
+  buffer[writeIndex].rise = rise;
+  updateStats(buffer[writeIndex]);
+  
+  writeIndex = (writeIndex + 1) % MAX_POINTS;
+  
+  if (count < MAX_POINTS) {
+    count++;
+  } else {
+    rawDropped = true;
+  }
+  
+  // Rollups are updated as points arrive, so the raw ring can overwrite its
+  // oldest point without any compaction work
+  hourly.add(currentTime, thickness, rise);
+  sixHourly.add(currentTime, thickness, rise);
+  forecast.update(currentTime, riseToPercent(rise));
+  
+  // Points older than the rate window leave it, oldest first
+  while (stats.windowCount > 1 &&
+         at(count - stats.windowCount).timestamp + RISE_RATE_WINDOW < (unsigned long)currentTime) {
+    addToWindow(at(count - stats.windowCount), -1);
+    stats.windowCount--;
+  }
+  
+  LOG_D(Data, "[DataManager] Total measurements: %d\n", count);
+}
+
+void DataManager::updateStats(const DataPoint& dp) {
+  if (stats.samples == 0 || dp.rise > stats.peakRise) {
+    stats.peakRise = dp.rise;
+    stats.peakTime = dp.timestamp;
+  }
+  if (stats.samples == 0) {
+    stats.minRise = stats.maxRise = dp.rise;
+    stats.minThickness = stats.maxThickness = dp.thickness;
+  } else {
+    if (dp.rise < stats.minRise) stats.minRise = dp.rise;
+    if (dp.rise > stats.maxRise) stats.maxRise = dp.rise;
+    if (dp.thickness < stats.minThickness) stats.minThickness = dp.thickness;
+    if (dp.thickness > stats.maxThickness) stats.maxThickness = dp.thickness;
+  }
+  stats.sumRise += dp.rise;
+  stats.sumThickness += dp.thickness;
+  stats.samples++;
+  
+  addToWindow(dp, 1);
+  stats.windowCount++;
+}
+
+void DataManager::addToWindow(const DataPoint& dp, double sign) {
+  double t = (double)((long)(dp.timestamp - firstMeasurementTime));
+  stats.sumT += sign * t;
+  stats.sumT2 += sign * t * t;
+  stats.sumThicknessT += sign * t * dp.thickness;
+  stats.sumWindowThickness += sign * dp.thickness;
+  stats.sumRiseT += sign * t * dp.rise;
+  stats.sumWindowRise += sign * dp.rise;
+}
+
+// Least-squares slope of y over the window, per second
+double DataManager::windowSlope(double sumYT, double sumY) {
+  double n = stats.windowCount;
+  if (n < 2) return NAN;
+  double denominator = n * stats.sumT2 - stats.sumT * stats.sumT;
+  if (denominator < 1e-6) return NAN;  // All points at the same time
+  return (n * sumYT - stats.sumT * sumY) / denominator;
+}
+
+float DataManager::getRiseRateMmPerHour() {
+  return windowSlope(stats.sumThicknessT, stats.sumWindowThickness) * 3600.0;
+}
+
+float DataManager::getRiseRatePercentPerHour() {
+  return windowSlope(stats.sumRiseT, stats.sumWindowRise) * 3600.0 / RISE_SCALE;
+}
+
+unsigned long DataManager::getTimeSincePeak() {
+  if (stats.samples == 0) return 0;
+  unsigned long now = time(nullptr);
+  return now > stats.peakTime ? now - stats.peakTime : 0;
+}
+
+void DataManager::writeStatsJSON(JsonWriter& json) {
+  bool any = stats.samples > 0;
+  json.beginObject();
+  writeRise(json, "peakRise", stats.peakRise, any);
+  writeUnsigned(json, "peakTime", stats.peakTime, any);
+  writeUnsigned(json, "sincePeak", getTimeSincePeak(), any);
+  json.field("riseRateMmPerHour", getRiseRateMmPerHour());
+  json.field("riseRatePercentPerHour", getRiseRatePercentPerHour());
+  json.field("rateWindow", (unsigned long)RISE_RATE_WINDOW);
+  writeRise(json, "riseMin", stats.minRise, any);
+  writeRise(json, "riseMax", stats.maxRise, any);
+  writeRise(json, "riseMean", any ? roundedDivide(stats.sumRise, (int64_t)stats.samples) : 0, any);
+  writeUnsigned(json, "thicknessMin", stats.minThickness, any);
+  writeUnsigned(json, "thicknessMax", stats.maxThickness, any);
+  json.field("thicknessMean", any ? (double)stats.sumThickness / stats.samples : NAN, 1);
+  json.endObject();
+}
+
+// Rise member in percent, or null when there is nothing to report
+void DataManager::writeRise(JsonWriter& json, const char* name, RiseFixed rise, bool valid) {
+  json.key(name);
+  if (valid) {
+    json.valueFixed(rise, RISE_DECIMALS);
+  } else {
+    json.valueNull();
+  }
+}
+
+// Time or distance member, or null when there is nothing to report
+void DataManager::writeUnsigned(JsonWriter& json, const char* name, unsigned long value, bool valid) {
+  json.key(name);
+  if (valid) {
+    json.value(value);
+  } else {
+    json.valueNull();
+  }
+}
+
+void DataManager::resetStats() {
+  stats = DataStats();
+}
+
+uint16_t DataManager::getCount() {
+  return count;
+}
+
+DataPoint DataManager::getMeasurement(uint16_t index) {
+  if (index >= count) {
+    DataPoint empty = {0, 0, 0};
+    return empty;
+  }
+  
+  return at(index);
+}
+
+DataManager::Range DataManager::all() const {
+  return {Iterator(this, 0), Iterator(this, count)};
+}
+
+DataManager::Range DataManager::range(unsigned long from, unsigned long to) const {
+  uint16_t first = lowerBound(from);
+  uint16_t last = from <= to ? upperBound(to) : first;
+  if (last < first) last = first;
+  return {Iterator(this, first), Iterator(this, last)};
+}
+
+void DataManager::writeMeasurementsJSON(JsonWriter& json, uint16_t maxPoints) {
+  json.beginArray();
+  writePoints(json, all(), maxPoints);
+  json.endArray();
+}
+
+void DataManager::writePoints(JsonWriter& json, const Range& points, uint16_t maxPoints) {
+  if (maxPoints > 0 && points.size() > maxPoints) {
+    writeDownsampled(json, points, maxPoints);
+    return;
+  }
+  for (const DataPoint& dp : points) {
+    writePoint(json, dp);
+  }
+}
+
+void DataManager::writePoint(JsonWriter& json, const DataPoint& dp) {
+  // Convert timestamp to 24-hour format
+  time_t t = dp.timestamp;
+  struct tm *timeinfo = localtime(&t);
+  
+  char timeBuffer[20];
+  strftime(timeBuffer, sizeof(timeBuffer), "%H:%M:%S", timeinfo);
+  
+  json.beginObject();
+  json.field("time", timeBuffer);
+  json.field("timestamp", dp.timestamp);
+  json.field("thickness", dp.thickness);
+  json.fieldFixed("rise", dp.rise, RISE_DECIMALS);
+  json.endObject();
+}
+
+// Largest-Triangle-Three-Buckets: keep the first and last point and split the
+// rest into maxPoints - 2 buckets. From each bucket emit the point forming the
+// largest triangle with the point emitted before it and the average of the
+// next bucket. Points are read straight from the ring (each at most twice)
+// and emitted as they are chosen, so no output buffer is needed.
+void DataManager::writeDownsampled(JsonWriter& json, const Range& points, uint16_t maxPoints) {
+  if (maxPoints < 3) maxPoints = 3;
+  const uint16_t first = points.first.position();
+  const uint16_t last = points.last.position();
+  const uint16_t buckets = maxPoints - 2;
+  
+  // Bucket b covers [bucketStart(b), bucketStart(b + 1)) of the inner points
+  auto bucketStart = [&](uint16_t b) -> uint16_t {
+    return first + 1 + (uint16_t)((uint32_t)b * (points.size() - 2) / buckets);
+  };
+  
+  const DataPoint* selected = &at(first);
+  writePoint(json, *selected);
+  
+  // All integer: times relative to the first point, and the next bucket's
+  // average kept as a sum so the areas below are scaled by its size n
+  const unsigned long origin = selected->timestamp;
+  
+  for (uint16_t b = 0; b < buckets; b++) {
+    uint16_t start = bucketStart(b);
+    uint16_t end = bucketStart(b + 1);
+    
+    // Sum over the next bucket (the last point for the final bucket)
+    int64_t sumX = 0, sumY = 0;
+    uint16_t nextStart = end;
+    uint16_t nextEnd = b + 1 < buckets ? bucketStart(b + 2) : last;
+    for (uint16_t i = nextStart; i < nextEnd; i++) {
+      const DataPoint& dp = at(i);
+      sumX += (int64_t)(dp.timestamp - origin);
+      sumY += dp.rise;
+    }
+    int64_t n = nextEnd - nextStart;
+    
+    int64_t ax = (int64_t)(selected->timestamp - origin);
+    int64_t ay = selected->rise;
+    int64_t bestArea = -1;
+    const DataPoint* best = selected;
+    for (uint16_t i = start; i < end; i++) {
+      const DataPoint& dp = at(i);
+      int64_t x = (int64_t)(dp.timestamp - origin);
+      // Twice the triangle area times n; the factors do not change the choice
+      int64_t area = (ax * n - sumX) * (dp.rise - ay) - (ax - x) * (sumY - ay * n);
+      if (area < 0) area = -area;
+      if (area > bestArea) {
+        bestArea = area;
+        best = &dp;
+      }
+    }
+    
+    writePoint(json, *best);
+    selected = best;
+  }
+  
+  writePoint(json, at(last - 1));
+}
+
+void Rollup::add(uint16_t thickness, RiseFixed rise) {
+  if (count == 0) {
+    minThickness = maxThickness = thickness;
+    minRise = maxRise = rise;
+  } else {
+    if (thickness < minThickness) minThickness = thickness;
+    if (thickness > maxThickness) maxThickness = thickness;
+    if (rise < minRise) minRise = rise;
+    if (rise > maxRise) maxRise = rise;
+  }
+  if (count < UINT16_MAX) count++;
+  sumThickness += thickness;
+  sumRise += rise;
+}
+
+void Rollup::merge(const Rollup& other) {
+  if (other.count == 0) return;
+  if (count == 0) {
+    *this = other;
+    return;
+  }
+  if (other.minThickness < minThickness) minThickness = other.minThickness;
+  if (other.maxThickness > maxThickness) maxThickness = other.maxThickness;
+  if (other.minRise < minRise) minRise = other.minRise;
+  if (other.maxRise > maxRise) maxRise = other.maxRise;
+  count = (uint32_t)count + other.count > UINT16_MAX ? UINT16_MAX : count + other.count;
+  sumThickness += other.sumThickness;
+  sumRise += other.sumRise;
+}
+
+DataTier DataManager::selectTier(unsigned long from) {
+  if (!rawDropped || (count > 0 && getMeasurement(0).timestamp <= from)) {
+    return TIER_RAW;
+  }
+  if (!hourly.hasDropped() || (hourly.getCount() > 0 && hourly.get(0).start <= from)) {
+    return TIER_HOURLY;
+  }
+  return TIER_SIX_HOURLY;
+}
+
+void DataManager::writeRangeJSON(JsonWriter& json, unsigned long from, unsigned long to, uint16_t maxPoints) {
+  json.beginArray();
+  
+  if (from <= to) {
+    switch (selectTier(from)) {
+      case TIER_RAW:
+        writePoints(json, range(from, to), maxPoints);
+        break;
+      case TIER_HOURLY:
+        writeRollups(json, hourly, hourly.lowerBound(from), hourly.upperBound(to), maxPoints);
+        break;
+      case TIER_SIX_HOURLY:
+        writeRollups(json, sixHourly, sixHourly.lowerBound(from), sixHourly.upperBound(to), maxPoints);
+        break;
+    }
+  }
+  
+  json.endArray();
+}
+
+// Timestamps are appended in order, so the ring is sorted oldest to newest
+uint16_t DataManager::lowerBound(unsigned long from) const {
+  uint16_t low = 0, high = count;
+  while (low < high) {
+    uint16_t mid = low + (high - low) / 2;
+    if (at(mid).timestamp < from) low = mid + 1;
+    else high = mid;
+  }
+  return low;
+}
+
+uint16_t DataManager::upperBound(unsigned long to) const {
+  uint16_t low = 0, high = count;
+  while (low < high) {
+    uint16_t mid = low + (high - low) / 2;
+    if (at(mid).timestamp <= to) low = mid + 1;
+    else high = mid;
+  }
+  return low;
+}
+
+template <uint16_t CAPACITY>
+void DataManager::writeRollups(JsonWriter& json, const RollupTier<CAPACITY>& tier,
+                               uint16_t first, uint16_t last, uint16_t maxPoints) {
+  uint16_t buckets = last > first ? last - first : 0;
+  uint16_t run = 1;
+  if (maxPoints > 0 && buckets > maxPoints) {
+    run = (buckets + maxPoints - 1) / maxPoints;
+  }
+  
+  for (uint16_t i = first; i < last; i += run) {
+    Rollup merged = tier.get(i);
+    for (uint16_t j = i + 1; j < i + run && j < last; j++) {
+      merged.merge(tier.get(j));
+    }
+    writeRollup(json, merged);
+  }
+}
+
+void DataManager::writeRollup(JsonWriter& json, const Rollup& rollup) {
+  time_t t = rollup.start;
+  struct tm *timeinfo = localtime(&t);
+  
+  char timeBuffer[20];
+  strftime(timeBuffer, sizeof(timeBuffer), "%H:%M:%S", timeinfo);
+  
+  json.beginObject();
+  json.field("time", timeBuffer);
+  json.field("timestamp", rollup.start);
+  json.field("thickness", (double)rollup.sumThickness / rollup.count, 1);
+  json.fieldFixed("rise", roundedDivide(rollup.sumRise, (int64_t)rollup.count), RISE_DECIMALS);
+  json.field("thicknessMin", rollup.minThickness);
+  json.field("thicknessMax", rollup.maxThickness);
+  json.fieldFixed("riseMin", rollup.minRise, RISE_DECIMALS);
+  json.fieldFixed("riseMax", rollup.maxRise, RISE_DECIMALS);
+  json.field("count", rollup.count);
+  json.endObject();
+}
+
+uint16_t DataManager::getInitialThickness() {
+  if (count == 0) return 0;
+  return getMeasurement(0).thickness;
+}
+
+uint16_t DataManager::getCurrentThickness() {
+  if (count == 0) return 0;
+  return getMeasurement(count - 1).thickness;
+}
+
+RiseFixed DataManager::getCurrentRise() {
+  if (count == 0) return 0;
+  return getMeasurement(count - 1).rise;
+}
+
+unsigned long DataManager::getElapsedTime() {
+  if (count == 0) return 0;
+  
+  // If calibration manager is set, use calibration time as reference
+  // Otherwise, fall back to first measurement time
+  unsigned long baselineTime = firstMeasurementTime;
+  if (calibrationMgr != nullptr) {
+    unsigned long calibTime = calibrationMgr->getCalibrationTime();
+    if (calibTime != 0) {
+      baselineTime = calibTime;
+    }
+  }
+  
+  unsigned long now = time(nullptr);
+  return now - baselineTime;
+}
+
+void DataManager::reset() {
+  LOG_I(Data, "[DataManager] Resetting all measurement data...\n");
+  count = 0;
+  writeIndex = 0;
+  rawDropped = false;
+  hourly.reset();
+  sixHourly.reset();
+  resetStats();
+  forecast.reset();
+  firstMeasurementTime = 0;
+  
+  // Clear buffer
+  for (uint16_t i = 0; i < MAX_POINTS; i++) {
+    buffer[i] = {0, 0, 0};
+  }
+  
+  LOG_I(Data, "[DataManager] Data reset complete\n");
+}
+
+bool DataManager::hasData() {
+  return count > 0;
+}
+
+unsigned long DataManager::getLastMeasurementTime() {
+  if (count == 0) return 0;
+  return getMeasurement(count - 1).timestamp;
+}
+
+String DataManager::formatTime24H(unsigned long timestamp) {
+  time_t t = timestamp;
+  struct tm *timeinfo = localtime(&t);
+  
+  char buffer[20];
+  strftime(buffer, sizeof(buffer), "%H:%M:%S", timeinfo);
+  return String(buffer);
+}
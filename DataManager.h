@@ -1,70 +1,301 @@
-#ifndef DATA_MANAGER_H
-#define DATA_MANAGER_H
-
-#include <Arduino.h>
-#include "config.h"
-
-class CalibrationManager;  // Forward declaration
-
-struct DataPoint {
-  unsigned long timestamp;    // Unix timestamp in seconds
-  uint16_t thickness;         // Dough thickness in mm
-  float risePercentage;       // Rise percentage from initial thickness
-};
-
-class DataManager {
-public:
-  DataManager();
-  
-  // Initialize data manager
-  void begin();
-  
-  // Set calibration manager pointer (for getting calibration time)
-  void setCalibrationManager(CalibrationManager* calibMgr);
-  
-  // Add a new measurement
-  void addMeasurement(uint16_t thickness, float risePercentage);
-  
-  // Get measurement count
-  uint16_t getCount();
-  
-  // Get measurement at index (0 = oldest)
-  DataPoint getMeasurement(uint16_t index);
-  
-  // Get all measurements as JSON string
-  String getAllMeasurementsJSON();
-  
-  // Get initial thickness
-  uint16_t getInitialThickness();
-  
-  // Get current thickness
-  uint16_t getCurrentThickness();
-  
-  // Get current rise percentage
-  float getCurrentRisePercentage();
-  
-  // Get time since first measurement (seconds)
-  unsigned long getElapsedTime();
-  
-  // Reset all data
-  void reset();
-  
-  // Check if has data
-  bool hasData();
-  
-  // Get last measurement time
-  unsigned long getLastMeasurementTime();
-  
-private:
-  static const uint16_t MAX_POINTS = MAX_DATA_POINTS;
-  DataPoint buffer[MAX_DATA_POINTS];
-  uint16_t count = 0;
-  uint16_t writeIndex = 0;  // Circular buffer index
-  unsigned long firstMeasurementTime = 0;
-  CalibrationManager* calibrationMgr = nullptr;
-  
-  // Helper to format timestamp
-  String formatTime24H(unsigned long timestamp);
-};
-
-#endif
+#ifndef DATA_MANAGER_H
+#define DATA_MANAGER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "JsonWriter.h"
+#include "FixedPoint.h"
+#include "RiseForecast.h"
+
+class CalibrationManager;  // Forward declaration
+
+struct DataPoint {
+  unsigned long timestamp;    // Unix timestamp in seconds
+  uint16_t thickness;         // Dough thickness in mm
+  RiseFixed rise;             // Rise from initial thickness, hundredths of a percent
+};
+
+// Min/max/mean of the measurements in one time bucket
+struct Rollup {
+  unsigned long start;        // Bucket start, aligned to the tier period
+  uint16_t count;
+  uint16_t minThickness;
+  uint16_t maxThickness;
+  uint32_t sumThickness;
+  RiseFixed minRise;
+  RiseFixed maxRise;
+  int64_t sumRise;
+  
+  void add(uint16_t thickness, RiseFixed rise);
+  void merge(const Rollup& other);
+};
+
+// Aggregates kept up to date by addMeasurement(), O(1) per point
+struct DataStats {
+  RiseFixed peakRise;         // Highest rise so far and when it was measured
+  unsigned long peakTime;
+  RiseFixed minRise;
+  RiseFixed maxRise;
+  int64_t sumRise;
+  uint16_t minThickness;
+  uint16_t maxThickness;
+  uint32_t sumThickness;
+  uint32_t samples;
+  
+  // Least-squares sums over the last RISE_RATE_WINDOW seconds, with times
+  // relative to the first measurement. Kept in double: they hold squared
+  // times that would overflow integers after a clock step, and cost a few
+  // operations once per measurement.
+  uint16_t windowCount;
+  double sumT;
+  double sumT2;
+  double sumThicknessT;
+  double sumWindowThickness;
+  double sumRiseT;
+  double sumWindowRise;
+};
+
+// Storage resolutions, finest first
+enum DataTier : uint8_t {
+  TIER_RAW,
+  TIER_HOURLY,
+  TIER_SIX_HOURLY
+};
+
+/*
+ * Ring of time-aligned rollups. Every measurement is folded into the newest
+ * bucket (or starts a new one) in O(1); once the ring is full the oldest
+ * bucket is dropped. Buckets are in time order, so ranges are found by
+ * binary search.
+ */
+template <uint16_t CAPACITY>
+class RollupTier {
+public:
+  explicit RollupTier(unsigned long period) : period(period) {}
+  
+  void add(unsigned long timestamp, uint16_t thickness, RiseFixed rise) {
+    unsigned long start = timestamp - timestamp % period;
+    if (count > 0) {
+      Rollup& newest = slots[(writeIndex + CAPACITY - 1) % CAPACITY];
+      // Same bucket, or the clock stepped back: keep filling the newest one
+      if (start <= newest.start) {
+        newest.add(thickness, rise);
+        return;
+      }
+    }
+    Rollup& slot = slots[writeIndex];
+    slot = {start, 0, 0, 0, 0, 0, 0, 0};
+    slot.add(thickness, rise);
+    writeIndex = (writeIndex + 1) % CAPACITY;
+    if (count < CAPACITY) {
+      count++;
+    } else {
+      dropped = true;
+    }
+  }
+  
+  void reset() {
+    count = 0;
+    writeIndex = 0;
+    dropped = false;
+  }
+  
+  uint16_t getCount() const { return count; }
+  unsigned long getPeriod() const { return period; }
+  
+  // True once buckets have been overwritten, i.e. history is incomplete
+  bool hasDropped() const { return dropped; }
+  
+  // Bucket at index (0 = oldest)
+  const Rollup& get(uint16_t index) const {
+    return slots[(writeIndex + CAPACITY - count + index) % CAPACITY];
+  }
+  
+  // Index of the first bucket that ends after from
+  uint16_t lowerBound(unsigned long from) const {
+    uint16_t low = 0, high = count;
+    while (low < high) {
+      uint16_t mid = low + (high - low) / 2;
+      if (get(mid).start + period <= from) low = mid + 1;
+      else high = mid;
+    }
+    return low;
+  }
+  
+  // Index of the first bucket that starts after to
+  uint16_t upperBound(unsigned long to) const {
+    uint16_t low = 0, high = count;
+    while (low < high) {
+      uint16_t mid = low + (high - low) / 2;
+      if (get(mid).start <= to) low = mid + 1;
+      else high = mid;
+    }
+    return low;
+  }
+  
+private:
+  Rollup slots[CAPACITY];
+  uint16_t count = 0;
+  uint16_t writeIndex = 0;
+  bool dropped = false;
+  const unsigned long period;
+};
+
+class DataManager {
+public:
+  // Forward iterator over the raw ring in time order. Dereferencing yields
+  // a reference into the ring itself, so walking a range copies nothing.
+  // Invalidated by addMeasurement() and reset().
+  class Iterator {
+  public:
+    Iterator(const DataManager* owner, uint16_t index) : owner(owner), index(index) {}
+    const DataPoint& operator*() const { return owner->at(index); }
+    const DataPoint* operator->() const { return &owner->at(index); }
+    Iterator& operator++() { index++; return *this; }
+    bool operator==(const Iterator& other) const { return index == other.index; }
+    bool operator!=(const Iterator& other) const { return index != other.index; }
+    
+    // Position in the ring (0 = oldest)
+    uint16_t position() const { return index; }
+    
+  private:
+    const DataManager* owner;
+    uint16_t index;
+  };
+  
+  // Iterator pair usable in range-based for loops
+  struct Range {
+    Iterator first;
+    Iterator last;
+    Iterator begin() const { return first; }
+    Iterator end() const { return last; }
+    uint16_t size() const { return last.position() - first.position(); }
+  };
+  
+  DataManager();
+  
+  // Initialize data manager
+  void begin();
+  
+  // Set calibration manager pointer (for getting calibration time)
+  void setCalibrationManager(CalibrationManager* calibMgr);
+  
+  // Add a new measurement
+  void addMeasurement(uint16_t thickness, RiseFixed rise);
+  
+  // Get measurement count
+  uint16_t getCount();
+  
+  // Get measurement at index (0 = oldest)
+  DataPoint getMeasurement(uint16_t index);
+  
+  // All stored points, oldest first
+  Range all() const;
+  
+  // Points with from <= timestamp <= to, found by binary search on the
+  // (monotonic) timestamps in O(log n)
+  Range range(unsigned long from, unsigned long to) const;
+  
+  // Write measurements as a JSON array. With maxPoints (at least 3) and
+  // more stored points than that, the series is reduced to maxPoints with
+  // Largest-Triangle-Three-Buckets on the rise curve, in one pass over the
+  // ring and constant memory.
+  void writeMeasurementsJSON(JsonWriter& json, uint16_t maxPoints = 0);
+  
+  // Finest tier that still holds everything from the given time on (the
+  // coarsest tier if none does)
+  DataTier selectTier(unsigned long from);
+  
+  // Write the measurements with from <= timestamp <= to as a JSON array,
+  // taken from selectTier(from). Rollup elements carry the bucket means as
+  // "thickness"/"rise" plus min/max and count. maxPoints reduces raw points
+  // with LTTB and merges adjacent rollups.
+  void writeRangeJSON(JsonWriter& json, unsigned long from, unsigned long to, uint16_t maxPoints = 0);
+  
+  // Get initial thickness
+  uint16_t getInitialThickness();
+  
+  // Get current thickness
+  uint16_t getCurrentThickness();
+  
+  // Get current rise (hundredths of a percent)
+  RiseFixed getCurrentRise();
+  
+  // Get time since first measurement (seconds)
+  unsigned long getElapsedTime();
+  
+  // Running aggregates since the last reset
+  const DataStats& getStats() const { return stats; }
+  
+  // Current rise rate: least-squares slope over the last RISE_RATE_WINDOW
+  // seconds, NAN until the window holds two measurements at different times
+  float getRiseRateMmPerHour();
+  float getRiseRatePercentPerHour();
+  
+  // Logistic fit of the rise so far, updated with every measurement
+  const RiseForecast& getForecast() const { return forecast; }
+  
+  // Seconds since the peak rise was measured (0 without data)
+  unsigned long getTimeSincePeak();
+  
+  // Write the aggregates as a JSON object (unknown values as null)
+  void writeStatsJSON(JsonWriter& json);
+  
+  // Reset all data
+  void reset();
+  
+  // Check if has data
+  bool hasData();
+  
+  // Get last measurement time
+  unsigned long getLastMeasurementTime();
+  
+private:
+  static const uint16_t MAX_POINTS = MAX_DATA_POINTS;
+  DataPoint buffer[MAX_DATA_POINTS];
+  uint16_t count = 0;
+  uint16_t writeIndex = 0;  // Circular buffer index
+  bool rawDropped = false;  // Oldest raw points have been overwritten
+  RollupTier<ROLLUP_HOURLY_SLOTS> hourly{3600};
+  RollupTier<ROLLUP_SIX_HOURLY_SLOTS> sixHourly{6 * 3600};
+  DataStats stats;
+  RiseForecast forecast;
+  unsigned long firstMeasurementTime = 0;
+  CalibrationManager* calibrationMgr = nullptr;
+  
+  // Helper to format timestamp
+  String formatTime24H(unsigned long timestamp);
+  
+  // One {"time","timestamp","thickness","rise"} array element
+  void writePoint(JsonWriter& json, const DataPoint& dp);
+  
+  // Point at index (0 = oldest), by reference into the ring
+  const DataPoint& at(uint16_t index) const {
+    return buffer[(writeIndex + MAX_POINTS - count + index) % MAX_POINTS];
+  }
+  
+  // Update stats for a point about to be stored / leaving the rate window
+  void updateStats(const DataPoint& dp);
+  void addToWindow(const DataPoint& dp, double sign);
+  double windowSlope(double sumYT, double sumY);
+  void resetStats();
+  
+  // Points of a range, all of them or reduced with LTTB
+  void writePoints(JsonWriter& json, const Range& points, uint16_t maxPoints);
+  void writeDownsampled(JsonWriter& json, const Range& points, uint16_t maxPoints);
+  
+  // Raw index of the first point at or after from / after to
+  uint16_t lowerBound(unsigned long from) const;
+  uint16_t upperBound(unsigned long to) const;
+  
+  // Write buckets [first, last) of a tier, merging runs of buckets when
+  // there are more than maxPoints
+  template <uint16_t CAPACITY>
+  void writeRollups(JsonWriter& json, const RollupTier<CAPACITY>& tier,
+                    uint16_t first, uint16_t last, uint16_t maxPoints);
+  void writeRollup(JsonWriter& json, const Rollup& rollup);
+  void writeRise(JsonWriter& json, const char* name, RiseFixed rise, bool valid);
+  void writeUnsigned(JsonWriter& json, const char* name, unsigned long value, bool valid);
+};
+
+#endif
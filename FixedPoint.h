@@ -0,0 +1,60 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <Arduino.h>
+
+/*
+ * Fixed-point rise values.
+ *
+ * The ESP32-C6 has no FPU, so every float operation is a library call. The
+ * per-measurement path (outlier filter, rise calculation, storage, rollups,
+ * statistics and JSON output) therefore works on integers. A rise is kept in
+ * hundredths of a percent, so 12.34% is 1234: the precision the API has
+ * always reported, with the range of an int32.
+ */
+typedef int32_t RiseFixed;
+
+static const uint8_t RISE_DECIMALS = 2;
+static const int32_t RISE_SCALE = 100;  // Units per percent
+
+// a / b rounded to the nearest integer, halves away from zero (b > 0)
+inline int32_t roundedDivide(int32_t a, int32_t b) {
+  return a >= 0 ? (a + b / 2) / b : -((-a + b / 2) / b);
+}
+
+inline int64_t roundedDivide(int64_t a, int64_t b) {
+  return a >= 0 ? (a + b / 2) / b : -((-a + b / 2) / b);
+}
+
+// Rise of current over initial thickness; 0 without an initial thickness
+inline RiseFixed riseFromThickness(uint16_t current, uint16_t initial) {
+  if (initial == 0) return 0;
+  return roundedDivide(((int32_t)current - initial) * 100 * RISE_SCALE, (int32_t)initial);
+}
+
+inline RiseFixed riseFromPercent(float percent) {
+  return (RiseFixed)lroundf(percent * RISE_SCALE);
+}
+
+inline float riseToPercent(RiseFixed rise) {
+  return (float)rise / RISE_SCALE;
+}
+
+// Write a rise as percent without trailing zeros (50, 12.5, 3.25); returns
+// the length like snprintf
+inline size_t formatPercent(RiseFixed rise, char* out, size_t size) {
+  long whole = rise / RISE_SCALE;
+  long fraction = labs(rise % RISE_SCALE);
+  const char* sign = rise < 0 && whole == 0 ? "-" : "";
+  if (fraction == 0) return snprintf(out, size, "%ld", whole);
+  if (fraction % 10 == 0) return snprintf(out, size, "%s%ld.%ld", sign, whole, fraction / 10);
+  return snprintf(out, size, "%s%ld.%02ld", sign, whole, fraction);
+}
+
+// True if value is within permille / 1000 of reference (relative deviation)
+inline bool withinDeviation(uint16_t value, uint16_t reference, uint16_t permille) {
+  uint32_t difference = value > reference ? value - reference : reference - value;
+  return difference * 1000 <= (uint32_t)permille * reference;
+}
+
+#endif
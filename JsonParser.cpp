@@ -0,0 +1,379 @@
+#include "JsonParser.h"
+#include <limits.h>
+
+JsonField JsonParser::intField(const char* name, long* target, long min, long max, bool required) {
+  return {name, JSON_FIELD_INT, required, target, 0, min, max, false, nullptr, nullptr};
+}
+
+JsonField JsonParser::boolField(const char* name, bool* target, bool required) {
+  return {name, JSON_FIELD_BOOL, required, target, 0, 0, 0, false, nullptr, nullptr};
+}
+
+JsonField JsonParser::stringField(const char* name, char* target, size_t size,
+                                  size_t minLength, bool required) {
+  return {name, JSON_FIELD_STRING, required, target, size, (long)minLength, (long)size - 1, false,
+          nullptr, nullptr};
+}
+
+JsonField JsonParser::arrayField(const char* name, JsonField* elementFields, uint8_t elementFieldCount,
+                                 uint16_t maxItems, JsonElementFunction onElement, void* context,
+                                 bool required) {
+  return {name, JSON_FIELD_OBJECT_ARRAY, required, elementFields, elementFieldCount, 0, maxItems, false,
+          onElement, context};
+}
+
+bool JsonParser::parse(const char* json, size_t length, JsonField* fields, uint8_t fieldCount) {
+  errorText[0] = '\0';
+  for (uint8_t i = 0; i < fieldCount; i++) {
+    fields[i].present = false;
+  }
+  if (length > MAX_BODY) return fail("Body too large");
+
+  pos = json;
+  end = json + length;
+
+  skipWhitespace();
+  if (!consume('{')) return fail("Expected a JSON object");
+  if (!parseMembers(fields, fieldCount, 1)) return false;
+
+  skipWhitespace();
+  if (pos != end) return fail("Unexpected data after object");
+  return true;
+}
+
+// Members of an object whose '{' has been consumed, through the closing '}'
+bool JsonParser::parseMembers(JsonField* fields, uint8_t fieldCount, uint8_t depth) {
+  for (uint8_t i = 0; i < fieldCount; i++) {
+    fields[i].present = false;
+  }
+
+  skipWhitespace();
+  if (!consume('}')) {
+    while (true) {
+      skipWhitespace();
+      char key[MAX_KEY];
+      size_t keyLength;
+      bool keyTruncated;
+      if (pos >= end || *pos != '"') return fail("Expected a member name");
+      if (!parseString(key, sizeof(key), &keyLength, &keyTruncated)) return false;
+
+      skipWhitespace();
+      if (!consume(':')) return fail("Expected ':'");
+      skipWhitespace();
+
+      // Keys that do not fit the buffer cannot match a field name
+      JsonField* field = nullptr;
+      if (!keyTruncated) {
+        for (uint8_t i = 0; i < fieldCount; i++) {
+          if (strlen(fields[i].name) == keyLength && memcmp(fields[i].name, key, keyLength) == 0) {
+            field = &fields[i];
+            break;
+          }
+        }
+      }
+      if (!parseValue(field, depth)) return false;
+
+      skipWhitespace();
+      if (consume(',')) continue;
+      if (consume('}')) break;
+      return fail("Expected ',' or '}'");
+    }
+  }
+
+  for (uint8_t i = 0; i < fieldCount; i++) {
+    if (fields[i].required && !fields[i].present) {
+      return fail("Missing field", fields[i].name);
+    }
+  }
+  return true;
+}
+
+bool JsonParser::fail(const char* message, const char* field) {
+  if (field) {
+    snprintf(errorText, sizeof(errorText), "%s '%s'", message, field);
+  } else {
+    snprintf(errorText, sizeof(errorText), "%s", message);
+  }
+  return false;
+}
+
+void JsonParser::skipWhitespace() {
+  while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\n' || *pos == '\r')) {
+    pos++;
+  }
+}
+
+bool JsonParser::consume(char c) {
+  if (pos < end && *pos == c) {
+    pos++;
+    return true;
+  }
+  return false;
+}
+
+bool JsonParser::parseValue(JsonField* field, uint8_t depth) {
+  if (pos >= end) return fail("Unexpected end of JSON");
+  char c = *pos;
+
+  if (c == '"') {
+    if (field && field->type != JSON_FIELD_STRING) return fail("Wrong type for", field->name);
+    if (!field) return parseString(nullptr, 0, nullptr, nullptr);
+
+    size_t length;
+    bool truncated;
+    if (!parseString((char*)field->target, field->size, &length, &truncated)) return false;
+    if (truncated) return fail("Too long:", field->name);
+    if ((long)length < field->min) return fail("Too short:", field->name);
+    if (strlen((char*)field->target) != length) return fail("NUL character in", field->name);
+    field->present = true;
+    return true;
+  }
+
+  if (c == '-' || (c >= '0' && c <= '9')) {
+    long number;
+    bool isInteger;
+    bool overflow;
+    if (!parseNumber(&number, &isInteger, &overflow)) return false;
+    if (!field) return true;
+    if (field->type != JSON_FIELD_INT) return fail("Wrong type for", field->name);
+    if (!isInteger) return fail("Expected an integer for", field->name);
+    if (overflow || number < field->min || number > field->max) return fail("Out of range:", field->name);
+    *(long*)field->target = number;
+    field->present = true;
+    return true;
+  }
+
+  if (c == 't' || c == 'f') {
+    bool flag = (c == 't');
+    if (!parseLiteral(flag ? "true" : "false")) return false;
+    if (!field) return true;
+    if (field->type != JSON_FIELD_BOOL) return fail("Wrong type for", field->name);
+    *(bool*)field->target = flag;
+    field->present = true;
+    return true;
+  }
+
+  if (c == 'n') {
+    if (!parseLiteral("null")) return false;
+    // null leaves an optional field unset
+    if (field && field->required) return fail("Missing field", field->name);
+    return true;
+  }
+
+  if (field && field->type == JSON_FIELD_OBJECT_ARRAY) {
+    if (c != '[') return fail("Wrong type for", field->name);
+    if (depth + 1 >= MAX_DEPTH) return fail("JSON nested too deeply");
+    pos++;
+    return parseElements(field, depth + 1);
+  }
+
+  if (c == '{' || c == '[') {
+    if (field) return fail("Wrong type for", field->name);
+    if (depth >= MAX_DEPTH) return fail("JSON nested too deeply");
+    pos++;
+    return skipContainer(c == '{' ? '}' : ']', depth + 1);
+  }
+
+  return fail("Unexpected character in JSON");
+}
+
+// Elements of an object array whose '[' has been consumed, through the ']'
+bool JsonParser::parseElements(JsonField* field, uint8_t depth) {
+  JsonField* elementFields = (JsonField*)field->target;
+  uint8_t elementFieldCount = field->size;
+  uint16_t count = 0;
+
+  skipWhitespace();
+  if (!consume(']')) {
+    while (true) {
+      skipWhitespace();
+      if (!consume('{')) return fail("Expected an object in", field->name);
+      if (count >= field->max) return fail("Too many items in", field->name);
+      if (!parseMembers(elementFields, elementFieldCount, depth + 1)) return false;
+      if (field->onElement && !field->onElement(count, field->context)) {
+        return fail("Invalid item in", field->name);
+      }
+      count++;
+
+      skipWhitespace();
+      if (consume(',')) continue;
+      if (consume(']')) break;
+      return fail("Expected ',' or ']'");
+    }
+  }
+  field->present = true;
+  return true;
+}
+
+bool JsonParser::skipContainer(char close, uint8_t depth) {
+  skipWhitespace();
+  if (consume(close)) return true;
+
+  while (true) {
+    skipWhitespace();
+    if (close == '}') {
+      if (pos >= end || *pos != '"') return fail("Expected a member name");
+      if (!parseString(nullptr, 0, nullptr, nullptr)) return false;
+      skipWhitespace();
+      if (!consume(':')) return fail("Expected ':'");
+      skipWhitespace();
+    }
+    if (!parseValue(nullptr, depth)) return false;
+
+    skipWhitespace();
+    if (consume(',')) continue;
+    if (consume(close)) return true;
+    return fail(close == '}' ? "Expected ',' or '}'" : "Expected ',' or ']'");
+  }
+}
+
+bool JsonParser::parseHex4(uint32_t* codepoint) {
+  if (end - pos < 4) return fail("Bad \\u escape");
+  uint32_t value = 0;
+  for (uint8_t i = 0; i < 4; i++) {
+    char c = *pos++;
+    value <<= 4;
+    if (c >= '0' && c <= '9') value |= c - '0';
+    else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+    else return fail("Bad \\u escape");
+  }
+  *codepoint = value;
+  return true;
+}
+
+// Decode a string at pos into out (NUL terminated, at most size - 1 bytes).
+// The whole string is always consumed; truncated reports whether it fit.
+// With out == nullptr the string is only validated.
+bool JsonParser::parseString(char* out, size_t size, size_t* length, bool* truncated) {
+  pos++;  // Opening quote
+  size_t used = 0;
+  bool overflow = false;
+
+  while (true) {
+    if (pos >= end) return fail("Unterminated string");
+    unsigned char c = *pos++;
+    if (c == '"') break;
+    if (c < 0x20) return fail("Control character in string");
+
+    char bytes[4];
+    uint8_t count = 1;
+    bytes[0] = c;
+
+    if (c == '\\') {
+      if (pos >= end) return fail("Unterminated string");
+      char e = *pos++;
+      switch (e) {
+        case '"': bytes[0] = '"'; break;
+        case '\\': bytes[0] = '\\'; break;
+        case '/': bytes[0] = '/'; break;
+        case 'b': bytes[0] = '\b'; break;
+        case 'f': bytes[0] = '\f'; break;
+        case 'n': bytes[0] = '\n'; break;
+        case 'r': bytes[0] = '\r'; break;
+        case 't': bytes[0] = '\t'; break;
+        case 'u': {
+          uint32_t cp;
+          if (!parseHex4(&cp)) return false;
+          if (cp >= 0xD800 && cp <= 0xDBFF) {
+            // High surrogate must be followed by a low one
+            uint32_t low;
+            if (end - pos < 2 || pos[0] != '\\' || pos[1] != 'u') return fail("Bad surrogate pair");
+            pos += 2;
+            if (!parseHex4(&low)) return false;
+            if (low < 0xDC00 || low > 0xDFFF) return fail("Bad surrogate pair");
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+          } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+            return fail("Bad surrogate pair");
+          }
+          // Encode as UTF-8
+          if (cp < 0x80) {
+            bytes[0] = cp;
+          } else if (cp < 0x800) {
+            bytes[0] = 0xC0 | (cp >> 6);
+            bytes[1] = 0x80 | (cp & 0x3F);
+            count = 2;
+          } else if (cp < 0x10000) {
+            bytes[0] = 0xE0 | (cp >> 12);
+            bytes[1] = 0x80 | ((cp >> 6) & 0x3F);
+            bytes[2] = 0x80 | (cp & 0x3F);
+            count = 3;
+          } else {
+            bytes[0] = 0xF0 | (cp >> 18);
+            bytes[1] = 0x80 | ((cp >> 12) & 0x3F);
+            bytes[2] = 0x80 | ((cp >> 6) & 0x3F);
+            bytes[3] = 0x80 | (cp & 0x3F);
+            count = 4;
+          }
+          break;
+        }
+        default:
+          return fail("Bad escape in string");
+      }
+    }
+
+    if (!out) continue;
+    if (used + count < size) {
+      memcpy(out + used, bytes, count);
+      used += count;
+    } else {
+      overflow = true;
+    }
+  }
+
+  if (out) {
+    if (size > 0) out[used] = '\0';
+    *length = used;
+    *truncated = overflow;
+  }
+  return true;
+}
+
+bool JsonParser::parseNumber(long* out, bool* isInteger, bool* overflow) {
+  bool negative = consume('-');
+  if (pos >= end || *pos < '0' || *pos > '9') return fail("Bad number");
+
+  // Accumulate the magnitude as unsigned, saturating on overflow
+  unsigned long magnitude = 0;
+  unsigned long limit = negative ? 0UL - (unsigned long)LONG_MIN : (unsigned long)LONG_MAX;
+  *overflow = false;
+
+  if (*pos == '0') {
+    pos++;
+  } else {
+    while (pos < end && *pos >= '0' && *pos <= '9') {
+      unsigned digit = *pos++ - '0';
+      if (magnitude > (limit - digit) / 10) {
+        *overflow = true;
+      } else {
+        magnitude = magnitude * 10 + digit;
+      }
+    }
+  }
+
+  *isInteger = true;
+  if (consume('.')) {
+    *isInteger = false;
+    if (pos >= end || *pos < '0' || *pos > '9') return fail("Bad number");
+    while (pos < end && *pos >= '0' && *pos <= '9') pos++;
+  }
+  if (pos < end && (*pos == 'e' || *pos == 'E')) {
+    *isInteger = false;
+    pos++;
+    if (pos < end && (*pos == '+' || *pos == '-')) pos++;
+    if (pos >= end || *pos < '0' || *pos > '9') return fail("Bad number");
+    while (pos < end && *pos >= '0' && *pos <= '9') pos++;
+  }
+
+  *out = negative ? (long)(0UL - magnitude) : (long)magnitude;
+  return true;
+}
+
+bool JsonParser::parseLiteral(const char* word) {
+  size_t length = strlen(word);
+  if ((size_t)(end - pos) < length || memcmp(pos, word, length) != 0) {
+    return fail("Unexpected character in JSON");
+  }
+  pos += length;
+  return true;
+}
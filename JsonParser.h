@@ -0,0 +1,83 @@
+#ifndef JSON_PARSER_H
+#define JSON_PARSER_H
+
+#include <Arduino.h>
+
+enum JsonFieldType : uint8_t {
+  JSON_FIELD_INT,
+  JSON_FIELD_BOOL,
+  JSON_FIELD_STRING,
+  JSON_FIELD_OBJECT_ARRAY
+};
+
+// Called after each element of an object array has been parsed into the
+// element fields; return false to reject the element
+typedef bool (*JsonElementFunction)(uint16_t index, void* context);
+
+// One expected member of a request object and where its value goes
+struct JsonField {
+  const char* name;
+  JsonFieldType type;
+  bool required;
+  void* target;     // long*, bool*, char[size], or the element JsonField[size]
+  size_t size;      // String buffer size including the terminator, or element field count
+  long min;         // Integer range, or minimum string length
+  long max;         // Integer range, maximum string length, or maximum element count
+  bool present;     // Set by parse()
+  JsonElementFunction onElement;
+  void* context;
+};
+
+/*
+ * Bounded JSON request parser.
+ *
+ * Parses a request body in place against a small schema of typed fields: no
+ * copies of the body and no heap, only the caller's target buffers. Members
+ * not in the schema are validated and skipped, so key order, whitespace and
+ * escapes do not matter. Strings are unescaped (including \u sequences) into
+ * fixed buffers; values that are too long, out of range or of the wrong type
+ * are rejected instead of truncated. An array of objects is parsed one
+ * element at a time into the same element fields, and each element is handed
+ * to a callback, so lists need no buffer of their own either.
+ */
+class JsonParser {
+public:
+  static const size_t MAX_BODY = 8192;
+  static const uint8_t MAX_DEPTH = 8;
+  static const uint8_t MAX_KEY = 32;
+
+  static JsonField intField(const char* name, long* target, long min, long max, bool required = true);
+  static JsonField boolField(const char* name, bool* target, bool required = true);
+  static JsonField stringField(const char* name, char* target, size_t size,
+                               size_t minLength = 0, bool required = true);
+  static JsonField arrayField(const char* name, JsonField* elementFields, uint8_t elementFieldCount,
+                              uint16_t maxItems, JsonElementFunction onElement, void* context,
+                              bool required = true);
+
+  // Parse one JSON object into the fields. Returns false with error() set
+  // on malformed JSON or a schema violation; targets may be partly written.
+  bool parse(const char* json, size_t length, JsonField* fields, uint8_t fieldCount);
+
+  // Human readable reason for the last failure
+  const char* error() const { return errorText; }
+
+private:
+  const char* pos = nullptr;
+  const char* end = nullptr;
+  char errorText[64] = "";
+
+  bool fail(const char* message, const char* field = nullptr);
+  void skipWhitespace();
+  bool consume(char c);
+
+  bool parseMembers(JsonField* fields, uint8_t fieldCount, uint8_t depth);
+  bool parseElements(JsonField* field, uint8_t depth);
+  bool parseValue(JsonField* field, uint8_t depth);
+  bool parseString(char* out, size_t size, size_t* length, bool* truncated);
+  bool parseNumber(long* out, bool* isInteger, bool* overflow);
+  bool parseLiteral(const char* word);
+  bool parseHex4(uint32_t* codepoint);
+  bool skipContainer(char close, uint8_t depth);
+};
+
+#endif
@@ -0,0 +1,220 @@
+#include "JsonWriter.h"
+#include <math.h>
+
+JsonWriter::JsonWriter(char* buffer, size_t size)
+  : buffer(buffer), capacity(size > 0 ? size - 1 : 0) {
+  if (size > 0) buffer[0] = '\0';
+}
+
+JsonWriter::JsonWriter(char* buffer, size_t size, FlushFunction flush, void* context)
+  : JsonWriter(buffer, size) {
+  flushFunction = flush;
+  flushContext = context;
+}
+
+void JsonWriter::beginObject() {
+  open('{');
+}
+
+void JsonWriter::endObject() {
+  close('}');
+}
+
+void JsonWriter::beginArray() {
+  open('[');
+}
+
+void JsonWriter::endArray() {
+  close(']');
+}
+
+void JsonWriter::key(const char* name) {
+  separator();
+  writeString(name);
+  write(':');
+  afterKey = true;
+}
+
+void JsonWriter::value(const char* text) {
+  separator();
+  if (text) {
+    writeString(text);
+  } else {
+    write("null", 4);
+  }
+}
+
+void JsonWriter::value(bool flag) {
+  separator();
+  if (flag) {
+    write("true", 4);
+  } else {
+    write("false", 5);
+  }
+}
+
+void JsonWriter::value(long number) {
+  separator();
+  if (number < 0) {
+    write('-');
+    // Negate as unsigned so LONG_MIN is handled
+    writeUnsigned(0UL - (unsigned long)number);
+  } else {
+    writeUnsigned(number);
+  }
+}
+
+void JsonWriter::value(unsigned long number) {
+  separator();
+  writeUnsigned(number);
+}
+
+void JsonWriter::value(double number, uint8_t decimals) {
+  if (!isfinite(number)) {
+    valueNull();
+    return;
+  }
+  if (decimals > 6) decimals = 6;
+
+  static const uint32_t SCALE[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+  double magnitude = fabs(number);
+  if (magnitude >= 1e12) {
+    // Too large for fixed point; exponent form is still valid JSON
+    separator();
+    char text[24];
+    int length = snprintf(text, sizeof(text), "%.*e", decimals, number);
+    write(text, length);
+    return;
+  }
+
+  uint64_t scaled = (uint64_t)llround(magnitude * SCALE[decimals]);
+  uint64_t whole = scaled / SCALE[decimals];
+  uint32_t fraction = scaled % SCALE[decimals];
+
+  separator();
+  if (number < 0 && scaled != 0) write('-');
+  writeUnsigned(whole);
+  writeFraction(fraction, decimals);
+}
+
+void JsonWriter::valueFixed(long number, uint8_t decimals) {
+  if (decimals > 6) decimals = 6;
+  static const uint32_t SCALE[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+  // Negate as unsigned so LONG_MIN is handled
+  unsigned long magnitude = number < 0 ? 0UL - (unsigned long)number : (unsigned long)number;
+
+  separator();
+  if (number < 0) write('-');
+  writeUnsigned(magnitude / SCALE[decimals]);
+  writeFraction(magnitude % SCALE[decimals], decimals);
+}
+
+void JsonWriter::writeFraction(uint32_t fraction, uint8_t decimals) {
+  if (decimals == 0) return;
+  char text[8];
+  text[0] = '.';
+  for (uint8_t i = decimals; i > 0; i--) {
+    text[i] = '0' + fraction % 10;
+    fraction /= 10;
+  }
+  write(text, decimals + 1);
+}
+
+void JsonWriter::valueNull() {
+  separator();
+  write("null", 4);
+}
+
+void JsonWriter::flush() {
+  if (flushFunction && used > 0) {
+    flushFunction(buffer, used, flushContext);
+    used = 0;
+  }
+}
+
+void JsonWriter::separator() {
+  if (afterKey) {
+    afterKey = false;
+    return;
+  }
+  uint16_t bit = 1 << (depth < MAX_DEPTH ? depth : MAX_DEPTH - 1);
+  if (hasItems & bit) write(',');
+  hasItems |= bit;
+}
+
+void JsonWriter::open(char c) {
+  separator();
+  write(c);
+  if (depth < MAX_DEPTH - 1) depth++;
+  hasItems &= ~(1 << depth);
+}
+
+void JsonWriter::close(char c) {
+  write(c);
+  hasItems &= ~(1 << depth);
+  if (depth > 0) depth--;
+}
+
+void JsonWriter::writeSlow(const char* data, size_t length) {
+  while (length > 0) {
+    size_t room = capacity - used;
+    if (room == 0) {
+      if (!flushFunction || capacity == 0) {
+        overflow = true;
+        return;
+      }
+      flush();
+      room = capacity;
+    }
+    size_t n = length < room ? length : room;
+    memcpy(buffer + used, data, n);
+    used += n;
+    data += n;
+    length -= n;
+  }
+}
+
+void JsonWriter::writeUnsigned(uint64_t number) {
+  char digits[20];
+  uint8_t start = sizeof(digits);
+  do {
+    digits[--start] = '0' + number % 10;
+    number /= 10;
+  } while (number > 0);
+  write(digits + start, sizeof(digits) - start);
+}
+
+void JsonWriter::writeString(const char* text) {
+  static const char HEX_DIGITS[] = "0123456789abcdef";
+  write('"');
+  const char* run = text;
+  for (const char* p = text; *p; p++) {
+    unsigned char c = *p;
+    if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+    // Copy the unescaped run, then the escape sequence
+    write(run, p - run);
+    run = p + 1;
+    char escape[6] = {'\\', 0, 0, 0, 0, 0};
+    size_t length = 2;
+    switch (c) {
+      case '"': escape[1] = '"'; break;
+      case '\\': escape[1] = '\\'; break;
+      case '\n': escape[1] = 'n'; break;
+      case '\r': escape[1] = 'r'; break;
+      case '\t': escape[1] = 't'; break;
+      case '\b': escape[1] = 'b'; break;
+      case '\f': escape[1] = 'f'; break;
+      default:
+        escape[1] = 'u';
+        escape[2] = '0';
+        escape[3] = '0';
+        escape[4] = HEX_DIGITS[c >> 4];
+        escape[5] = HEX_DIGITS[c & 0xF];
+        length = 6;
+    }
+    write(escape, length);
+  }
+  write(run, strlen(run));
+  write('"');
+}
@@ -0,0 +1,104 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <Arduino.h>
+
+/*
+ * Allocation-free JSON writer.
+ *
+ * Output goes into a caller-provided buffer. Without a flush callback the
+ * buffer holds the whole document and overflowed() reports if it did not
+ * fit. With a callback, full buffers are handed to it (e.g. sendContent) so
+ * documents of any size are produced in fixed memory.
+ *
+ * Commas and nesting are tracked by the writer; strings are escaped and
+ * non-finite floats are written as null so the output is always valid JSON.
+ */
+class JsonWriter {
+public:
+  typedef void (*FlushFunction)(const char* data, size_t length, void* context);
+
+  static const uint8_t MAX_DEPTH = 16;
+
+  JsonWriter(char* buffer, size_t size);
+  JsonWriter(char* buffer, size_t size, FlushFunction flush, void* context);
+
+  void beginObject();
+  void endObject();
+  void beginArray();
+  void endArray();
+
+  // Object member name; the next value belongs to it
+  void key(const char* name);
+
+  void value(const char* text);
+  void value(const String& text) { value(text.c_str()); }
+  void value(bool flag);
+  void value(long number);
+  void value(unsigned long number);
+  void value(int number) { value((long)number); }
+  void value(unsigned int number) { value((unsigned long)number); }
+  void value(double number, uint8_t decimals = 2);
+  // Fixed-point number: writes number / 10^decimals exactly, e.g. 1234 with
+  // 2 decimals as 12.34, without any floating point
+  void valueFixed(long number, uint8_t decimals);
+  void valueNull();
+
+  // key() followed by value()
+  template <typename T>
+  void field(const char* name, const T& v) {
+    key(name);
+    value(v);
+  }
+  void field(const char* name, double number, uint8_t decimals) {
+    key(name);
+    value(number, decimals);
+  }
+  void fieldFixed(const char* name, long number, uint8_t decimals) {
+    key(name);
+    valueFixed(number, decimals);
+  }
+
+  // Hand any buffered output to the flush callback
+  void flush();
+
+  // Buffered document (fixed-buffer mode), NUL terminated
+  const char* c_str() const {
+    buffer[used] = '\0';
+    return buffer;
+  }
+  size_t length() const { return used; }
+  bool overflowed() const { return overflow; }
+
+private:
+  char* buffer;
+  size_t capacity;  // Usable bytes, excluding the terminator
+  size_t used = 0;
+  bool overflow = false;
+  FlushFunction flushFunction = nullptr;
+  void* flushContext = nullptr;
+
+  uint8_t depth = 0;
+  uint16_t hasItems = 0;  // Bit per nesting level: a comma is needed before the next item
+  bool afterKey = false;
+
+  void separator();
+  void open(char c);
+  void close(char c);
+  void write(char c) { write(&c, 1); }
+  void write(const char* data, size_t length) {
+    // Fast path: fits in the buffer
+    if (length <= capacity - used) {
+      memcpy(buffer + used, data, length);
+      used += length;
+      return;
+    }
+    writeSlow(data, length);
+  }
+  void writeSlow(const char* data, size_t length);
+  void writeUnsigned(uint64_t number);
+  void writeFraction(uint32_t fraction, uint8_t decimals);
+  void writeString(const char* text);
+};
+
+#endif
@@ -0,0 +1,121 @@
+#include "Log.h"
+#include <stdarg.h>
+
+Logger logger;
+
+void Logger::printf(const char* format, ...) {
+  char line[MAX_LINE];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  if (length <= 0) return;
+  if ((size_t)length >= sizeof(line)) {
+    // Truncated: keep the line ending so the next line does not run on
+    length = sizeof(line) - 1;
+    line[length - 1] = '\n';
+  }
+
+  appendHistory(line, length);
+
+  if (!async) {
+    Serial.write((const uint8_t*)line, length);
+    return;
+  }
+  if (!enqueue(line, length)) {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+bool Logger::enqueue(const char* data, size_t length) {
+  uint32_t h = head.load(std::memory_order_relaxed);
+  uint32_t t = tail.load(std::memory_order_acquire);
+  if (LOG_BUFFER_SIZE - (h - t) < length) {
+    return false;
+  }
+
+  size_t offset = h % LOG_BUFFER_SIZE;
+  size_t first = LOG_BUFFER_SIZE - offset;
+  if (first > length) first = length;
+  memcpy(ring + offset, data, first);
+  memcpy(ring, data + first, length - first);
+
+  head.store(h + length, std::memory_order_release);
+  return true;
+}
+
+size_t Logger::writeOut(size_t maxBytes) {
+  uint32_t t = tail.load(std::memory_order_relaxed);
+  uint32_t h = head.load(std::memory_order_acquire);
+  size_t pending = h - t;
+  if (pending > maxBytes) pending = maxBytes;
+  if (pending == 0) return 0;
+
+  // Write the contiguous part only; the wrapped remainder goes next call
+  size_t offset = t % LOG_BUFFER_SIZE;
+  size_t contiguous = LOG_BUFFER_SIZE - offset;
+  if (pending > contiguous) pending = contiguous;
+
+  Serial.write((const uint8_t*)(ring + offset), pending);
+  tail.store(t + pending, std::memory_order_release);
+  return pending;
+}
+
+void Logger::setAsync(bool enabled) {
+  if (!enabled) flush();
+  async = enabled;
+}
+
+size_t Logger::drain() {
+  size_t written = 0;
+  // Two passes at most: the ring may wrap once
+  for (uint8_t pass = 0; pass < 2; pass++) {
+    int room = Serial.availableForWrite();
+    if (room <= 0) break;
+    size_t n = writeOut(room);
+    if (n == 0) break;
+    written += n;
+  }
+
+  uint32_t lost = dropped.load(std::memory_order_relaxed);
+  if (lost != reportedDropped && tail.load() == head.load()) {
+    char note[48];
+    int length = snprintf(note, sizeof(note), "[Log] %lu messages dropped\n",
+                          (unsigned long)(lost - reportedDropped));
+    if (enqueue(note, length)) reportedDropped = lost;
+  }
+  return written;
+}
+
+void Logger::flush() {
+  while (writeOut(LOG_BUFFER_SIZE) > 0) {
+  }
+  Serial.flush();
+}
+
+void Logger::appendHistory(const char* data, size_t length) {
+  size_t offset = historyHead % LOG_HISTORY_SIZE;
+  size_t first = LOG_HISTORY_SIZE - offset;
+  if (first > length) first = length;
+  memcpy(history + offset, data, first);
+  memcpy(history, data + first, length - first);
+  historyHead += length;
+}
+
+size_t Logger::readHistory(uint32_t from, char* out, size_t maxBytes) {
+  if (from < historyStart()) from = historyStart();
+  if (from >= historyHead) return 0;
+  size_t length = historyHead - from;
+  if (length > maxBytes) length = maxBytes;
+
+  size_t offset = from % LOG_HISTORY_SIZE;
+  size_t first = LOG_HISTORY_SIZE - offset;
+  if (first > length) first = length;
+  memcpy(out, history + offset, first);
+  memcpy(out + first, history, length - first);
+  return length;
+}
+
+uint32_t Logger::getDropped() {
+  return dropped.load(std::memory_order_relaxed);
+}
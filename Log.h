@@ -0,0 +1,97 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+
+// Log levels (see LOG_LEVEL_* in config.h)
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+// Compile-time level of each module
+namespace LogLevels {
+  constexpr uint8_t Main = LOG_LEVEL_MAIN;
+  constexpr uint8_t Sensor = LOG_LEVEL_SENSOR;
+  constexpr uint8_t Calibration = LOG_LEVEL_CALIBRATION;
+  constexpr uint8_t Data = LOG_LEVEL_DATA;
+  constexpr uint8_t Wifi = LOG_LEVEL_WIFI;
+  constexpr uint8_t WebServer = LOG_LEVEL_WEBSERVER;
+  constexpr uint8_t Webhook = LOG_LEVEL_WEBHOOK;
+  constexpr uint8_t Metrics = LOG_LEVEL_METRICS;
+}
+
+// Calls above the module's level are discarded at compile time, arguments included
+#define LOG_AT(module, level, ...) \
+  do { \
+    if constexpr ((level) <= LogLevels::module) { \
+      logger.printf(__VA_ARGS__); \
+    } \
+  } while (0)
+
+#define LOG_E(module, ...) LOG_AT(module, LOG_LEVEL_ERROR, __VA_ARGS__)
+#define LOG_W(module, ...) LOG_AT(module, LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOG_I(module, ...) LOG_AT(module, LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_D(module, ...) LOG_AT(module, LOG_LEVEL_DEBUG, __VA_ARGS__)
+
+/*
+ * Log sink.
+ *
+ * In async mode messages are formatted into a lock-free single-producer /
+ * single-consumer ring and drain() later copies only as much to Serial as
+ * the UART TX buffer can take, so logging never blocks the sampling or HTTP
+ * paths. When the ring is full whole messages are dropped and counted.
+ * All logging happens on the loop task, which is the single producer.
+ * Before async mode is enabled (boot) messages go straight to Serial.
+ *
+ * Every message is also appended to a history ring that overwrites the
+ * oldest output; LogStream reads it by absolute byte offset for /logs.
+ */
+class Logger {
+public:
+  static const size_t MAX_LINE = 192;
+
+  // Format and queue (or write, when not async) one message
+  void printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+  // Switch between buffered and direct output
+  void setAsync(bool async);
+
+  // Copy queued output to Serial without blocking; returns bytes written
+  size_t drain();
+
+  // Write out everything queued, blocking if needed (before restart/halt)
+  void flush();
+
+  // Messages dropped because the ring was full
+  uint32_t getDropped();
+
+  // History offsets: total bytes ever logged, and oldest still available
+  uint32_t historyEnd() { return historyHead; }
+  uint32_t historyStart() { return historyHead > LOG_HISTORY_SIZE ? historyHead - LOG_HISTORY_SIZE : 0; }
+
+  // Copy history from an absolute offset (clamped to what is available)
+  size_t readHistory(uint32_t from, char* out, size_t maxBytes);
+
+private:
+  char ring[LOG_BUFFER_SIZE];
+  std::atomic<uint32_t> head{0};   // Total bytes produced
+  std::atomic<uint32_t> tail{0};   // Total bytes consumed
+  std::atomic<uint32_t> dropped{0};
+  uint32_t reportedDropped = 0;
+  bool async = false;
+
+  char history[LOG_HISTORY_SIZE];
+  uint32_t historyHead = 0;
+
+  bool enqueue(const char* data, size_t length);
+  size_t writeOut(size_t maxBytes);
+  void appendHistory(const char* data, size_t length);
+};
+
+extern Logger logger;
+
+#endif
@@ -0,0 +1,221 @@
+#include "LogStream.h"
+#include "Log.h"
+#include <errno.h>
+#include <lwip/sockets.h>
+#include <mbedtls/sha1.h>
+#include <mbedtls/base64.h>
+
+LogStream logStream;
+
+static const char* WEBSOCKET_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+static const uint8_t OPCODE_TEXT = 0x1;
+static const uint8_t OPCODE_CLOSE = 0x8;
+static const uint8_t OPCODE_PING = 0x9;
+static const uint8_t OPCODE_PONG = 0xA;
+
+// Frames per client per handle() call, so one client cannot hog the loop
+static const uint8_t MAX_FRAMES_PER_PASS = 4;
+
+bool LogStream::hasFreeSlot() {
+  for (uint8_t i = 0; i < LOG_STREAM_MAX_CLIENTS; i++) {
+    if (!clients[i].active) return true;
+  }
+  return false;
+}
+
+uint8_t LogStream::getClientCount() {
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < LOG_STREAM_MAX_CLIENTS; i++) {
+    if (clients[i].active) count++;
+  }
+  return count;
+}
+
+bool LogStream::accept(WiFiClient& client, const String& key) {
+  Client* slot = nullptr;
+  for (uint8_t i = 0; i < LOG_STREAM_MAX_CLIENTS; i++) {
+    if (!clients[i].active) {
+      slot = &clients[i];
+      break;
+    }
+  }
+  if (!slot || key.length() == 0 || key.length() > 64) return false;
+
+  // Sec-WebSocket-Accept = base64(sha1(key + GUID))
+  char input[64 + 40];
+  int inputLength = snprintf(input, sizeof(input), "%s%s", key.c_str(), WEBSOCKET_GUID);
+  unsigned char digest[20];
+  mbedtls_sha1((const unsigned char*)input, inputLength, digest);
+  unsigned char acceptKey[32];
+  size_t acceptLength = 0;
+  mbedtls_base64_encode(acceptKey, sizeof(acceptKey), &acceptLength, digest, sizeof(digest));
+
+  char response[160];
+  int responseLength = snprintf(response, sizeof(response),
+                                "HTTP/1.1 101 Switching Protocols\r\n"
+                                "Upgrade: websocket\r\n"
+                                "Connection: Upgrade\r\n"
+                                "Sec-WebSocket-Accept: %s\r\n\r\n", acceptKey);
+  if (client.write((const uint8_t*)response, responseLength) != (size_t)responseLength) {
+    return false;
+  }
+
+  slot->socket = client;
+  slot->active = true;
+  slot->cursor = alignToLine(logger.historyStart());
+  slot->frameLength = 0;
+  slot->frameSent = 0;
+  slot->rxLength = 0;
+
+  LOG_I(WebServer, "[LogStream] Client connected (%d active)\n", getClientCount());
+  return true;
+}
+
+void LogStream::handle() {
+  for (uint8_t i = 0; i < LOG_STREAM_MAX_CLIENTS; i++) {
+    if (clients[i].active) {
+      serviceClient(clients[i]);
+    }
+  }
+}
+
+void LogStream::serviceClient(Client& c) {
+  if (!c.socket.connected()) {
+    close(c);
+    return;
+  }
+  if (!readControlFrames(c)) return;
+
+  for (uint8_t frames = 0; frames < MAX_FRAMES_PER_PASS; frames++) {
+    // Finish the previous frame before starting another
+    if (!flushFrame(c)) return;
+
+    uint32_t start = logger.historyStart();
+    if (c.cursor == logger.historyEnd()) return;
+
+    if (c.cursor < start) {
+      // Overwritten before we could send it: skip to the oldest whole line
+      char notice[80];
+      int length = snprintf(notice, sizeof(notice),
+                            "[LogStream] %lu bytes of log skipped (client too slow)\n",
+                            (unsigned long)(start - c.cursor));
+      c.cursor = alignToLine(start);
+      queueFrame(c, OPCODE_TEXT, notice, length);
+      continue;
+    }
+
+    char payload[FRAME_PAYLOAD];
+    size_t length = logger.readHistory(c.cursor, payload, sizeof(payload));
+
+    // End text frames on a line boundary so multi-byte characters stay whole
+    for (size_t i = length; i > 0; i--) {
+      if (payload[i - 1] == '\n') {
+        length = i;
+        break;
+      }
+    }
+    c.cursor += length;
+    queueFrame(c, OPCODE_TEXT, payload, length);
+  }
+  flushFrame(c);
+}
+
+bool LogStream::readControlFrames(Client& c) {
+  while (c.socket.available() > 0 && c.rxLength < sizeof(c.rx)) {
+    int n = c.socket.read(c.rx + c.rxLength, sizeof(c.rx) - c.rxLength);
+    if (n <= 0) break;
+    c.rxLength += n;
+  }
+
+  while (c.rxLength >= 2) {
+    uint8_t opcode = c.rx[0] & 0x0F;
+    bool masked = c.rx[1] & 0x80;
+    size_t length = c.rx[1] & 0x7F;
+    if (length > 125) {
+      // Clients have nothing to send us beyond control frames
+      close(c);
+      return false;
+    }
+    size_t header = 2 + (masked ? 4 : 0);
+    if (c.rxLength < header + length) break;
+
+    uint8_t* payload = c.rx + header;
+    if (masked) {
+      for (size_t i = 0; i < length; i++) {
+        payload[i] ^= c.rx[2 + (i & 3)];
+      }
+    }
+
+    if (opcode == OPCODE_CLOSE) {
+      if (flushFrame(c)) {
+        queueFrame(c, OPCODE_CLOSE, nullptr, 0);
+        flushFrame(c);
+      }
+      close(c);
+      return false;
+    }
+    if (opcode == OPCODE_PING && c.frameSent == c.frameLength) {
+      queueFrame(c, OPCODE_PONG, (const char*)payload, length);
+    }
+
+    size_t consumed = header + length;
+    memmove(c.rx, c.rx + consumed, c.rxLength - consumed);
+    c.rxLength -= consumed;
+  }
+  return true;
+}
+
+bool LogStream::flushFrame(Client& c) {
+  while (c.frameSent < c.frameLength) {
+    ssize_t n = send(c.socket.fd(), c.frame + c.frameSent, c.frameLength - c.frameSent,
+                     MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return false;  // Socket buffer full; try again next pass
+    }
+    if (n <= 0) {
+      close(c);
+      return false;
+    }
+    c.frameSent += n;
+  }
+  c.frameLength = 0;
+  c.frameSent = 0;
+  return true;
+}
+
+void LogStream::queueFrame(Client& c, uint8_t opcode, const char* payload, size_t length) {
+  size_t header = 2;
+  c.frame[0] = 0x80 | opcode;  // FIN, unmasked (server to client)
+  if (length < 126) {
+    c.frame[1] = length;
+  } else {
+    c.frame[1] = 126;
+    c.frame[2] = length >> 8;
+    c.frame[3] = length & 0xFF;
+    header = 4;
+  }
+  if (length > 0) memcpy(c.frame + header, payload, length);
+  c.frameLength = header + length;
+  c.frameSent = 0;
+}
+
+uint32_t LogStream::alignToLine(uint32_t offset) {
+  if (offset == 0) return 0;
+  char buffer[Logger::MAX_LINE];
+  size_t length = logger.readHistory(offset, buffer, sizeof(buffer));
+  for (size_t i = 0; i < length; i++) {
+    if (buffer[i] == '\n') return offset + i + 1;
+  }
+  return offset;
+}
+
+void LogStream::close(Client& c) {
+  if (!c.active) return;
+  c.socket.stop();
+  c.active = false;
+  c.frameLength = 0;
+  c.frameSent = 0;
+  c.rxLength = 0;
+  LOG_I(WebServer, "[LogStream] Client disconnected (%d active)\n", getClientCount());
+}
@@ -0,0 +1,57 @@
+#ifndef LOG_STREAM_H
+#define LOG_STREAM_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "config.h"
+
+/*
+ * Streams the log history to WebSocket clients on /logs.
+ *
+ * MyWebServer hands over the upgraded connection; from then on handle()
+ * services it from loop(). A new client first gets everything still in the
+ * history ring, then live output. Each client only has a read offset into
+ * the shared history, so a slow client never holds up logging: if it falls
+ * more than LOG_HISTORY_SIZE behind, it skips ahead and is told how much it
+ * missed. Frames are sent with non-blocking socket writes.
+ */
+class LogStream {
+public:
+  static const size_t FRAME_PAYLOAD = 512;
+
+  // True if another client can be accepted
+  bool hasFreeSlot();
+
+  // Complete the WebSocket handshake and start streaming to the client
+  bool accept(WiFiClient& client, const String& key);
+
+  // Send pending history and handle control frames; call from loop()
+  void handle();
+
+  uint8_t getClientCount();
+
+private:
+  struct Client {
+    WiFiClient socket;
+    bool active = false;
+    uint32_t cursor = 0;               // Absolute history offset sent so far
+    uint8_t frame[4 + FRAME_PAYLOAD];  // Frame being written
+    size_t frameLength = 0;
+    size_t frameSent = 0;
+    uint8_t rx[2 + 4 + 125];           // Incoming control frame
+    size_t rxLength = 0;
+  };
+
+  Client clients[LOG_STREAM_MAX_CLIENTS];
+
+  void serviceClient(Client& c);
+  bool readControlFrames(Client& c);
+  bool flushFrame(Client& c);
+  void queueFrame(Client& c, uint8_t opcode, const char* payload, size_t length);
+  uint32_t alignToLine(uint32_t offset);
+  void close(Client& c);
+};
+
+extern LogStream logStream;
+
+#endif
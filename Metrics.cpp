@@ -0,0 +1,208 @@
+#include "Metrics.h"
+#include "Log.h"
+#include <WiFi.h>
+#include <stdarg.h>
+
+Metrics metrics;
+
+const uint32_t LatencyHistogram::BOUNDS_US[LatencyHistogram::BUCKETS] = {
+  100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+  100000, 250000, 500000, 1000000, 2500000, 5000000
+};
+
+void LatencyHistogram::record(uint32_t durationUs) {
+  uint8_t bucket = 0;
+  while (bucket < BUCKETS && durationUs > BOUNDS_US[bucket]) {
+    bucket++;
+  }
+  counts[bucket]++;
+  total++;
+  sumUs += durationUs;
+  if (durationUs > maxUs) {
+    maxUs = durationUs;
+  }
+}
+
+int8_t Metrics::registerRoute(const char* uri, const char* method) {
+  if (routeCount >= MAX_ROUTES) {
+    LOG_W(Metrics, "[Metrics] WARNING: route table full, %s %s not tracked\n", method, uri);
+    return -1;
+  }
+  routes[routeCount] = {uri, method, 0, 0, 0};
+  return routeCount++;
+}
+
+void Metrics::recordRequest(int8_t route, uint32_t durationUs) {
+  if (route < 0 || route >= routeCount) return;
+  RouteMetrics& r = routes[route];
+  r.requests++;
+  r.totalUs += durationUs;
+  if (durationUs > r.maxUs) {
+    r.maxUs = durationUs;
+  }
+}
+
+void Metrics::recordLoopIteration(uint32_t durationUs) {
+  loopHistogram.record(durationUs);
+}
+
+void Metrics::recordSensorSweep(uint32_t durationUs) {
+  sensorSweepHistogram.record(durationUs);
+}
+
+void Metrics::recordSharedSweep() {
+  sharedSweeps++;
+}
+
+void Metrics::recordRejectedSample() {
+  rejectedSamples++;
+}
+
+void Metrics::recordFailedRead() {
+  failedReads++;
+}
+
+void Metrics::recordNvsWrite(const char* nameSpace, uint8_t writes) {
+  for (uint8_t i = 0; i < nvsCount; i++) {
+    // Namespaces are literals, but compare contents in case of duplicates across units
+    if (nvs[i].nameSpace == nameSpace || strcmp(nvs[i].nameSpace, nameSpace) == 0) {
+      nvs[i].writes += writes;
+      return;
+    }
+  }
+  if (nvsCount < MAX_NVS_NAMESPACES) {
+    nvs[nvsCount++] = {nameSpace, writes};
+  }
+}
+
+void Metrics::recordWebhookSend(uint32_t durationUs, bool success) {
+  webhookHistogram.record(durationUs);
+  if (!success) {
+    webhookFailures++;
+  }
+}
+
+void Metrics::recordWifiReconnect() {
+  wifiReconnects++;
+}
+
+void Metrics::recordWifiDisconnect() {
+  wifiDisconnects++;
+}
+
+// Accumulates formatted lines in a fixed buffer and emits full chunks
+class MetricsOutput {
+public:
+  MetricsOutput(Metrics::EmitFunction emit, void* context) : emit(emit), context(context) {}
+
+  void printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    char line[160];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (length <= 0) return;
+    if ((size_t)length >= sizeof(line)) length = sizeof(line) - 1;
+
+    if (used + length > sizeof(buffer)) flush();
+    memcpy(buffer + used, line, length);
+    used += length;
+  }
+
+  void flush() {
+    if (used > 0) emit(buffer, used, context);
+    used = 0;
+  }
+
+private:
+  Metrics::EmitFunction emit;
+  void* context;
+  char buffer[Metrics::OUTPUT_CHUNK];
+  size_t used = 0;
+};
+
+// The maximum is its own gauge family: a _max sample is not part of the
+// histogram type and strict parsers reject it there
+static void writeHistogram(MetricsOutput& out, const char* name, const char* maxName,
+                           const char* help, const LatencyHistogram& h) {
+  out.printf("# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+  uint32_t cumulative = 0;
+  for (uint8_t i = 0; i < LatencyHistogram::BUCKETS; i++) {
+    cumulative += h.counts[i];
+    out.printf("%s_bucket{le=\"%g\"} %lu\n", name, LatencyHistogram::BOUNDS_US[i] / 1e6,
+               (unsigned long)cumulative);
+  }
+  out.printf("%s_bucket{le=\"+Inf\"} %lu\n", name, (unsigned long)h.total);
+  out.printf("%s_sum %.6f\n%s_count %lu\n", name, h.sumUs / 1e6, name, (unsigned long)h.total);
+  out.printf("# TYPE %s gauge\n%s %.6f\n", maxName, maxName, h.maxUs / 1e6);
+}
+
+void Metrics::writePrometheus(EmitFunction emit, void* context) {
+  MetricsOutput out(emit, context);
+
+  out.printf("# TYPE doughtracker_uptime_seconds gauge\ndoughtracker_uptime_seconds %lu\n",
+             (unsigned long)(millis() / 1000));
+
+  out.printf("# TYPE doughtracker_heap_free_bytes gauge\ndoughtracker_heap_free_bytes %lu\n",
+             (unsigned long)ESP.getFreeHeap());
+  out.printf("# TYPE doughtracker_heap_min_free_bytes gauge\ndoughtracker_heap_min_free_bytes %lu\n",
+             (unsigned long)ESP.getMinFreeHeap());
+  out.printf("# TYPE doughtracker_heap_largest_free_block_bytes gauge\n"
+             "doughtracker_heap_largest_free_block_bytes %lu\n",
+             (unsigned long)ESP.getMaxAllocHeap());
+
+  writeHistogram(out, "doughtracker_loop_duration_seconds", "doughtracker_loop_duration_max_seconds",
+                 "Time spent in one loop() pass excluding the idle delay", loopHistogram);
+
+  out.printf("# TYPE doughtracker_http_requests_total counter\n");
+  for (uint8_t i = 0; i < routeCount; i++) {
+    out.printf("doughtracker_http_requests_total{route=\"%s\",method=\"%s\"} %lu\n",
+               routes[i].uri, routes[i].method, (unsigned long)routes[i].requests);
+  }
+  out.printf("# TYPE doughtracker_http_handler_seconds summary\n");
+  for (uint8_t i = 0; i < routeCount; i++) {
+    out.printf("doughtracker_http_handler_seconds_sum{route=\"%s\",method=\"%s\"} %.6f\n",
+               routes[i].uri, routes[i].method, routes[i].totalUs / 1e6);
+    out.printf("doughtracker_http_handler_seconds_count{route=\"%s\",method=\"%s\"} %lu\n",
+               routes[i].uri, routes[i].method, (unsigned long)routes[i].requests);
+  }
+  out.printf("# TYPE doughtracker_http_handler_max_seconds gauge\n");
+  for (uint8_t i = 0; i < routeCount; i++) {
+    out.printf("doughtracker_http_handler_max_seconds{route=\"%s\",method=\"%s\"} %.6f\n",
+               routes[i].uri, routes[i].method, routes[i].maxUs / 1e6);
+  }
+
+  writeHistogram(out, "doughtracker_sensor_sweep_seconds", "doughtracker_sensor_sweep_max_seconds",
+                 "Duration of one averaged sensor sweep", sensorSweepHistogram);
+  out.printf("# TYPE doughtracker_sensor_samples_rejected_total counter\n"
+             "doughtracker_sensor_samples_rejected_total %lu\n", (unsigned long)rejectedSamples);
+  out.printf("# TYPE doughtracker_sensor_read_failures_total counter\n"
+             "doughtracker_sensor_read_failures_total %lu\n", (unsigned long)failedReads);
+  out.printf("# TYPE doughtracker_sensor_sweeps_shared_total counter\n"
+             "doughtracker_sensor_sweeps_shared_total %lu\n", (unsigned long)sharedSweeps);
+
+  out.printf("# TYPE doughtracker_nvs_writes_total counter\n");
+  for (uint8_t i = 0; i < nvsCount; i++) {
+    out.printf("doughtracker_nvs_writes_total{namespace=\"%s\"} %lu\n",
+               nvs[i].nameSpace, (unsigned long)nvs[i].writes);
+  }
+
+  writeHistogram(out, "doughtracker_webhook_send_seconds", "doughtracker_webhook_send_max_seconds",
+                 "Webhook HTTP POST latency", webhookHistogram);
+  out.printf("# TYPE doughtracker_webhook_failures_total counter\n"
+             "doughtracker_webhook_failures_total %lu\n", (unsigned long)webhookFailures);
+
+  out.printf("# TYPE doughtracker_wifi_reconnects_total counter\n"
+             "doughtracker_wifi_reconnects_total %lu\n", (unsigned long)wifiReconnects);
+  out.printf("# TYPE doughtracker_wifi_disconnects_total counter\n"
+             "doughtracker_wifi_disconnects_total %lu\n", (unsigned long)wifiDisconnects);
+  out.printf("# TYPE doughtracker_log_dropped_total counter\n"
+             "doughtracker_log_dropped_total %lu\n", (unsigned long)logger.getDropped());
+  // No sample while disconnected; 0 dBm would read as a perfect signal
+  out.printf("# TYPE doughtracker_wifi_rssi_dbm gauge\n");
+  if (WiFi.status() == WL_CONNECTED) {
+    out.printf("doughtracker_wifi_rssi_dbm %ld\n", (long)WiFi.RSSI());
+  }
+
+  out.flush();
+}
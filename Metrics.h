@@ -0,0 +1,101 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+
+// Fixed-bucket latency histogram in microseconds (Prometheus style, cumulative on output)
+class LatencyHistogram {
+public:
+  static const uint8_t BUCKETS = 15;
+  static const uint32_t BOUNDS_US[BUCKETS];
+
+  void record(uint32_t durationUs);
+
+  uint32_t counts[BUCKETS + 1] = {0};  // Last slot is +Inf
+  uint32_t total = 0;
+  uint64_t sumUs = 0;
+  uint32_t maxUs = 0;
+};
+
+struct RouteMetrics {
+  const char* uri;
+  const char* method;
+  uint32_t requests;
+  uint64_t totalUs;
+  uint32_t maxUs;
+};
+
+struct NvsMetrics {
+  const char* nameSpace;
+  uint32_t writes;
+};
+
+/*
+ * Firmware hot-path counters served on /metrics.
+ *
+ * Everything is preallocated: recording is a few integer updates with no
+ * heap allocation, so it is safe to call from the sampling and HTTP paths.
+ * Names passed in (routes, NVS namespaces) must be string literals.
+ */
+class Metrics {
+public:
+  static const uint8_t MAX_ROUTES = 32;
+  static const uint8_t MAX_NVS_NAMESPACES = 6;
+
+  // Register an HTTP route at startup, returns its slot (-1 if the table is full)
+  int8_t registerRoute(const char* uri, const char* method);
+
+  // Count a handled request and its handler duration
+  void recordRequest(int8_t route, uint32_t durationUs);
+
+  // Duration of one loop() pass, excluding the idle delay
+  void recordLoopIteration(uint32_t durationUs);
+
+  // Duration of one getAveragedDistance() sweep
+  void recordSensorSweep(uint32_t durationUs);
+
+  // On-demand reading served from another caller's sweep
+  void recordSharedSweep();
+
+  // Samples dropped by the outlier filter / failed sensor reads
+  void recordRejectedSample();
+  void recordFailedRead();
+
+  // NVS put/clear operations per namespace
+  void recordNvsWrite(const char* nameSpace, uint8_t writes = 1);
+
+  // Webhook delivery latency and outcome
+  void recordWebhookSend(uint32_t durationUs, bool success);
+
+  // WiFi link transitions
+  void recordWifiReconnect();
+  void recordWifiDisconnect();
+
+  // Write all metrics in Prometheus text format. Output is produced in
+  // chunks of at most OUTPUT_CHUNK bytes through the emit callback.
+  static const size_t OUTPUT_CHUNK = 512;
+  typedef void (*EmitFunction)(const char* data, size_t length, void* context);
+  void writePrometheus(EmitFunction emit, void* context);
+
+private:
+  LatencyHistogram loopHistogram;
+  LatencyHistogram sensorSweepHistogram;
+  LatencyHistogram webhookHistogram;
+
+  RouteMetrics routes[MAX_ROUTES];
+  uint8_t routeCount = 0;
+
+  NvsMetrics nvs[MAX_NVS_NAMESPACES];
+  uint8_t nvsCount = 0;
+
+  uint32_t rejectedSamples = 0;
+  uint32_t failedReads = 0;
+  uint32_t sharedSweeps = 0;
+  uint32_t webhookFailures = 0;
+  uint32_t wifiReconnects = 0;
+  uint32_t wifiDisconnects = 0;
+};
+
+extern Metrics metrics;
+
+#endif
@@ -1,520 +1,958 @@
-#include "MyWebServer.h"
-#include "WebPages.h"
-#include "SensorManager.h"
-#include "CalibrationManager.h"
-#include "DataManager.h"
-#include "WifiManager.h"
-#include "WebhookManager.h"
-#include "config.h"
-
-// Declare external function from doughtracker.ino
-extern void resetMeasurementTimer();
-
-MyWebServer::MyWebServer(SensorManager* sensor, CalibrationManager* calib, DataManager* data, WifiManager* wifi, WebhookManager* webhook)
-  : sensorManager(sensor), calibManager(calib), dataManager(data), wifiManager(wifi), webhookManager(webhook) {
-  server = new WebServer(WEB_SERVER_PORT);
-}
-
-MyWebServer::~MyWebServer() {
-  if (server) {
-    delete server;
-    server = nullptr;
-  }
-}
-
-void MyWebServer::begin() {
-  Serial.println("[WebServer] Initializing web server...");
-  
-  if (!server) {
-    Serial.println("[WebServer] ERROR: Server not initialized!");
-    return;
-  }
-  
-  // Ensure WiFi stack is initialized (required for WebServer on ESP32)
-  if (WiFi.getMode() == WIFI_OFF) {
-    Serial.println("[WebServer] WiFi stack not initialized, setting to STA mode...");
-    WiFi.mode(WIFI_STA);
-    delay(100);
-  }
-  
-  // Setup routes
-  server->on("/", HTTP_GET, [this]() { this->handleRoot(); });
-  server->on("/data", HTTP_GET, [this]() { this->handleData(); });
-  server->on("/status", HTTP_GET, [this]() { this->handleStatus(); });
-  server->on("/api/calibrate", HTTP_POST, [this]() { this->handleCalibrate(); });
-  server->on("/api/calibrate-dough", HTTP_POST, [this]() { this->handleCalibrateDough(); });
-  server->on("/api/measure", HTTP_POST, [this]() { this->handleMeasure(); });
-  server->on("/api/offset", HTTP_POST, [this]() { this->handleOffset(); });
-  server->on("/api/reset-data", HTTP_POST, [this]() { this->handleResetData(); });
-  server->on("/api/reset-wifi", HTTP_POST, [this]() { this->handleResetWifi(); });
-  server->on("/api/scan-networks", HTTP_GET, [this]() { this->handleScanNetworks(); });
-  server->on("/api/connect-wifi", HTTP_POST, [this]() { this->handleConnectWiFi(); });
-  server->on("/api/webhook", HTTP_GET, [this]() { this->handleGetWebhook(); });
-  server->on("/api/webhook", HTTP_POST, [this]() { this->handleSetWebhook(); });
-  server->on("/api/test-webhook", HTTP_POST, [this]() { this->handleTestWebhook(); });
-  server->on("/api/presets", HTTP_GET, [this]() { this->handleGetPresets(); });
-  server->on("/api/presets", HTTP_POST, [this]() { this->handleSavePreset(); });
-  server->on("/api/presets", HTTP_DELETE, [this]() { this->handlePresetAction(); });
-  server->onNotFound([this]() { this->handleNotFound(); });
-  
-  // Small delay to ensure network stack is ready
-  delay(100);
-  
-  server->begin();
-  Serial.printf("[WebServer] Web server started on port %d\n", WEB_SERVER_PORT);
-}
-
-void MyWebServer::handleClient() {
-  if (server) {
-    server->handleClient();
-  }
-}
-
-void MyWebServer::stop() {
-  if (server) {
-    server->stop();
-    Serial.println("[WebServer] Web server stopped");
-  }
-}
-
-void MyWebServer::handleRoot() {
-  Serial.println("[WebServer] GET /");
-  server->send(200, "text/html; charset=UTF-8", WebPages::getIndexHTML());
-}
-
-void MyWebServer::handleData() {
-  Serial.println("[WebServer] GET /data");
-  
-  String json = "{\"measurements\":[";
-  
-  for (uint16_t i = 0; i < dataManager->getCount(); i++) {
-    DataPoint dp = dataManager->getMeasurement(i);
-    
-    if (i > 0) json += ",";
-    
-    // Convert timestamp to 24-hour format
-    time_t t = dp.timestamp;
-    struct tm *timeinfo = localtime(&t);
-    
-    char timeBuffer[20];
-    strftime(timeBuffer, sizeof(timeBuffer), "%H:%M:%S", timeinfo);
-    
-    json += "{\"time\":\"";
-    json += timeBuffer;
-    json += "\",\"timestamp\":";
-    json += (unsigned long)dp.timestamp;
-    json += ",\"thickness\":";
-    json += dp.thickness;
-    json += ",\"rise\":";
-    json += dp.risePercentage;
-    json += "}";
-  }
-  
-  json += "]}";
-  server->send(200, "application/json", json);
-}
-
-void MyWebServer::handleStatus() {
-  Serial.println("[WebServer] GET /status");
-  
-  String json = "{\"wifiConnected\":";
-  json += wifiManager->isConnected() ? "true" : "false";
-  json += ",\"ip\":\"";
-  json += wifiManager->getLocalIP();
-  json += "\",\"ssid\":\"";
-  json += wifiManager->getSSID();
-  json += "\",\"calibrated\":";
-  json += calibManager->isCalibrated() ? "true" : "false";
-  json += ",\"hasData\":";
-  json += dataManager->hasData() ? "true" : "false";
-  json += ",\"dataPoints\":";
-  json += dataManager->getCount();
-  json += ",\"initialThickness\":";
-  json += calibManager->getInitialDoughThickness();
-  json += ",\"calibrationTime\":";
-  json += calibManager->getCalibrationTime();
-  json += "}";
-  
-  server->send(200, "application/json", json);
-}
-
-void MyWebServer::handleCalibrate() {
-  Serial.println("[WebServer] POST /api/calibrate");
-  
-  if (!sensorManager->isInitialized()) {
-    server->send(500, "application/json", "{\"error\":\"Sensor not initialized\"}");
-    return;
-  }
-  
-  // Take measurement for zero point
-  uint16_t distance = sensorManager->getAveragedDistance(5);
-  calibManager->setZeroPoint(distance);
-  
-  String json = "{\"success\":true,\"zeroPoint\":";
-  json += distance;
-  json += "}";
-  
-  server->send(200, "application/json", json);
-}
-
-void MyWebServer::handleCalibrateDough() {
-  Serial.println("[WebServer] POST /api/calibrate-dough");
-
-  if (!sensorManager->isInitialized()) {
-    server->send(500, "application/json", "{\"error\":\"Sensor not initialized\"}");
-    return;
-  }
-
-  if (!calibManager->isCalibrated()) {
-    server->send(400, "application/json", "{\"error\":\"Container not calibrated first\"}");
-    return;
-  }
-
-  // Take measurement for dough height
-  uint16_t distance = sensorManager->getAveragedDistance(5);
-  calibManager->setDoughHeight(distance);
-  uint16_t initialThickness = calibManager->getInitialDoughThickness();
-
-  // Check for invalid calibration (dough distance >= empty container distance)
-  // This happens due to sensor fluctuation when no dough is present
-  if (initialThickness == 0) {
-    // Reset the invalid dough height so user can retry
-    calibManager->resetDoughHeight();
-    server->send(400, "application/json",
-      "{\"error\":\"Invalid reading: dough not detected. Please ensure dough is in the container and try again.\"}");
-    return;
-  }
-
-  // Reset the measurement timer now that dough is calibrated
-  // This ensures the first measurement happens 15 minutes from now
-  resetMeasurementTimer();
-
-  String json = "{\"success\":true,\"doughHeight\":";
-  json += distance;
-  json += ",\"initialThickness\":";
-  json += initialThickness;
-  json += "}";
-
-  server->send(200, "application/json", json);
-}
-
-void MyWebServer::handleMeasure() {
-  Serial.println("[WebServer] POST /api/measure");
-  
-  if (!calibManager->isCalibrated()) {
-    server->send(400, "application/json", "{\"error\":\"Not calibrated\"}");
-    return;
-  }
-  
-  if (!sensorManager->isInitialized()) {
-    server->send(500, "application/json", "{\"error\":\"Sensor not initialized\"}");
-    return;
-  }
-  
-  // Take measurement
-  uint16_t distance = sensorManager->getAveragedDistance(5);
-  uint16_t thickness = calibManager->calculateDoughThickness(distance);
-  
-  // Use the initial dough thickness from calibration, not from first measurement
-  uint16_t initialThickness = calibManager->getInitialDoughThickness();
-  float risePercentage = calibManager->calculateRisePercentage(thickness, initialThickness);
-  
-  dataManager->addMeasurement(thickness, risePercentage);
-  
-  String json = "{\"success\":true,\"distance\":";
-  json += distance;
-  json += ",\"thickness\":";
-  json += thickness;
-  json += ",\"rise\":";
-  json += risePercentage;
-  json += "}";
-  
-  server->send(200, "application/json", json);
-}
-
-void MyWebServer::handleOffset() {
-  Serial.println("[WebServer] POST /api/offset");
-  
-  if (!server->hasArg("plain")) {
-    server->send(400, "application/json", "{\"error\":\"No data\"}");
-    return;
-  }
-  
-  String body = server->arg("plain");
-  
-  // Parse JSON (simple extraction)
-  int offsetPos = body.indexOf("\"offset\":");
-  if (offsetPos == -1) {
-    server->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
-    return;
-  }
-  
-  int offset = body.substring(offsetPos + 9).toInt();
-  calibManager->setOffset(offset);
-  
-  String json = "{\"success\":true,\"offset\":";
-  json += offset;
-  json += "}";
-  
-  server->send(200, "application/json", json);
-}
-
-void MyWebServer::handleResetData() {
-  Serial.println("[WebServer] POST /api/reset-data");
-
-  // Reset measurement data
-  dataManager->reset();
-
-  // Reset dough height only (preserves zero point calibration for the container)
-  // This allows users to start a new bake without recalibrating the empty container
-  calibManager->resetDoughHeight();
-
-  // Reset webhook threshold flags for new fermentation cycle
-  webhookManager->resetThresholds();
-
-  server->send(200, "application/json", "{\"success\":true}");
-}
-
-void MyWebServer::handleResetWifi() {
-  Serial.println("[WebServer] POST /api/reset-wifi");
-  
-  server->send(200, "application/json", "{\"success\":true}");
-  delay(100);
-  
-  wifiManager->resetWiFi();
-  delay(1000);
-  
-  ESP.restart();
-}
-
-void MyWebServer::handleScanNetworks() {
-  Serial.println("[WebServer] GET /api/scan-networks");
-  
-  String json = wifiManager->getNetworksJSON();
-  server->send(200, "application/json", json);
-}
-
-void MyWebServer::handleConnectWiFi() {
-  Serial.println("[WebServer] POST /api/connect-wifi");
-  
-  if (!server->hasArg("plain")) {
-    server->send(400, "application/json", "{\"error\":\"No data provided\"}");
-    return;
-  }
-  
-  String body = server->arg("plain");
-  
-  // Parse JSON - simple extraction of ssid and password
-  int ssidPos = body.indexOf("\"ssid\":\"");
-  int pwdPos = body.indexOf("\"password\":\"");
-  
-  if (ssidPos == -1 || pwdPos == -1) {
-    server->send(400, "application/json", "{\"error\":\"Invalid JSON format\"}");
-    return;
-  }
-  
-  // Extract SSID
-  int ssidStart = ssidPos + 8;
-  int ssidEnd = body.indexOf("\"", ssidStart);
-  String ssid = body.substring(ssidStart, ssidEnd);
-  
-  // Extract password
-  int pwdStart = pwdPos + 12;
-  int pwdEnd = body.indexOf("\"", pwdStart);
-  String password = body.substring(pwdStart, pwdEnd);
-  
-  Serial.printf("[WebServer] Attempting to connect to: %s\n", ssid.c_str());
-  
-  // Attempt connection
-  bool connected = wifiManager->connectToNetwork(ssid.c_str(), password.c_str());
-  
-  if (connected) {
-    String json = "{\"success\":true,\"ssid\":\"";
-    json += ssid;
-    json += "\",\"ip\":\"";
-    json += wifiManager->getLocalIP();
-    json += "\"}";
-    server->send(200, "application/json", json);
-    
-    // Try to setup mDNS after connection
-    wifiManager->setupMDNS("dough");
-  } else {
-    server->send(400, "application/json", "{\"success\":false,\"error\":\"Failed to connect\"}");
-  }
-}
-
-void MyWebServer::handleNotFound() {
-  Serial.println("[WebServer] 404 - Not Found");
-  server->send(404, "text/plain", "Not Found");
-}
-
-String MyWebServer::jsonResponse(const char* key, const char* value) {
-  String json = "{\"";
-  json += key;
-  json += "\":\"";
-  json += value;
-  json += "\"}";
-  return json;
-}
-
-void MyWebServer::handleGetWebhook() {
-  Serial.println("[WebServer] GET /api/webhook");
-
-  String json = "{\"url\":\"";
-  json += webhookManager->getWebhookURL();
-  json += "\",\"enabled\":";
-  json += webhookManager->isEnabled() ? "true" : "false";
-  json += ",\"configured\":";
-  json += webhookManager->isConfigured() ? "true" : "false";
-  json += ",\"threshold50Reached\":";
-  json += webhookManager->isThreshold50Reached() ? "true" : "false";
-  json += ",\"threshold100Reached\":";
-  json += webhookManager->isThreshold100Reached() ? "true" : "false";
-  json += ",\"threshold200Reached\":";
-  json += webhookManager->isThreshold200Reached() ? "true" : "false";
-  json += "}";
-
-  server->send(200, "application/json", json);
-}
-
-void MyWebServer::handleSetWebhook() {
-  Serial.println("[WebServer] POST /api/webhook");
-
-  if (!server->hasArg("plain")) {
-    server->send(400, "application/json", "{\"error\":\"No data\"}");
-    return;
-  }
-
-  String body = server->arg("plain");
-
-  // Parse JSON - extract url and enabled
-  int urlPos = body.indexOf("\"url\":\"");
-  int enabledPos = body.indexOf("\"enabled\":");
-
-  if (urlPos != -1) {
-    int urlStart = urlPos + 7;
-    int urlEnd = body.indexOf("\"", urlStart);
-    String url = body.substring(urlStart, urlEnd);
-    webhookManager->setWebhookURL(url);
-  }
-
-  if (enabledPos != -1) {
-    bool enabled = body.substring(enabledPos + 10).indexOf("true") != -1;
-    webhookManager->setEnabled(enabled);
-  }
-
-  String json = "{\"success\":true,\"url\":\"";
-  json += webhookManager->getWebhookURL();
-  json += "\",\"enabled\":";
-  json += webhookManager->isEnabled() ? "true" : "false";
-  json += "}";
-
-  server->send(200, "application/json", json);
-}
-
-void MyWebServer::handleTestWebhook() {
-  Serial.println("[WebServer] POST /api/test-webhook");
-
-  if (!webhookManager->isConfigured()) {
-    server->send(400, "application/json",
-                 "{\"success\":false,\"error\":\"Webhook not configured\"}");
-    return;
-  }
-
-  // Send a test notification
-  bool success = webhookManager->sendTestNotification();
-
-  if (success) {
-    server->send(200, "application/json", "{\"success\":true}");
-  } else {
-    server->send(500, "application/json",
-                 "{\"success\":false,\"error\":\"Failed to send test notification\"}");
-  }
-}
-
-void MyWebServer::handleGetPresets() {
-  Serial.println("[WebServer] GET /api/presets");
-
-  String json = "{\"presets\":[";
-  char name[12];
-  uint16_t zp;
-
-  for (uint8_t i = 0; i < calibManager->getPresetCount(); i++) {
-    if (i > 0) json += ",";
-    calibManager->getPreset(i, name, &zp);
-    json += "{\"n\":\"";
-    json += name;
-    json += "\",\"z\":";
-    json += zp;
-    json += "}";
-  }
-  json += "]}";
-
-  server->send(200, "application/json", json);
-}
-
-void MyWebServer::handleSavePreset() {
-  Serial.println("[WebServer] POST /api/presets");
-
-  if (!server->hasArg("plain")) {
-    server->send(400, "application/json", "{\"e\":\"No data\"}");
-    return;
-  }
-
-  String body = server->arg("plain");
-  int namePos = body.indexOf("\"n\":\"");
-  if (namePos == -1) {
-    server->send(400, "application/json", "{\"e\":\"Invalid JSON\"}");
-    return;
-  }
-
-  int nameStart = namePos + 5;
-  int nameEnd = body.indexOf("\"", nameStart);
-  String name = body.substring(nameStart, nameEnd);
-
-  if (calibManager->savePreset(name.c_str())) {
-    server->send(200, "application/json", "{\"ok\":1}");
-  } else {
-    server->send(400, "application/json", "{\"e\":\"Save failed\"}");
-  }
-}
-
-void MyWebServer::handlePresetAction() {
-  Serial.println("[WebServer] DELETE /api/presets");
-
-  if (!server->hasArg("plain")) {
-    server->send(400, "application/json", "{\"e\":\"No data\"}");
-    return;
-  }
-
-  String body = server->arg("plain");
-
-  // Parse index
-  int idxPos = body.indexOf("\"i\":");
-  if (idxPos == -1) {
-    server->send(400, "application/json", "{\"e\":\"No index\"}");
-    return;
-  }
-  uint8_t idx = body.substring(idxPos + 4).toInt();
-
-  // Parse action
-  int actPos = body.indexOf("\"a\":\"");
-  if (actPos == -1) {
-    server->send(400, "application/json", "{\"e\":\"No action\"}");
-    return;
-  }
-  char action = body.charAt(actPos + 5);
-
-  bool success = false;
-  if (action == 'l') {
-    success = calibManager->loadPreset(idx);
-  } else if (action == 'd') {
-    success = calibManager->deletePreset(idx);
-  }
-
-  if (success) {
-    server->send(200, "application/json", "{\"ok\":1}");
-  } else {
-    server->send(400, "application/json", "{\"e\":\"Action failed\"}");
-  }
-}
+#include "MyWebServer.h"
+#include "WebPages.h"
+#include "SensorManager.h"
+#include "CalibrationManager.h"
+#include "DataManager.h"
+#include "WifiManager.h"
+#include "WebhookManager.h"
+#include "Metrics.h"
+#include "Log.h"
+#include "LogStream.h"
+#include "config.h"
+
+// Declare external function from doughtracker.ino
+extern void resetMeasurementTimer();
+
+MyWebServer::MyWebServer(SensorManager* sensor, CalibrationManager* calib, DataManager* data, WifiManager* wifi, WebhookManager* webhook)
+  : sensorManager(sensor), calibManager(calib), dataManager(data), wifiManager(wifi), webhookManager(webhook) {
+  server = new WebServer(WEB_SERVER_PORT);
+}
+
+MyWebServer::~MyWebServer() {
+  if (server) {
+    delete server;
+    server = nullptr;
+  }
+}
+
+void MyWebServer::begin() {
+  LOG_I(WebServer, "[WebServer] Initializing web server...\n");
+  
+  if (!server) {
+    LOG_E(WebServer, "[WebServer] ERROR: Server not initialized!\n");
+    return;
+  }
+  
+  // Ensure WiFi stack is initialized (required for WebServer on ESP32)
+  if (WiFi.getMode() == WIFI_OFF) {
+    LOG_I(WebServer, "[WebServer] WiFi stack not initialized, setting to STA mode...\n");
+    WiFi.mode(WIFI_STA);
+    delay(100);
+  }
+  
+  // Setup routes
+  addRoute("/", HTTP_GET, &MyWebServer::handleRoot);
+  addRoute("/data", HTTP_GET, &MyWebServer::handleData);
+  addRoute("/status", HTTP_GET, &MyWebServer::handleStatus);
+  addRoute("/api/bootstrap", HTTP_GET, &MyWebServer::handleBootstrap);
+  addRoute("/api/calibrate", HTTP_POST, &MyWebServer::handleCalibrate);
+  addRoute("/api/calibrate-dough", HTTP_POST, &MyWebServer::handleCalibrateDough);
+  addRoute("/api/measure", HTTP_POST, &MyWebServer::handleMeasure);
+  addRoute("/api/offset", HTTP_POST, &MyWebServer::handleOffset);
+  addRoute("/api/reset-data", HTTP_POST, &MyWebServer::handleResetData);
+  addRoute("/api/reset-wifi", HTTP_POST, &MyWebServer::handleResetWifi);
+  addRoute("/api/scan-networks", HTTP_GET, &MyWebServer::handleScanNetworks);
+  addRoute("/api/connect-wifi", HTTP_POST, &MyWebServer::handleConnectWiFi);
+  addRoute("/api/connect-wifi", HTTP_GET, &MyWebServer::handleConnectStatus);
+  addRoute("/api/webhook", HTTP_GET, &MyWebServer::handleGetWebhook);
+  addRoute("/api/webhook", HTTP_POST, &MyWebServer::handleSetWebhook);
+  addRoute("/api/test-webhook", HTTP_POST, &MyWebServer::handleTestWebhook);
+  addRoute("/api/presets", HTTP_GET, &MyWebServer::handleGetPresets);
+  addRoute("/api/presets", HTTP_POST, &MyWebServer::handleSavePreset);
+  addRoute("/api/presets", HTTP_DELETE, &MyWebServer::handlePresetAction);
+  addRoute("/metrics", HTTP_GET, &MyWebServer::handleMetrics);
+  addRoute("/logs", HTTP_GET, &MyWebServer::handleLogs);
+  
+  // Headers needed for the /logs WebSocket upgrade
+  const char* headerKeys[] = {"Upgrade", "Sec-WebSocket-Key"};
+  server->collectHeaders(headerKeys, 2);
+  
+  // Unmatched requests are tracked under a single "*" route
+  int8_t notFoundSlot = metrics.registerRoute("*", "ANY");
+  server->onNotFound([this, notFoundSlot]() {
+    unsigned long start = micros();
+    this->handleNotFound();
+    metrics.recordRequest(notFoundSlot, micros() - start);
+  });
+  
+  // Small delay to ensure network stack is ready
+  delay(100);
+  
+  server->begin();
+  LOG_I(WebServer, "[WebServer] Web server started on port %d\n", WEB_SERVER_PORT);
+}
+
+static const char* methodName(HTTPMethod method) {
+  switch (method) {
+    case HTTP_GET: return "GET";
+    case HTTP_POST: return "POST";
+    case HTTP_DELETE: return "DELETE";
+    default: return "ANY";
+  }
+}
+
+void MyWebServer::addRoute(const char* uri, HTTPMethod method, void (MyWebServer::*handler)()) {
+  int8_t slot = metrics.registerRoute(uri, methodName(method));
+  server->on(uri, method, [this, handler, slot]() {
+    unsigned long start = micros();
+    (this->*handler)();
+    metrics.recordRequest(slot, micros() - start);
+  });
+}
+
+void MyWebServer::handleClient() {
+  if (server) {
+    server->handleClient();
+  }
+}
+
+void MyWebServer::stop() {
+  if (server) {
+    server->stop();
+    LOG_I(WebServer, "[WebServer] Web server stopped\n");
+  }
+}
+
+void MyWebServer::handleRoot() {
+  LOG_D(WebServer, "[WebServer] GET /\n");
+  server->send(200, "text/html; charset=UTF-8", WebPages::getIndexHTML());
+}
+
+void MyWebServer::handleData() {
+  LOG_D(WebServer, "[WebServer] GET /data\n");
+  
+  // ?maxPoints=N reduces the series to about the chart's pixel width;
+  // ?from=&to= (Unix seconds) selects a time range from the finest tier
+  // that covers it
+  unsigned long maxPoints = 0;
+  unsigned long from = 0;
+  unsigned long to = 0xFFFFFFFFUL;
+  if (!parseUintArg("maxPoints", &maxPoints, UINT16_MAX)) return;
+  if (!parseUintArg("from", &from, 0xFFFFFFFFUL)) return;
+  if (!parseUintArg("to", &to, 0xFFFFFFFFUL)) return;
+  bool range = server->hasArg("from") || server->hasArg("to");
+  
+  // Streamed, so the response size does not depend on free heap
+  char buffer[JSON_CHUNK_SIZE];
+  JsonWriter json(buffer, sizeof(buffer), streamJson, server);
+  beginJsonStream(200);
+  json.beginObject();
+  json.key("measurements");
+  if (range) {
+    dataManager->writeRangeJSON(json, from, to, maxPoints);
+  } else {
+    dataManager->writeMeasurementsJSON(json, maxPoints);
+  }
+  json.endObject();
+  endJsonStream(json);
+}
+
+void MyWebServer::handleStatus() {
+  LOG_D(WebServer, "[WebServer] GET /status\n");
+  
+  // Streamed: the forecast lists every webhook threshold
+  char buffer[JSON_CHUNK_SIZE];
+  JsonWriter json(buffer, sizeof(buffer), streamJson, server);
+  beginJsonStream(200);
+  writeStatusJSON(json);
+  endJsonStream(json);
+}
+
+void MyWebServer::handleBootstrap() {
+  LOG_D(WebServer, "[WebServer] GET /api/bootstrap\n");
+  
+  unsigned long maxPoints = 0;
+  if (!parseUintArg("maxPoints", &maxPoints, UINT16_MAX)) return;
+  
+  // Everything the page needs for its first paint in one streamed response:
+  // the same documents as /status, /data, /api/webhook and /api/presets
+  char buffer[JSON_CHUNK_SIZE];
+  JsonWriter json(buffer, sizeof(buffer), streamJson, server);
+  beginJsonStream(200);
+  json.beginObject();
+  json.key("status");
+  writeStatusJSON(json);
+  json.key("webhook");
+  writeWebhookJSON(json);
+  json.key("presets");
+  writePresetsJSON(json);
+  json.key("measurements");
+  dataManager->writeMeasurementsJSON(json, maxPoints);
+  json.endObject();
+  endJsonStream(json);
+}
+
+void MyWebServer::writeStatusJSON(JsonWriter& json) {
+  json.beginObject();
+  json.field("wifiConnected", wifiManager->isConnected());
+  json.field("wifiConnecting", wifiManager->isConnecting());
+  json.field("ip", wifiManager->getLocalIP());
+  json.field("ssid", wifiManager->getSSID());
+  json.field("calibrated", calibManager->isCalibrated());
+  json.field("hasData", dataManager->hasData());
+  json.field("dataPoints", dataManager->getCount());
+  json.field("initialThickness", calibManager->getInitialDoughThickness());
+  json.field("calibrationTime", calibManager->getCalibrationTime());
+  json.key("stats");
+  dataManager->writeStatsJSON(json);
+  json.key("forecast");
+  writeForecastJSON(json);
+  json.endObject();
+}
+
+void MyWebServer::writeForecastJSON(JsonWriter& json) {
+  const RiseForecast& forecast = dataManager->getForecast();
+  bool ready = forecast.isReady();
+  unsigned long at, earliest, latest;
+  
+  json.beginObject();
+  json.field("ready", ready);
+  json.field("samples", forecast.getSampleCount());
+  json.field("residual", ready ? forecast.getResidual() : NAN, 1);
+  
+  // Predicted time each webhook threshold is crossed, with a 95% interval
+  json.key("thresholds");
+  json.beginArray();
+  for (uint8_t i = 0; i < webhookManager->getThresholdCount(); i++) {
+    const WebhookThreshold& threshold = webhookManager->getThreshold(i);
+    // Falling thresholds are about a collapse, which the fit does not model
+    bool predicted = ready && !threshold.falling &&
+                     forecast.predictTime(riseToPercent(threshold.rise), &at, &earliest, &latest);
+    json.beginObject();
+    json.fieldFixed("rise", threshold.rise, RISE_DECIMALS);
+    json.field("falling", threshold.falling);
+    json.field("reached", webhookManager->isThresholdReached(i));
+    writeForecastTimes(json, predicted, at, earliest, latest);
+    json.endObject();
+  }
+  json.endArray();
+  
+  // Plateau height and the time the rise gets within 5% of it
+  json.key("peak");
+  json.beginObject();
+  bool predicted = ready && forecast.predictPeakTime(&at, &earliest, &latest);
+  float margin = forecast.getPeakRiseMargin();
+  json.field("rise", ready ? forecast.getPeakRise() : NAN, 1);
+  json.field("riseLow", ready ? forecast.getPeakRise() - margin : NAN, 1);
+  json.field("riseHigh", ready ? forecast.getPeakRise() + margin : NAN, 1);
+  writeForecastTimes(json, predicted, at, earliest, latest);
+  json.endObject();
+  json.endObject();
+}
+
+void MyWebServer::writeForecastTimes(JsonWriter& json, bool valid, unsigned long at,
+                                     unsigned long earliest, unsigned long latest) {
+  const char* names[3] = {"at", "earliest", "latest"};
+  unsigned long times[3] = {at, earliest, latest};
+  for (uint8_t i = 0; i < 3; i++) {
+    json.key(names[i]);
+    if (valid) {
+      json.value(times[i]);
+    } else {
+      json.valueNull();
+    }
+  }
+}
+
+void MyWebServer::handleCalibrate() {
+  LOG_D(WebServer, "[WebServer] POST /api/calibrate\n");
+  
+  if (!sensorManager->isInitialized()) {
+    sendJson(500, "{\"error\":\"Sensor not initialized\"}");
+    return;
+  }
+  
+  // Take measurement for zero point (a repeated tap shares the same sweep)
+  uint16_t distance = sensorManager->getSharedDistance(SWEEP_ZERO_POINT, 5);
+  calibManager->setZeroPoint(distance);
+  
+  char buffer[JSON_BUFFER_SIZE];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.beginObject();
+  json.field("success", true);
+  json.field("zeroPoint", distance);
+  json.endObject();
+  
+  sendJson(200, json);
+}
+
+void MyWebServer::handleCalibrateDough() {
+  LOG_D(WebServer, "[WebServer] POST /api/calibrate-dough\n");
+
+  if (!sensorManager->isInitialized()) {
+    sendJson(500, "{\"error\":\"Sensor not initialized\"}");
+    return;
+  }
+
+  if (!calibManager->isCalibrated()) {
+    sendJson(400, "{\"error\":\"Container not calibrated first\"}");
+    return;
+  }
+
+  // Take measurement for dough height
+  uint16_t distance = sensorManager->getSharedDistance(SWEEP_DOUGH_HEIGHT, 5);
+  calibManager->setDoughHeight(distance);
+  uint16_t initialThickness = calibManager->getInitialDoughThickness();
+
+  // Check for invalid calibration (dough distance >= empty container distance)
+  // This happens due to sensor fluctuation when no dough is present
+  if (initialThickness == 0) {
+    // Reset the invalid dough height so user can retry
+    calibManager->resetDoughHeight();
+    sendJson(400, "{\"error\":\"Invalid reading: dough not detected. Please ensure dough is in the container and try again.\"}");
+    return;
+  }
+
+  // Reset the measurement timer now that dough is calibrated
+  // This ensures the first measurement happens 15 minutes from now
+  resetMeasurementTimer();
+
+  char buffer[JSON_BUFFER_SIZE];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.beginObject();
+  json.field("success", true);
+  json.field("doughHeight", distance);
+  json.field("initialThickness", initialThickness);
+  json.endObject();
+
+  sendJson(200, json);
+}
+
+void MyWebServer::handleMeasure() {
+  LOG_D(WebServer, "[WebServer] POST /api/measure\n");
+  
+  if (!calibManager->isCalibrated()) {
+    sendJson(400, "{\"error\":\"Not calibrated\"}");
+    return;
+  }
+  
+  if (!sensorManager->isInitialized()) {
+    sendJson(500, "{\"error\":\"Sensor not initialized\"}");
+    return;
+  }
+  
+  // Concurrent or repeated requests share one sweep, and a sweep from the
+  // last MEASURE_FRESHNESS_MS is reused; each sweep is stored only once
+  uint32_t sweep = 0;
+  uint16_t distance = sensorManager->getSharedDistance(SWEEP_MEASUREMENT, 5, MEASURE_FRESHNESS_MS, &sweep);
+  uint16_t thickness = calibManager->calculateDoughThickness(distance);
+  
+  // Use the initial dough thickness from calibration, not from first measurement
+  uint16_t initialThickness = calibManager->getInitialDoughThickness();
+  RiseFixed rise = calibManager->calculateRise(thickness, initialThickness);
+  
+  bool recorded = sensorManager->claimSweep(sweep);
+  if (recorded) {
+    dataManager->addMeasurement(thickness, rise);
+  }
+  
+  char buffer[JSON_BUFFER_SIZE];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.beginObject();
+  json.field("success", true);
+  json.field("distance", distance);
+  json.field("thickness", thickness);
+  json.fieldFixed("rise", rise, RISE_DECIMALS);
+  json.field("shared", !recorded);
+  json.endObject();
+  
+  sendJson(200, json);
+}
+
+void MyWebServer::handleOffset() {
+  LOG_D(WebServer, "[WebServer] POST /api/offset\n");
+  
+  long offset = 0;
+  JsonField fields[] = {
+    JsonParser::intField("offset", &offset, -MAX_DISTANCE_MM, MAX_DISTANCE_MM),
+  };
+  if (!parseBody(fields, 1, "error")) return;
+  
+  calibManager->setOffset(offset);
+  
+  char buffer[JSON_BUFFER_SIZE];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.beginObject();
+  json.field("success", true);
+  json.field("offset", offset);
+  json.endObject();
+  
+  sendJson(200, json);
+}
+
+void MyWebServer::handleResetData() {
+  LOG_D(WebServer, "[WebServer] POST /api/reset-data\n");
+
+  // Reset measurement data
+  dataManager->reset();
+
+  // Reset dough height only (preserves zero point calibration for the container)
+  // This allows users to start a new bake without recalibrating the empty container
+  calibManager->resetDoughHeight();
+
+  // Reset webhook threshold flags for new fermentation cycle
+  webhookManager->resetThresholds();
+
+  sendJson(200, "{\"success\":true}");
+}
+
+void MyWebServer::handleResetWifi() {
+  LOG_D(WebServer, "[WebServer] POST /api/reset-wifi\n");
+  
+  sendJson(200, "{\"success\":true}");
+  delay(100);
+  
+  wifiManager->resetWiFi();
+  delay(1000);
+  
+  logger.flush();
+  ESP.restart();
+}
+
+void MyWebServer::handleScanNetworks() {
+  LOG_D(WebServer, "[WebServer] GET /api/scan-networks\n");
+  
+  char buffer[JSON_CHUNK_SIZE];
+  JsonWriter json(buffer, sizeof(buffer), streamJson, server);
+  beginJsonStream(200);
+  wifiManager->writeNetworksJSON(json);
+  endJsonStream(json);
+}
+
+void MyWebServer::handleConnectWiFi() {
+  LOG_D(WebServer, "[WebServer] POST /api/connect-wifi\n");
+  
+  // 802.11 limits: SSID up to 32 bytes, passphrase up to 63 characters or 64 hex digits
+  char ssid[33];
+  char password[65];
+  JsonField fields[] = {
+    JsonParser::stringField("ssid", ssid, sizeof(ssid), 1),
+    JsonParser::stringField("password", password, sizeof(password)),
+  };
+  if (!parseBody(fields, 2, "error")) return;
+  
+  LOG_I(WebServer, "[WebServer] Attempting to connect to: %s\n", ssid);
+  
+  // Answered right away; the page polls GET /api/connect-wifi for the outcome
+  uint16_t job = wifiManager->startConnect(ssid, password);
+  
+  char buffer[JSON_BUFFER_SIZE];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.beginObject();
+  json.field("success", true);
+  json.field("job", job);
+  writeConnectJobFields(json);
+  json.endObject();
+  sendJson(202, json);
+}
+
+void MyWebServer::handleConnectStatus() {
+  LOG_D(WebServer, "[WebServer] GET /api/connect-wifi\n");
+  
+  // Only the latest attempt is kept; an older job ID has been superseded
+  unsigned long job = 0;
+  if (!parseUintArg("job", &job, UINT16_MAX)) return;
+  if (server->hasArg("job") && job != wifiManager->getConnectJob().id) {
+    sendJsonField(404, "error", "Unknown or superseded job");
+    return;
+  }
+  
+  char buffer[JSON_BUFFER_SIZE];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.beginObject();
+  json.field("job", wifiManager->getConnectJob().id);
+  writeConnectJobFields(json);
+  json.endObject();
+  sendJson(200, json);
+}
+
+void MyWebServer::writeConnectJobFields(JsonWriter& json) {
+  const WifiConnectJob& job = wifiManager->getConnectJob();
+  json.field("state", WifiManager::stateName(job.state));
+  json.field("ssid", job.ssid);
+  json.field("elapsedMs", job.state == WIFI_JOB_CONNECTING ? millis() - job.startedAt : job.duration);
+  if (job.state == WIFI_JOB_CONNECTED) {
+    json.field("ip", wifiManager->getLocalIP());
+    json.field("hostname", MDNS_HOSTNAME ".local");
+  } else if (job.state == WIFI_JOB_FAILED) {
+    json.field("error", WifiManager::failureText(job.reason));
+  }
+}
+
+void MyWebServer::handleMetrics() {
+  LOG_D(WebServer, "[WebServer] GET /metrics\n");
+
+  // Streamed in fixed-size chunks straight from the counters
+  server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server->send(200, "text/plain; version=0.0.4", "");
+  metrics.writePrometheus([](const char* data, size_t length, void* context) {
+    static_cast<WebServer*>(context)->sendContent(data, length);
+  }, server);
+  server->sendContent("");
+}
+
+void MyWebServer::handleLogs() {
+  LOG_D(WebServer, "[WebServer] GET /logs\n");
+  
+  // Without an upgrade request, return the log history as plain text
+  if (!server->header("Upgrade").equalsIgnoreCase("websocket")) {
+    server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server->send(200, "text/plain", "");
+    char chunk[LogStream::FRAME_PAYLOAD];
+    uint32_t offset = logger.historyStart();
+    uint32_t end = logger.historyEnd();
+    while (offset < end) {
+      size_t length = logger.readHistory(offset, chunk, sizeof(chunk));
+      if (length == 0) break;
+      server->sendContent(chunk, length);
+      offset += length;
+    }
+    server->sendContent("");
+    return;
+  }
+  
+  String key = server->header("Sec-WebSocket-Key");
+  if (key.length() == 0) {
+    sendJsonField(400, "error", "Missing Sec-WebSocket-Key");
+    return;
+  }
+  if (!logStream.hasFreeSlot()) {
+    sendJsonField(503, "error", "Too many log clients");
+    return;
+  }
+  
+  // The stream keeps its own copy of the connection after this request ends
+  if (!logStream.accept(server->client(), key)) {
+    LOG_W(WebServer, "[WebServer] WARNING: /logs handshake failed\n");
+  }
+}
+
+void MyWebServer::handleNotFound() {
+  LOG_D(WebServer, "[WebServer] 404 - Not Found\n");
+  server->send(404, "text/plain", "Not Found");
+}
+
+void MyWebServer::sendJson(int code, JsonWriter& json) {
+  if (json.overflowed()) {
+    LOG_E(WebServer, "[WebServer] ERROR: JSON response exceeds %u bytes\n", (unsigned)JSON_BUFFER_SIZE);
+    sendJson(500, "{\"error\":\"Response too large\"}");
+    return;
+  }
+  server->send_P(code, "application/json", json.c_str(), json.length());
+}
+
+void MyWebServer::sendJson(int code, const char* json) {
+  server->send_P(code, "application/json", json);
+}
+
+void MyWebServer::sendJsonField(int code, const char* key, const char* value) {
+  char buffer[JSON_BUFFER_SIZE];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.beginObject();
+  json.field(key, value);
+  json.endObject();
+  sendJson(code, json);
+}
+
+bool MyWebServer::parseBody(JsonField* fields, uint8_t fieldCount, const char* errorKey) {
+  if (!server->hasArg("plain")) {
+    sendJsonField(400, errorKey, "No data");
+    return false;
+  }
+  
+  // Parsed in place; string values are decoded into the handler's buffers
+  const String& body = server->arg("plain");
+  JsonParser parser;
+  if (!parser.parse(body.c_str(), body.length(), fields, fieldCount)) {
+    LOG_W(WebServer, "[WebServer] WARNING: Rejected request body: %s\n", parser.error());
+    sendJsonField(400, errorKey, parser.error());
+    return false;
+  }
+  return true;
+}
+
+bool MyWebServer::parseUintArg(const char* name, unsigned long* value, unsigned long max) {
+  if (!server->hasArg(name)) return true;
+  
+  const String& text = server->arg(name);
+  uint64_t parsed = 0;
+  bool valid = text.length() > 0 && text.length() <= 10;
+  for (unsigned int i = 0; valid && i < text.length(); i++) {
+    char c = text[i];
+    valid = c >= '0' && c <= '9';
+    parsed = parsed * 10 + (c - '0');
+  }
+  if (!valid || parsed > max) {
+    char message[48];
+    snprintf(message, sizeof(message), "Invalid query parameter '%s'", name);
+    sendJsonField(400, "error", message);
+    return false;
+  }
+  *value = parsed;
+  return true;
+}
+
+void MyWebServer::beginJsonStream(int code) {
+  server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server->send(code, "application/json", "");
+}
+
+void MyWebServer::streamJson(const char* data, size_t length, void* context) {
+  static_cast<WebServer*>(context)->sendContent(data, length);
+}
+
+void MyWebServer::endJsonStream(JsonWriter& json) {
+  json.flush();
+  server->sendContent("");
+}
+
+void MyWebServer::handleGetWebhook() {
+  LOG_D(WebServer, "[WebServer] GET /api/webhook\n");
+
+  // Streamed: up to WEBHOOK_MAX_THRESHOLDS message templates
+  char buffer[JSON_CHUNK_SIZE];
+  JsonWriter json(buffer, sizeof(buffer), streamJson, server);
+  beginJsonStream(200);
+  writeWebhookJSON(json);
+  endJsonStream(json);
+}
+
+void MyWebServer::writeWebhookJSON(JsonWriter& json) {
+  json.beginObject();
+  json.field("url", webhookManager->getWebhookURL());
+  json.field("enabled", webhookManager->isEnabled());
+  json.field("configured", webhookManager->isConfigured());
+  json.key("thresholds");
+  json.beginArray();
+  for (uint8_t i = 0; i < webhookManager->getThresholdCount(); i++) {
+    const WebhookThreshold& threshold = webhookManager->getThreshold(i);
+    json.beginObject();
+    // Whole percent, the form POST /api/webhook takes back
+    json.field("rise", threshold.rise / RISE_SCALE);
+    json.field("falling", threshold.falling);
+    json.field("message", threshold.message);
+    json.field("reached", webhookManager->isThresholdReached(i));
+    json.endObject();
+  }
+  json.endArray();
+  json.field("maxThresholds", WEBHOOK_MAX_THRESHOLDS);
+  json.key("targets");
+  writeTargetsJSON(json);
+  json.field("maxTargets", NOTIFIER_MAX_TARGETS);
+  json.key("outbox");
+  writeOutboxJSON(json);
+  json.field("headsUp", webhookManager->isHeadsUpEnabled());
+  json.field("headsUpMinutes", webhookManager->getHeadsUpLeadMinutes());
+  json.field("confirmAt", webhookManager->getConfirmationTime());
+  json.field("digestWindow", webhookManager->getDigestWindow());
+  json.endObject();
+}
+
+// Notification targets with their delivery stats. Tokens are secrets, so
+// only whether one is set is reported.
+void MyWebServer::writeTargetsJSON(JsonWriter& json) {
+  Notifier& notifier = webhookManager->getNotifier();
+  json.beginArray();
+  for (uint8_t i = 0; i < notifier.getTargetCount(); i++) {
+    const NotifierTarget& target = notifier.getTarget(i);
+    const NotifierStats& stats = notifier.getStats(i);
+    uint32_t attempts = stats.sent + stats.failed;
+    json.beginObject();
+    json.field("name", target.name);
+    json.field("format", Notifier::formatName(target.format));
+    json.field("url", target.url);
+    json.field("enabled", target.enabled);
+    json.field("hasToken", target.token[0] != '\0');
+    json.field("template", target.bodyTemplate);
+    json.key("stats");
+    json.beginObject();
+    json.field("sent", (unsigned long)stats.sent);
+    json.field("failed", (unsigned long)stats.failed);
+    json.field("lastStatus", (int)stats.lastStatus);
+    json.field("lastMs", (unsigned long)stats.lastMs);
+    json.field("avgMs", (unsigned long)(attempts ? stats.totalMs / attempts : 0));
+    json.field("maxMs", (unsigned long)stats.maxMs);
+    json.field("lastAt", stats.lastTime);
+    json.endObject();
+    json.endObject();
+  }
+  json.endArray();
+}
+
+// Notifications still waiting for delivery, oldest first
+void MyWebServer::writeOutboxJSON(JsonWriter& json) {
+  Notifier& notifier = webhookManager->getNotifier();
+  NotificationOutbox& outbox = webhookManager->getOutbox();
+  json.beginArray();
+  for (uint8_t i = 0; i < outbox.getCount(); i++) {
+    const OutboxEntry& entry = outbox.getEntry(i);
+    json.beginObject();
+    json.field("event", entry.kind == OUTBOX_HEADS_UP ? "headsUp" : "threshold");
+    json.fieldFixed("threshold", entry.threshold, RISE_DECIMALS);
+    json.field("falling", entry.falling);
+    json.field("message", entry.message);
+    json.key("created");
+    if (entry.created > 0) {
+      json.value((unsigned long)entry.created);
+    } else {
+      json.valueNull();  // Queued before the clock was set
+    }
+    json.field("attempts", entry.attempts);
+    json.key("pending");
+    json.beginArray();
+    for (uint8_t t = 0; t < notifier.getTargetCount(); t++) {
+      if (entry.pending & (1 << t)) json.value(notifier.getTarget(t).name);
+    }
+    json.endArray();
+    json.endObject();
+  }
+  json.endArray();
+}
+
+// Elements of the "targets" array in POST /api/webhook
+struct TargetListBody {
+  char name[NOTIFIER_NAME_SIZE];
+  char format[16];
+  char url[NOTIFIER_URL_SIZE];
+  char token[NOTIFIER_TOKEN_SIZE];
+  char bodyTemplate[NOTIFIER_TEMPLATE_SIZE];
+  bool enabled;
+  JsonField* fields;  // Element fields, for which optional members were given
+  Notifier* notifier;
+  NotifierTarget list[NOTIFIER_MAX_TARGETS];
+  uint8_t count;
+};
+
+static bool isHttpURL(const char* url) {
+  return strncmp(url, "http://", 7) == 0 || strncmp(url, "https://", 8) == 0;
+}
+
+static bool collectTarget(uint16_t index, void* context) {
+  TargetListBody* body = static_cast<TargetListBody*>(context);
+  NotifierTarget& target = body->list[index];
+  memset(&target, 0, sizeof(target));
+  if (!Notifier::parseFormat(body->format, &target.format) || !isHttpURL(body->url)) return false;
+
+  memcpy(target.name, body->name, sizeof(target.name));
+  memcpy(target.url, body->url, sizeof(target.url));
+  memcpy(target.bodyTemplate, body->bodyTemplate, sizeof(target.bodyTemplate));
+  target.enabled = body->fields[5].present ? body->enabled : true;
+  if (body->fields[3].present) {
+    memcpy(target.token, body->token, sizeof(target.token));
+  } else {
+    // Not sent back by GET: keep the token of the target with this name
+    for (uint8_t i = 0; i < body->notifier->getTargetCount(); i++) {
+      const NotifierTarget& existing = body->notifier->getTarget(i);
+      if (strcmp(existing.name, target.name) == 0) {
+        memcpy(target.token, existing.token, sizeof(target.token));
+        break;
+      }
+    }
+  }
+  body->bodyTemplate[0] = '\0';  // Optional member: default for the next element
+  body->count = index + 1;
+  return true;
+}
+
+// Elements of the "thresholds" array in POST /api/webhook, parsed one at a
+// time into the element fields and collected here
+struct ThresholdListBody {
+  long rise;
+  bool falling;
+  char message[WEBHOOK_MESSAGE_SIZE];
+  WebhookThreshold list[WEBHOOK_MAX_THRESHOLDS];
+  uint8_t count;
+};
+
+static bool collectThreshold(uint16_t index, void* context) {
+  ThresholdListBody* body = static_cast<ThresholdListBody*>(context);
+  WebhookThreshold& threshold = body->list[index];
+  threshold.rise = body->rise * RISE_SCALE;
+  threshold.falling = body->falling;
+  memcpy(threshold.message, body->message, sizeof(threshold.message));
+  body->count = index + 1;
+  body->falling = false;  // Optional member: default for the next element
+  return true;
+}
+
+void MyWebServer::handleSetWebhook() {
+  LOG_D(WebServer, "[WebServer] POST /api/webhook\n");
+
+  // All members are optional; only those present are changed
+  char url[256];
+  bool enabled = false;
+  bool headsUp = false;
+  long headsUpMinutes = 0;
+  long digestWindow = 0;
+  // Static rather than on the stack: full lists are a few KB
+  static ThresholdListBody thresholdBody;
+  thresholdBody.falling = false;
+  thresholdBody.count = 0;
+  JsonField thresholdFields[] = {
+    JsonParser::intField("rise", &thresholdBody.rise, -100, 10000),
+    JsonParser::boolField("falling", &thresholdBody.falling, false),
+    JsonParser::stringField("message", thresholdBody.message, sizeof(thresholdBody.message), 1),
+  };
+  static TargetListBody targetBody;
+  targetBody.bodyTemplate[0] = '\0';
+  targetBody.count = 0;
+  targetBody.notifier = &webhookManager->getNotifier();
+  JsonField targetFields[] = {
+    JsonParser::stringField("name", targetBody.name, sizeof(targetBody.name), 1),
+    JsonParser::stringField("format", targetBody.format, sizeof(targetBody.format), 1),
+    JsonParser::stringField("url", targetBody.url, sizeof(targetBody.url), 8),
+    JsonParser::stringField("token", targetBody.token, sizeof(targetBody.token), 0, false),
+    JsonParser::stringField("template", targetBody.bodyTemplate, sizeof(targetBody.bodyTemplate), 0, false),
+    JsonParser::boolField("enabled", &targetBody.enabled, false),
+  };
+  targetBody.fields = targetFields;
+  JsonField fields[] = {
+    JsonParser::stringField("url", url, sizeof(url), 0, false),
+    JsonParser::boolField("enabled", &enabled, false),
+    JsonParser::boolField("headsUp", &headsUp, false),
+    JsonParser::intField("headsUpMinutes", &headsUpMinutes, 1, HEADS_UP_MAX_LEAD_MINUTES, false),
+    JsonParser::arrayField("thresholds", thresholdFields, 3, WEBHOOK_MAX_THRESHOLDS,
+                           collectThreshold, &thresholdBody, false),
+    JsonParser::arrayField("targets", targetFields, 6, NOTIFIER_MAX_TARGETS,
+                           collectTarget, &targetBody, false),
+    JsonParser::intField("digestWindow", &digestWindow, 0, DIGEST_MAX_WINDOW_SECONDS, false),
+  };
+  if (!parseBody(fields, 7, "error")) return;
+
+  if (fields[0].present && url[0] != '\0' && !isHttpURL(url)) {
+    sendJson(400, "{\"error\":\"url must start with http:// or https://\"}");
+    return;
+  }
+
+  if (fields[6].present) {
+    webhookManager->setDigestWindow(digestWindow);
+  }
+  if (fields[5].present) {
+    webhookManager->setTargets(targetBody.list, targetBody.count);
+  }
+  if (fields[0].present) {
+    webhookManager->setWebhookURL(url);
+  }
+  if (fields[1].present) {
+    webhookManager->setEnabled(enabled);
+  }
+  if (fields[2].present || fields[3].present) {
+    webhookManager->setHeadsUp(fields[2].present ? headsUp : webhookManager->isHeadsUpEnabled(),
+                               fields[3].present ? headsUpMinutes : webhookManager->getHeadsUpLeadMinutes());
+  }
+  if (fields[4].present) {
+    webhookManager->setThresholds(thresholdBody.list, thresholdBody.count);
+  }
+
+  char buffer[JSON_BUFFER_SIZE];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.beginObject();
+  json.field("success", true);
+  json.field("url", webhookManager->getWebhookURL());
+  json.field("enabled", webhookManager->isEnabled());
+  json.field("headsUp", webhookManager->isHeadsUpEnabled());
+  json.field("headsUpMinutes", webhookManager->getHeadsUpLeadMinutes());
+  json.field("digestWindow", webhookManager->getDigestWindow());
+  json.field("thresholdCount", webhookManager->getThresholdCount());
+  json.field("targetCount", webhookManager->getNotifier().getTargetCount());
+  json.endObject();
+
+  sendJson(200, json);
+}
+
+void MyWebServer::handleTestWebhook() {
+  LOG_D(WebServer, "[WebServer] POST /api/test-webhook\n");
+
+  if (!webhookManager->isConfigured()) {
+    sendJson(400, "{\"success\":false,\"error\":\"Webhook not configured\"}");
+    return;
+  }
+
+  // Send a test notification to every target
+  uint8_t accepted = webhookManager->sendTestNotification();
+
+  char buffer[JSON_CHUNK_SIZE];
+  JsonWriter json(buffer, sizeof(buffer), streamJson, server);
+  beginJsonStream(accepted > 0 ? 200 : 500);
+  json.beginObject();
+  json.field("success", accepted > 0);
+  json.field("accepted", accepted);
+  if (accepted == 0) json.field("error", "Failed to send test notification");
+  json.key("targets");
+  writeTargetsJSON(json);
+  json.endObject();
+  endJsonStream(json);
+}
+
+void MyWebServer::handleGetPresets() {
+  LOG_D(WebServer, "[WebServer] GET /api/presets\n");
+
+  char buffer[JSON_BUFFER_SIZE];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.beginObject();
+  json.key("presets");
+  writePresetsJSON(json);
+  json.endObject();
+
+  sendJson(200, json);
+}
+
+void MyWebServer::writePresetsJSON(JsonWriter& json) {
+  char name[12];
+  uint16_t zp;
+
+  json.beginArray();
+  for (uint8_t i = 0; i < calibManager->getPresetCount(); i++) {
+    calibManager->getPreset(i, name, &zp);
+    json.beginObject();
+    json.field("n", name);
+    json.field("z", zp);
+    json.endObject();
+  }
+  json.endArray();
+}
+
+void MyWebServer::handleSavePreset() {
+  LOG_D(WebServer, "[WebServer] POST /api/presets\n");
+
+  char name[12];  // Matches ContainerPreset::name
+  JsonField fields[] = {
+    JsonParser::stringField("n", name, sizeof(name), 1),
+  };
+  if (!parseBody(fields, 1, "e")) return;
+
+  if (calibManager->savePreset(name)) {
+    sendJson(200, "{\"ok\":1}");
+  } else {
+    sendJson(400, "{\"e\":\"Save failed\"}");
+  }
+}
+
+void MyWebServer::handlePresetAction() {
+  LOG_D(WebServer, "[WebServer] DELETE /api/presets\n");
+
+  // {"i":<index>,"a":"l"} loads a preset, "d" deletes it
+  long idx = 0;
+  char action[2];
+  JsonField fields[] = {
+    JsonParser::intField("i", &idx, 0, MAX_PRESETS - 1),
+    JsonParser::stringField("a", action, sizeof(action), 1),
+  };
+  if (!parseBody(fields, 2, "e")) return;
+
+  bool success = false;
+  if (action[0] == 'l') {
+    success = calibManager->loadPreset(idx);
+  } else if (action[0] == 'd') {
+    success = calibManager->deletePreset(idx);
+  } else {
+    sendJson(400, "{\"e\":\"Unknown action\"}");
+    return;
+  }
+
+  if (success) {
+    sendJson(200, "{\"ok\":1}");
+  } else {
+    sendJson(400, "{\"e\":\"Action failed\"}");
+  }
+}
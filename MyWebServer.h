@@ -1,59 +1,100 @@
-#ifndef MY_WEB_SERVER_H
-#define MY_WEB_SERVER_H
-
-#include <Arduino.h>
-#include <WebServer.h>
-
-class SensorManager;
-class CalibrationManager;
-class DataManager;
-class WifiManager;
-class WebhookManager;
-
-class MyWebServer {
-public:
-  MyWebServer(SensorManager* sensor, CalibrationManager* calib, DataManager* data, WifiManager* wifi, WebhookManager* webhook);
-  ~MyWebServer();
-  
-  // Initialize web server
-  void begin();
-  
-  // Handle client connections
-  void handleClient();
-  
-  // Stop server
-  void stop();
-  
-private:
-  WebServer* server;
-  SensorManager* sensorManager;
-  CalibrationManager* calibManager;
-  DataManager* dataManager;
-  WifiManager* wifiManager;
-  WebhookManager* webhookManager;
-  
-  // Request handlers
-  void handleRoot();
-  void handleData();
-  void handleStatus();
-  void handleCalibrate();
-  void handleCalibrateDough();
-  void handleMeasure();
-  void handleOffset();
-  void handleResetData();
-  void handleResetWifi();
-  void handleScanNetworks();
-  void handleConnectWiFi();
-  void handleGetWebhook();
-  void handleSetWebhook();
-  void handleTestWebhook();
-  void handleGetPresets();
-  void handleSavePreset();
-  void handlePresetAction();
-  void handleNotFound();
-  
-  // Helper methods
-  String jsonResponse(const char* key, const char* value);
-};
-
-#endif
+#ifndef MY_WEB_SERVER_H
+#define MY_WEB_SERVER_H
+
+#include <Arduino.h>
+#include <WebServer.h>
+#include "JsonWriter.h"
+#include "JsonParser.h"
+
+class SensorManager;
+class CalibrationManager;
+class DataManager;
+class WifiManager;
+class WebhookManager;
+
+class MyWebServer {
+public:
+  MyWebServer(SensorManager* sensor, CalibrationManager* calib, DataManager* data, WifiManager* wifi, WebhookManager* webhook);
+  ~MyWebServer();
+  
+  // Initialize web server
+  void begin();
+  
+  // Handle client connections
+  void handleClient();
+  
+  // Stop server
+  void stop();
+  
+private:
+  WebServer* server;
+  SensorManager* sensorManager;
+  CalibrationManager* calibManager;
+  DataManager* dataManager;
+  WifiManager* wifiManager;
+  WebhookManager* webhookManager;
+  
+  // Request handlers
+  void handleRoot();
+  void handleData();
+  void handleStatus();
+  void handleBootstrap();
+  void handleCalibrate();
+  void handleCalibrateDough();
+  void handleMeasure();
+  void handleOffset();
+  void handleResetData();
+  void handleResetWifi();
+  void handleScanNetworks();
+  void handleConnectWiFi();
+  void handleConnectStatus();
+  void handleGetWebhook();
+  void handleSetWebhook();
+  void handleTestWebhook();
+  void handleGetPresets();
+  void handleSavePreset();
+  void handlePresetAction();
+  void handleMetrics();
+  void handleLogs();
+  void handleNotFound();
+  
+  // Response bodies shared between the individual endpoints and /api/bootstrap
+  void writeStatusJSON(JsonWriter& json);
+  void writeWebhookJSON(JsonWriter& json);
+  void writeTargetsJSON(JsonWriter& json);
+  void writeOutboxJSON(JsonWriter& json);
+  void writeConnectJobFields(JsonWriter& json);
+  void writePresetsJSON(JsonWriter& json);
+  void writeForecastJSON(JsonWriter& json);
+  void writeForecastTimes(JsonWriter& json, bool valid, unsigned long at,
+                          unsigned long earliest, unsigned long latest);
+  
+  // Buffer for single-object responses; larger documents are streamed
+  static const size_t JSON_BUFFER_SIZE = 768;
+  static const size_t JSON_CHUNK_SIZE = 512;
+  
+  // Send a finished JSON document (a writer over a fixed buffer, or a literal)
+  void sendJson(int code, JsonWriter& json);
+  void sendJson(int code, const char* json);
+  
+  // Send {"<key>":"<value>"} with the value escaped
+  void sendJsonField(int code, const char* key, const char* value);
+  
+  // Parse the request body against a schema; on failure a 400 with
+  // {"<errorKey>":"<reason>"} has already been sent
+  bool parseBody(JsonField* fields, uint8_t fieldCount, const char* errorKey);
+  
+  // Read an optional non-negative integer query parameter; if it is present
+  // but malformed or above max, a 400 has already been sent
+  bool parseUintArg(const char* name, unsigned long* value, unsigned long max);
+  
+  // Start a chunked JSON response; pass streamJson and the server to JsonWriter
+  void beginJsonStream(int code);
+  static void streamJson(const char* data, size_t length, void* context);
+  void endJsonStream(JsonWriter& json);
+  
+  // Register a route whose handler is counted and timed in /metrics
+  void addRoute(const char* uri, HTTPMethod method, void (MyWebServer::*handler)());
+};
+
+#endif
@@ -0,0 +1,221 @@
+#include "NotificationOutbox.h"
+#include "Log.h"
+#include <time.h>
+
+void NotificationOutbox::begin(Notifier* n) {
+  notifier = n;
+  if (count > 0) {
+    LOG_I(Webhook, "[Outbox] %d undelivered notifications queued\n", count);
+  }
+}
+
+void NotificationOutbox::setDigest(uint16_t windowSeconds, DigestFunction digest, void* context) {
+  digestWindow = windowSeconds;
+  digestFunction = digest;
+  digestContext = context;
+}
+
+bool NotificationOutbox::enqueue(const OutboxEntry& entry) {
+  uint8_t active = notifier ? notifier->getActiveTargets() : 0;
+  if (active == 0) return false;
+
+  for (uint8_t i = 0; i < count; i++) {
+    const OutboxEntry& queued = entries[i];
+    if (queued.session == entry.session && queued.kind == entry.kind &&
+        queued.threshold == entry.threshold && queued.falling == entry.falling) {
+      LOG_D(Webhook, "[Outbox] Already queued: %s\n", entry.message);
+      return false;
+    }
+  }
+
+  if (count == OUTBOX_CAPACITY) {
+    LOG_W(Webhook, "[Outbox] Full, dropping undelivered: %s\n", entries[0].message);
+    remove(0);
+  }
+
+  OutboxEntry& queued = entries[count++];
+  queued = entry;
+  queued.message[sizeof(queued.message) - 1] = '\0';
+  queued.pending = active;
+  queued.attempts = 0;
+  if (queued.created < CLOCK_VALID_SECONDS) {
+    // No NTP time yet (e.g. booted during an internet outage): dated once
+    // the clock is set, see dropExpired()
+    queued.created = 0;
+    queued.expires = 0;
+  } else if (queued.expires == 0) {
+    queued.expires = queued.created + OUTBOX_MAX_AGE_SECONDS;
+  }
+  dirty = true;
+  return true;
+}
+
+void NotificationOutbox::service(bool connected) {
+  if (connected && !wasConnected) {
+    // Back online: deliver the backlog now rather than after the backoff
+    memset(backoffMs, 0, sizeof(backoffMs));
+    memset(nextAttempt, 0, sizeof(nextAttempt));
+  }
+  wasConnected = connected;
+
+  dropExpired();
+  if (!connected || count == 0 || !notifier) return;
+
+  // Send the oldest entry that has a ready target with nothing older
+  // outstanding; targets still backing off block their own entries only
+  unsigned long now = time(nullptr);
+  bool clockSet = now >= CLOCK_VALID_SECONDS;
+  uint8_t active = notifier->getActiveTargets();
+  uint8_t blocked = ~readyTargets();
+  for (uint8_t i = 0; i < count; i++) {
+    OutboxEntry& entry = entries[i];
+    entry.pending &= active;  // Disabled or removed targets are skipped
+    uint8_t sendable = entry.pending & ~blocked;
+    if (sendable == 0) {
+      blocked |= entry.pending;
+      continue;
+    }
+    // Still collecting; everything newer is younger still
+    if (clockSet && digestWindow > 0 && now < entry.created + digestWindow) break;
+
+    // Newer entries still due at exactly these targets join the digest. One
+    // due at only some of them ends it, or those would get it out of order.
+    OutboxEntry* batch[OUTBOX_CAPACITY];
+    uint8_t batchCount = 0;
+    batch[batchCount++] = &entry;
+    if (digestFunction) {
+      for (uint8_t j = i + 1; j < count; j++) {
+        uint8_t overlap = entries[j].pending & active & sendable;
+        if (overlap == 0) continue;
+        if (overlap != sendable) break;
+        batch[batchCount++] = &entries[j];
+      }
+    }
+
+    uint8_t accepted;
+    if (batchCount == 1) {
+      Notification notification = {entry.kind == OUTBOX_HEADS_UP ? "headsUp" : "threshold",
+                                   entry.message, entry.rise, entry.threshold, true};
+      accepted = notifier->deliver(notification, sendable);
+    } else {
+      String message;
+      digestFunction(batch, batchCount, message, digestContext);
+      const OutboxEntry& latest = *batch[batchCount - 1];
+      Notification notification = {"digest", message.c_str(), latest.rise, 0, false};
+      LOG_I(Webhook, "[Outbox] Sending %d notifications as one digest\n", batchCount);
+      accepted = notifier->deliver(notification, sendable);
+    }
+    for (uint8_t b = 0; b < batchCount; b++) {
+      batch[b]->pending &= ~accepted;
+    }
+    if (accepted) dirty = true;
+
+    if (sendable & ~accepted) entry.attempts++;  // Not worth a flash write on its own
+    for (uint8_t t = 0; t < NOTIFIER_MAX_TARGETS; t++) {
+      uint8_t bit = 1 << t;
+      if (accepted & bit) {
+        backoffMs[t] = 0;
+      } else if (sendable & bit) {
+        backoffMs[t] = backoffMs[t] == 0 ? OUTBOX_RETRY_MIN_MS : backoffMs[t] * 2;
+        if (backoffMs[t] > OUTBOX_RETRY_MAX_MS) backoffMs[t] = OUTBOX_RETRY_MAX_MS;
+        nextAttempt[t] = millis() + backoffMs[t];
+        LOG_W(Webhook, "[Outbox] %s failed (attempt %d), retrying in %lu s: %s\n",
+                      notifier->getTarget(t).name, entry.attempts, backoffMs[t] / 1000, entry.message);
+      }
+    }
+    break;  // One round per call keeps loop() responsive
+  }
+
+  for (uint8_t i = count; i > 0; i--) {
+    if (entries[i - 1].pending == 0) {
+      remove(i - 1);
+      dirty = true;
+    }
+  }
+}
+
+uint8_t NotificationOutbox::readyTargets() {
+  uint8_t ready = 0;
+  unsigned long now = millis();
+  for (uint8_t t = 0; t < NOTIFIER_MAX_TARGETS; t++) {
+    if (backoffMs[t] == 0 || (long)(now - nextAttempt[t]) >= 0) ready |= 1 << t;
+  }
+  return ready;
+}
+
+void NotificationOutbox::dropExpired() {
+  unsigned long now = time(nullptr);
+  if (now < CLOCK_VALID_SECONDS) return;  // Clock not set yet
+
+  // Queued before the clock was set: their age counts from now
+  for (uint8_t i = 0; i < count; i++) {
+    if (entries[i].created == 0) {
+      entries[i].created = now;
+      entries[i].expires = now + OUTBOX_MAX_AGE_SECONDS;
+      dirty = true;
+    }
+  }
+
+  for (uint8_t i = count; i > 0; i--) {
+    if (now >= entries[i - 1].expires) {
+      LOG_W(Webhook, "[Outbox] Expired undelivered: %s\n", entries[i - 1].message);
+      remove(i - 1);
+      dirty = true;
+    }
+  }
+}
+
+void NotificationOutbox::retarget() {
+  uint8_t active = notifier ? notifier->getActiveTargets() : 0;
+  for (uint8_t i = 0; i < count; i++) {
+    if (entries[i].pending != 0) entries[i].pending = active;
+  }
+  memset(backoffMs, 0, sizeof(backoffMs));
+  dirty = dirty || count > 0;
+}
+
+void NotificationOutbox::clear() {
+  if (count == 0) return;
+  LOG_I(Webhook, "[Outbox] Dropping %d queued notifications\n", count);
+  count = 0;
+  dirty = true;
+}
+
+uint8_t NotificationOutbox::getCount() {
+  return count;
+}
+
+const OutboxEntry& NotificationOutbox::getEntry(uint8_t index) {
+  return entries[index < count ? index : 0];
+}
+
+bool NotificationOutbox::isDirty() {
+  return dirty;
+}
+
+void NotificationOutbox::remove(uint8_t index) {
+  memmove(&entries[index], &entries[index + 1], sizeof(OutboxEntry) * (count - index - 1));
+  count--;
+}
+
+void NotificationOutbox::load(Preferences& preferences) {
+  count = 0;
+  size_t length = preferences.getBytesLength("outbox");
+  if (length > 0 && length % sizeof(OutboxEntry) == 0 &&
+      length / sizeof(OutboxEntry) <= OUTBOX_CAPACITY) {
+    count = preferences.getBytes("outbox", entries, sizeof(entries)) / sizeof(OutboxEntry);
+    for (uint8_t i = 0; i < count; i++) {
+      entries[i].message[sizeof(entries[i].message) - 1] = '\0';
+    }
+  }
+  dirty = false;
+}
+
+void NotificationOutbox::save(Preferences& preferences) {
+  if (count > 0) {
+    preferences.putBytes("outbox", entries, sizeof(OutboxEntry) * count);
+  } else if (preferences.isKey("outbox")) {
+    preferences.remove("outbox");
+  }
+  dirty = false;
+}
@@ -0,0 +1,110 @@
+#ifndef NOTIFICATION_OUTBOX_H
+#define NOTIFICATION_OUTBOX_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "FixedPoint.h"
+#include "Notifier.h"
+#include "config.h"
+
+enum OutboxKind : uint8_t {
+  OUTBOX_THRESHOLD,
+  OUTBOX_HEADS_UP
+};
+
+// One queued notification, stored as is in NVS
+struct OutboxEntry {
+  uint16_t session;      // Fermentation it belongs to
+  OutboxKind kind;
+  bool falling;
+  uint8_t pending;       // Targets still to deliver to, a bit per target index
+  uint8_t attempts;      // Failed delivery rounds
+  RiseFixed threshold;
+  RiseFixed rise;        // At the crossing
+  uint32_t created;      // Unix seconds, 0 if queued before the clock was set
+  uint32_t expires;      // Unix seconds; dropped undelivered after this
+  char message[WEBHOOK_MESSAGE_SIZE + 32];
+};
+
+/*
+ * Durable queue of notifications on their way to the notification targets.
+ *
+ * A crossed threshold is queued instead of sent directly, so a notification
+ * that cannot be delivered (WiFi down, target returning errors) is retried
+ * later instead of lost. The queue is saved together with the threshold
+ * state (see WebhookManager), so it survives a reboot; queueing the same
+ * notification twice for a fermentation is a no-op.
+ *
+ * Notifications waiting for the same targets are merged into one digest
+ * message (built by the digest callback), so a burst of crossings or the
+ * backlog after an outage costs one request per target. With a coalescing
+ * window, a new notification is held for that long to collect company.
+ *
+ * Each target gets the notifications in the order they were queued: an entry
+ * is only sent to a target once every older entry has reached it. A target
+ * that fails backs off from OUTBOX_RETRY_MIN_MS to OUTBOX_RETRY_MAX_MS without
+ * holding up the others, and the backoff is skipped when WiFi comes back.
+ */
+class NotificationOutbox {
+public:
+  // time() below this means NTP has not set the clock yet
+  static const uint32_t CLOCK_VALID_SECONDS = 24 * 3600;
+
+  // Build one message for several entries (oldest first)
+  typedef void (*DigestFunction)(const OutboxEntry* const* entries, uint8_t count, String& message,
+                                 void* context);
+
+  void begin(Notifier* notifier);
+
+  // Merge notifications into digests; windowSeconds holds each one back
+  // that long for others to join (0: merge only what is already waiting)
+  void setDigest(uint16_t windowSeconds, DigestFunction digest, void* context);
+
+  // Queue a notification for every active target. Returns false if the same
+  // one (session, kind, threshold) is already queued, or there are no targets.
+  bool enqueue(const OutboxEntry& entry);
+
+  // One delivery round for the oldest entries, if one is due; call from
+  // loop() and right after queueing
+  void service(bool connected);
+
+  // Address everything still pending to the current targets, after the
+  // target list changed (target indexes are not stable across edits)
+  void retarget();
+
+  // Drop all queued notifications
+  void clear();
+
+  // Queued entries, oldest first
+  uint8_t getCount();
+  const OutboxEntry& getEntry(uint8_t index);
+
+  // Changed since the last save()
+  bool isDirty();
+
+  // Read/write the queue in an open Preferences namespace
+  void load(Preferences& preferences);
+  void save(Preferences& preferences);
+
+private:
+  Notifier* notifier = nullptr;
+  OutboxEntry entries[OUTBOX_CAPACITY];
+  uint8_t count = 0;
+  bool dirty = false;
+  bool wasConnected = false;
+  // Per target index
+  unsigned long nextAttempt[NOTIFIER_MAX_TARGETS] = {};  // millis()
+  unsigned long backoffMs[NOTIFIER_MAX_TARGETS] = {};
+
+  uint16_t digestWindow = 0;  // Seconds
+  DigestFunction digestFunction = nullptr;
+  void* digestContext = nullptr;
+
+  // Targets whose backoff has run out
+  uint8_t readyTargets();
+
+  void remove(uint8_t index);
+  void dropExpired();
+};
+
+#endif
@@ -0,0 +1,325 @@
+#include "Notifier.h"
+#include <HTTPClient.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include "JsonWriter.h"
+#include "Metrics.h"
+#include "Log.h"
+#include <time.h>
+
+static const char* DEFAULT_JSON_TEMPLATE =
+    "{\"event\":\"{event}\",\"message\":\"{message}\",\"rise\":{rise},"
+    "\"threshold\":{threshold},\"time\":{time}}";
+
+// Payloads are built in a String: digest messages can be long
+static void appendToString(const char* data, size_t length, void* context) {
+  static_cast<String*>(context)->concat(data, length);
+}
+
+// Escaped contents of a JSON string, without the quotes
+static void appendEscaped(String& out, const char* text) {
+  String quoted;
+  char chunk[64];
+  JsonWriter json(chunk, sizeof(chunk), appendToString, &quoted);
+  json.value(text);
+  json.flush();
+  out += quoted.substring(1, quoted.length() - 1);
+}
+
+static void formatDiscord(const NotifierTarget& target, const Notification& notification, String& payload) {
+  (void)target;
+  char chunk[64];
+  payload = "";
+  JsonWriter json(chunk, sizeof(chunk), appendToString, &payload);
+  json.beginObject();
+  json.field("content", notification.message);
+  json.endObject();
+  json.flush();
+}
+
+static void formatNtfy(const NotifierTarget& target, const Notification& notification, String& payload) {
+  (void)target;
+  payload = notification.message;
+}
+
+static void formatHomeAssistant(const NotifierTarget& target, const Notification& notification,
+                                String& payload) {
+  (void)target;
+  char chunk[64];
+  payload = "";
+  JsonWriter json(chunk, sizeof(chunk), appendToString, &payload);
+  json.beginObject();
+  json.field("title", "DoughTracker");
+  json.field("message", notification.message);
+  json.key("data");
+  json.beginObject();
+  json.field("event", notification.event);
+  json.fieldFixed("rise", notification.rise, RISE_DECIMALS);
+  json.key("threshold");
+  if (notification.hasThreshold) {
+    json.valueFixed(notification.threshold, RISE_DECIMALS);
+  } else {
+    json.valueNull();
+  }
+  json.endObject();
+  json.endObject();
+  json.flush();
+}
+
+// Fill the target's template. {message} and {event} are escaped for use
+// inside a JSON string; {rise}, {threshold} and {time} are bare numbers
+// ({threshold} is null when there is none).
+static void formatJsonTemplate(const NotifierTarget& target, const Notification& notification,
+                               String& payload) {
+  const char* p = target.bodyTemplate[0] ? target.bodyTemplate : DEFAULT_JSON_TEMPLATE;
+  char value[24];
+  payload = "";
+  while (*p) {
+    if (strncmp(p, "{message}", 9) == 0) {
+      appendEscaped(payload, notification.message);
+      p += 9;
+    } else if (strncmp(p, "{event}", 7) == 0) {
+      appendEscaped(payload, notification.event);
+      p += 7;
+    } else if (strncmp(p, "{rise}", 6) == 0) {
+      formatPercent(notification.rise, value, sizeof(value));
+      payload += value;
+      p += 6;
+    } else if (strncmp(p, "{threshold}", 11) == 0) {
+      if (notification.hasThreshold) {
+        formatPercent(notification.threshold, value, sizeof(value));
+        payload += value;
+      } else {
+        payload += "null";
+      }
+      p += 11;
+    } else if (strncmp(p, "{time}", 6) == 0) {
+      payload += (unsigned long)time(nullptr);
+      p += 6;
+    } else {
+      payload += *p++;
+    }
+  }
+}
+
+// Formatter registry, indexed by NotifierFormat
+struct Formatter {
+  const char* name;
+  const char* contentType;
+  void (*format)(const NotifierTarget& target, const Notification& notification, String& payload);
+};
+
+static const Formatter FORMATTERS[NOTIFIER_FORMAT_COUNT] = {
+  {"discord", "application/json", formatDiscord},
+  {"ntfy", "text/plain; charset=utf-8", formatNtfy},
+  {"json", "application/json", formatJsonTemplate},
+  {"homeassistant", "application/json", formatHomeAssistant},
+};
+
+const char* Notifier::formatName(NotifierFormat format) {
+  return format < NOTIFIER_FORMAT_COUNT ? FORMATTERS[format].name : "unknown";
+}
+
+bool Notifier::parseFormat(const char* name, NotifierFormat* format) {
+  for (uint8_t i = 0; i < NOTIFIER_FORMAT_COUNT; i++) {
+    if (strcmp(name, FORMATTERS[i].name) == 0) {
+      *format = (NotifierFormat)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+void Notifier::begin() {
+  preferences.begin("notify", true); // Read-only
+  size_t length = preferences.getBytesLength("targets");
+  if (length > 0 && length % sizeof(NotifierTarget) == 0 &&
+      length / sizeof(NotifierTarget) <= NOTIFIER_MAX_TARGETS) {
+    targetCount = preferences.getBytes("targets", targets, sizeof(targets)) / sizeof(NotifierTarget);
+  }
+  preferences.end();
+
+  memset(stats, 0, sizeof(stats));
+  for (uint8_t i = 0; i < targetCount; i++) {
+    NotifierTarget& target = targets[i];
+    target.name[NOTIFIER_NAME_SIZE - 1] = '\0';
+    target.url[NOTIFIER_URL_SIZE - 1] = '\0';
+    target.token[NOTIFIER_TOKEN_SIZE - 1] = '\0';
+    target.bodyTemplate[NOTIFIER_TEMPLATE_SIZE - 1] = '\0';
+    if (target.format >= NOTIFIER_FORMAT_COUNT) target.format = NOTIFIER_DISCORD;
+    LOG_I(Webhook, "[Notifier] Target %s (%s) %s: %s\n", target.name, formatName(target.format),
+                  target.enabled ? "enabled" : "disabled", target.url);
+  }
+}
+
+uint8_t Notifier::getTargetCount() {
+  return targetCount;
+}
+
+const NotifierTarget& Notifier::getTarget(uint8_t index) {
+  return targets[index < targetCount ? index : 0];
+}
+
+const NotifierStats& Notifier::getStats(uint8_t index) {
+  return stats[index < targetCount ? index : 0];
+}
+
+bool Notifier::hasTargets() {
+  return getActiveTargets() != 0;
+}
+
+uint8_t Notifier::getActiveTargets() {
+  uint8_t mask = 0;
+  for (uint8_t i = 0; i < targetCount; i++) {
+    if (targets[i].enabled && targets[i].url[0] != '\0') mask |= 1 << i;
+  }
+  return mask;
+}
+
+bool Notifier::setTargets(const NotifierTarget* list, uint8_t count) {
+  if (count > NOTIFIER_MAX_TARGETS) return false;
+
+  NotifierStats previousStats[NOTIFIER_MAX_TARGETS];
+  char previousNames[NOTIFIER_MAX_TARGETS][NOTIFIER_NAME_SIZE];
+  uint8_t previousCount = targetCount;
+  memcpy(previousStats, stats, sizeof(stats));
+  for (uint8_t i = 0; i < previousCount; i++) {
+    memcpy(previousNames[i], targets[i].name, NOTIFIER_NAME_SIZE);
+  }
+
+  memset(stats, 0, sizeof(stats));
+  for (uint8_t i = 0; i < count; i++) {
+    targets[i] = list[i];
+    for (uint8_t j = 0; j < previousCount; j++) {
+      if (strcmp(previousNames[j], targets[i].name) == 0) {
+        stats[i] = previousStats[j];
+        break;
+      }
+    }
+  }
+  targetCount = count;
+
+  saveToNVS();
+  LOG_I(Webhook, "[Notifier] %d targets saved\n", targetCount);
+  return true;
+}
+
+void Notifier::prepare(const NotifierTarget& target, const Notification& notification, Delivery& delivery) {
+  const Formatter& formatter = FORMATTERS[target.format];
+  delivery.url = target.url;
+  delivery.contentType = formatter.contentType;
+  delivery.ntfyHeaders = target.format == NOTIFIER_NTFY;
+  delivery.authorization = "";
+  if (target.token[0] != '\0') {
+    delivery.authorization = String("Bearer ") + target.token;
+  }
+  formatter.format(target, notification, delivery.payload);
+  delivery.httpCode = 0;
+  delivery.durationUs = 0;
+}
+
+void Notifier::send(Delivery& delivery) {
+  HTTPClient http;
+  http.begin(delivery.url);
+  http.addHeader("Content-Type", delivery.contentType);
+  if (delivery.authorization.length() > 0) {
+    http.addHeader("Authorization", delivery.authorization);
+  }
+  if (delivery.ntfyHeaders) {
+    http.addHeader("Title", "DoughTracker");
+    http.addHeader("Tags", "bread");
+  }
+  http.setTimeout(NOTIFIER_TIMEOUT_MS);
+
+  unsigned long sendStart = micros();
+  delivery.httpCode = http.POST(delivery.payload);
+  delivery.durationUs = micros() - sendStart;
+  http.end();
+}
+
+void Notifier::deliveryTask(void* parameter) {
+  Delivery* delivery = static_cast<Delivery*>(parameter);
+  send(*delivery);
+  xSemaphoreGive((SemaphoreHandle_t)delivery->done);
+  vTaskDelete(nullptr);
+}
+
+uint8_t Notifier::deliver(const Notification& notification, uint8_t targetMask) {
+  uint8_t active[NOTIFIER_MAX_TARGETS];
+  uint8_t activeCount = 0;
+  uint8_t activeMask = getActiveTargets() & targetMask;
+  for (uint8_t i = 0; i < targetCount; i++) {
+    if (activeMask & (1 << i)) active[activeCount++] = i;
+  }
+  if (activeCount == 0) return 0;
+
+  for (uint8_t n = 0; n < activeCount; n++) {
+    prepare(targets[active[n]], notification, deliveries[n]);
+  }
+
+  if (activeCount == 1) {
+    // Nothing to overlap with: skip the task and its stack
+    send(deliveries[0]);
+  } else {
+    SemaphoreHandle_t done = xSemaphoreCreateCounting(activeCount, 0);
+    uint8_t started = 0;
+    for (uint8_t n = 0; n < activeCount; n++) {
+      deliveries[n].done = done;
+      if (done && xTaskCreate(deliveryTask, "notify", NOTIFIER_TASK_STACK, &deliveries[n], 1, nullptr) == pdPASS) {
+        started++;
+      } else {
+        send(deliveries[n]);  // Out of memory for a task: send it from here
+      }
+    }
+    // HTTPClient enforces the timeout, so every task finishes
+    for (uint8_t n = 0; n < started; n++) {
+      xSemaphoreTake(done, portMAX_DELAY);
+    }
+    if (done) vSemaphoreDelete(done);
+  }
+
+  uint8_t accepted = 0;
+  unsigned long now = time(nullptr);
+  for (uint8_t n = 0; n < activeCount; n++) {
+    const Delivery& delivery = deliveries[n];
+    const NotifierTarget& target = targets[active[n]];
+    NotifierStats& s = stats[active[n]];
+    bool success = delivery.httpCode >= 200 && delivery.httpCode < 300;
+    uint32_t ms = delivery.durationUs / 1000;
+
+    if (success) {
+      s.sent++;
+      accepted |= 1 << active[n];
+    } else {
+      s.failed++;
+    }
+    s.lastStatus = delivery.httpCode;
+    s.lastMs = ms;
+    if (ms > s.maxMs) s.maxMs = ms;
+    s.totalMs += ms;
+    s.lastTime = now;
+    metrics.recordWebhookSend(delivery.durationUs, success);
+
+    if (success) {
+      LOG_I(Webhook, "[Notifier] %s: sent %s (HTTP %d, %lu ms)\n", target.name, notification.event,
+                    delivery.httpCode, (unsigned long)ms);
+    } else {
+      LOG_W(Webhook, "[Notifier] %s: failed to send %s (HTTP %d, %lu ms)\n", target.name,
+                    notification.event, delivery.httpCode, (unsigned long)ms);
+    }
+    deliveries[n].payload = "";  // Release the heap until the next notification
+  }
+  return accepted;
+}
+
+void Notifier::saveToNVS() {
+  preferences.begin("notify", false); // Read-write
+  if (targetCount > 0) {
+    preferences.putBytes("targets", targets, sizeof(NotifierTarget) * targetCount);
+  } else {
+    preferences.remove("targets");
+  }
+  preferences.end();
+  metrics.recordNvsWrite("notify", 1);
+}
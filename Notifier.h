@@ -0,0 +1,114 @@
+#ifndef NOTIFIER_H
+#define NOTIFIER_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "FixedPoint.h"
+#include "config.h"
+
+// Payload format of a notification target
+enum NotifierFormat : uint8_t {
+  NOTIFIER_DISCORD,         // {"content": message}
+  NOTIFIER_NTFY,            // Plain-text message, Title/Tags headers
+  NOTIFIER_JSON,            // User template with {message}, {event}, {rise}, {threshold}, {time}
+  NOTIFIER_HOME_ASSISTANT,  // {"title", "message", "data"}: webhook trigger or notify service
+  NOTIFIER_FORMAT_COUNT
+};
+
+// One place notifications are delivered to
+struct NotifierTarget {
+  char name[NOTIFIER_NAME_SIZE];
+  NotifierFormat format;
+  bool enabled;
+  char url[NOTIFIER_URL_SIZE];
+  char token[NOTIFIER_TOKEN_SIZE];                // Sent as a bearer token if set
+  char bodyTemplate[NOTIFIER_TEMPLATE_SIZE];      // NOTIFIER_JSON only; empty for the default
+};
+
+// Delivery outcome per target since boot
+struct NotifierStats {
+  uint32_t sent;
+  uint32_t failed;
+  int16_t lastStatus;        // HTTP status or negative HTTPClient error, 0 if never sent
+  uint32_t lastMs;
+  uint32_t maxMs;
+  uint32_t totalMs;          // Over sent + failed, for the mean
+  unsigned long lastTime;    // Unix seconds
+};
+
+// What happened; each target's formatter turns it into its payload
+struct Notification {
+  const char* event;     // "threshold", "headsUp" or "test"
+  const char* message;
+  RiseFixed rise;
+  RiseFixed threshold;
+  bool hasThreshold;
+};
+
+/*
+ * Notification target registry.
+ *
+ * Holds up to NOTIFIER_MAX_TARGETS targets, each with a payload format from
+ * a small table of formatters. deliver() sends one notification to every
+ * enabled target at once, each HTTP request on its own FreeRTOS task, so a
+ * slow or unreachable target costs its own timeout instead of adding to the
+ * others'. Stats and logging are done on the calling task once all
+ * deliveries have finished.
+ */
+class Notifier {
+public:
+  // Load targets from NVS
+  void begin();
+
+  uint8_t getTargetCount();
+  const NotifierTarget& getTarget(uint8_t index);
+  const NotifierStats& getStats(uint8_t index);
+
+  // True if at least one target is enabled and has a URL
+  bool hasTargets();
+
+  // Replace the target list (at most NOTIFIER_MAX_TARGETS); targets with
+  // the same name keep their stats
+  bool setTargets(const NotifierTarget* targets, uint8_t count);
+
+  static const uint8_t ALL_TARGETS = (1 << NOTIFIER_MAX_TARGETS) - 1;
+
+  // Bit per target index of the targets that are enabled and have a URL
+  uint8_t getActiveTargets();
+
+  // Send to the active targets in the mask concurrently and wait for all of
+  // them; returns the mask of targets that accepted it
+  uint8_t deliver(const Notification& notification, uint8_t targetMask = ALL_TARGETS);
+
+  static const char* formatName(NotifierFormat format);
+  static bool parseFormat(const char* name, NotifierFormat* format);
+
+private:
+  // One in-flight request, prepared on the calling task
+  struct Delivery {
+    String url;
+    String payload;
+    String authorization;
+    const char* contentType;
+    bool ntfyHeaders;
+    int httpCode;
+    uint32_t durationUs;
+    void* done;  // SemaphoreHandle_t, given when the request finished
+  };
+
+  Preferences preferences;
+  NotifierTarget targets[NOTIFIER_MAX_TARGETS];
+  NotifierStats stats[NOTIFIER_MAX_TARGETS];
+  uint8_t targetCount = 0;
+  Delivery deliveries[NOTIFIER_MAX_TARGETS];
+
+  // Build the request for one target
+  void prepare(const NotifierTarget& target, const Notification& notification, Delivery& delivery);
+
+  static void send(Delivery& delivery);
+  static void deliveryTask(void* parameter);
+
+  void saveToNVS();
+};
+
+#endif
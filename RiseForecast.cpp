@@ -0,0 +1,148 @@
+#include "RiseForecast.h"
+#include <math.h>
+
+// Initial guess: a dough that doubles with its fastest rise after 4 hours
+static const float INITIAL_THETA[3] = {100.0f, 0.7f, 4.0f};
+static const float INITIAL_VARIANCE[3] = {100.0f * 100.0f, 0.5f * 0.5f, 4.0f * 4.0f};
+
+// Random walk allowed per update, so the fit can follow a changing dough
+static const float PROCESS_NOISE[3] = {0.1f, 0.00001f, 0.001f};
+
+// Measurement noise variance: about one mm of sensor jitter on a 40-50 mm
+// dough is 2-2.5% rise. Kept fixed; adapting it to the residuals lets an
+// early misfit inflate it until the filter stops listening to the data.
+static const float NOISE_VAR = 4.0f;
+static const float RESIDUAL_SMOOTHING = 0.1f;
+static const float Z95 = 1.96f;
+
+RiseForecast::RiseForecast() {
+  reset();
+}
+
+void RiseForecast::reset() {
+  for (uint8_t i = 0; i < 3; i++) {
+    theta[i] = INITIAL_THETA[i];
+    for (uint8_t j = 0; j < 3; j++) {
+      P[i][j] = i == j ? INITIAL_VARIANCE[i] : 0.0f;
+    }
+  }
+  residualVar = 0.0f;
+  samples = 0;
+  origin = 0;
+}
+
+void RiseForecast::update(unsigned long timestamp, float rise) {
+  if (samples == 0) origin = timestamp;
+  float t = (float)(long)(timestamp - origin) / 3600.0f;
+
+  float A = theta[0];
+  float k = theta[1];
+  float t0 = theta[2];
+
+  // Model value and its gradient h over (A, k, t0)
+  float e = expf(-k * (t - t0));
+  float d = 1.0f + e;
+  float f = A / d;
+  float s = A * e / (d * d);
+  float h[3] = {1.0f / d, s * (t - t0), -s * k};
+
+  for (uint8_t i = 0; i < 3; i++) {
+    P[i][i] += PROCESS_NOISE[i];
+  }
+
+  // Ph, innovation variance and gain
+  float Ph[3];
+  for (uint8_t i = 0; i < 3; i++) {
+    Ph[i] = P[i][0] * h[0] + P[i][1] * h[1] + P[i][2] * h[2];
+  }
+  float predictedVar = h[0] * Ph[0] + h[1] * Ph[1] + h[2] * Ph[2];
+  float S = predictedVar + NOISE_VAR;
+  float residual = rise - f;
+
+  for (uint8_t i = 0; i < 3; i++) {
+    theta[i] += Ph[i] / S * residual;
+  }
+  // P -= K h^T P, with K = Ph / S (P is symmetric)
+  for (uint8_t i = 0; i < 3; i++) {
+    for (uint8_t j = 0; j < 3; j++) {
+      P[i][j] -= Ph[i] * Ph[j] / S;
+    }
+  }
+  clampParameters();
+
+  residualVar += RESIDUAL_SMOOTHING * (residual * residual - residualVar);
+
+  if (samples < UINT16_MAX) samples++;
+}
+
+void RiseForecast::clampParameters() {
+  // Keep the fit in a physically sensible region; a bad early step must not
+  // leave it somewhere it cannot recover from
+  if (theta[0] < 1.0f) theta[0] = 1.0f;
+  if (theta[0] > 1000.0f) theta[0] = 1000.0f;
+  if (theta[1] < 0.05f) theta[1] = 0.05f;
+  if (theta[1] > 10.0f) theta[1] = 10.0f;
+  if (theta[2] < -48.0f) theta[2] = -48.0f;
+  if (theta[2] > 96.0f) theta[2] = 96.0f;
+  for (uint8_t i = 0; i < 3; i++) {
+    if (P[i][i] < 1e-6f) P[i][i] = 1e-6f;
+  }
+}
+
+bool RiseForecast::isReady() const {
+  return samples >= MIN_POINTS;
+}
+
+bool RiseForecast::predictTime(float target, unsigned long* at, unsigned long* earliest,
+                               unsigned long* latest) const {
+  float A = theta[0];
+  float k = theta[1];
+  if (target <= 0.0f || target >= A) return false;
+
+  // Inverse of the logistic: t = t0 - ln(A / target - 1) / k
+  float L = logf(A / target - 1.0f);
+  float hours = theta[2] - L / k;
+  float g[3] = {-1.0f / (k * (A - target)), L / (k * k), 1.0f};
+  return toTimes(hours, g, at, earliest, latest);
+}
+
+float RiseForecast::getPeakRiseMargin() const {
+  return Z95 * sqrtf(P[0][0]);
+}
+
+bool RiseForecast::predictPeakTime(unsigned long* at, unsigned long* earliest,
+                                   unsigned long* latest) const {
+  // 95% of the plateau: t = t0 + ln(19) / k
+  const float LN19 = 2.944439f;
+  float k = theta[1];
+  float hours = theta[2] + LN19 / k;
+  float g[3] = {0.0f, -LN19 / (k * k), 1.0f};
+  return toTimes(hours, g, at, earliest, latest);
+}
+
+float RiseForecast::getResidual() const {
+  return sqrtf(residualVar);
+}
+
+bool RiseForecast::toTimes(float hours, const float g[3], unsigned long* at,
+                           unsigned long* earliest, unsigned long* latest) const {
+  float variance = 0.0f;
+  for (uint8_t i = 0; i < 3; i++) {
+    for (uint8_t j = 0; j < 3; j++) {
+      variance += g[i] * P[i][j] * g[j];
+    }
+  }
+  if (!isfinite(hours) || !isfinite(variance) || variance < 0.0f) return false;
+
+  float margin = Z95 * sqrtf(variance);
+  // Times before the first measurement are reported as the first measurement
+  auto toUnix = [this](float h) -> unsigned long {
+    if (h <= 0.0f) return origin;
+    if (h > 24.0f * 365.0f) h = 24.0f * 365.0f;
+    return origin + (unsigned long)(h * 3600.0f);
+  };
+  *at = toUnix(hours);
+  *earliest = toUnix(hours - margin);
+  *latest = toUnix(hours + margin);
+  return true;
+}
@@ -0,0 +1,61 @@
+#ifndef RISE_FORECAST_H
+#define RISE_FORECAST_H
+
+#include <Arduino.h>
+
+/*
+ * Incremental logistic fit of the rise curve.
+ *
+ *   rise(t) = A / (1 + exp(-k * (t - t0)))
+ *
+ * A is the plateau (peak) rise, k the growth rate and t0 the time of the
+ * steepest rise, in hours since the first measurement. Each measurement is
+ * folded in with one extended-Kalman / recursive-least-squares step on the
+ * three parameters: a fixed handful of float operations and one expf(), so
+ * the cost per update is bounded and small even with soft-float. The
+ * parameter covariance gives 95% bounds for the predictions.
+ */
+class RiseForecast {
+public:
+  // Measurements needed before predictions are reported
+  static const uint8_t MIN_POINTS = 6;
+
+  RiseForecast();
+
+  void reset();
+
+  // Fold in one measurement (Unix seconds, rise in percent)
+  void update(unsigned long timestamp, float rise);
+
+  // True once enough points have been fitted
+  bool isReady() const;
+
+  // Predicted time the rise reaches target, with a 95% interval. False if
+  // the fitted curve levels off below the target.
+  bool predictTime(float target, unsigned long* at, unsigned long* earliest, unsigned long* latest) const;
+
+  // Predicted peak: the plateau rise with its 95% margin, and the time the
+  // curve reaches 95% of it
+  float getPeakRise() const { return theta[0]; }
+  float getPeakRiseMargin() const;
+  bool predictPeakTime(unsigned long* at, unsigned long* earliest, unsigned long* latest) const;
+
+  // RMS of recent prediction errors, in percent
+  float getResidual() const;
+
+  uint16_t getSampleCount() const { return samples; }
+
+private:
+  float theta[3];     // A, k, t0
+  float P[3][3];      // Parameter covariance
+  float residualVar;  // Running mean of squared prediction errors
+  uint16_t samples;
+  unsigned long origin;
+
+  void clampParameters();
+  // 95% interval of a time prediction (hours) with gradient g over theta
+  bool toTimes(float hours, const float g[3], unsigned long* at, unsigned long* earliest,
+               unsigned long* latest) const;
+};
+
+#endif
@@ -1,32 +1,61 @@
-#ifndef SENSOR_MANAGER_H
-#define SENSOR_MANAGER_H
-
-#include <Arduino.h>
-#include <VL53L1X.h>
-
-class SensorManager {
-public:
-  SensorManager();
-  
-  // Initialize sensor
-  bool begin();
-  
-  // Take a single measurement
-  uint16_t getDistance();
-  
-  // Take multiple measurements and return average
-  uint16_t getAveragedDistance(uint8_t samples = 5);
-  
-  // Check if sensor is initialized
-  bool isInitialized();
-  
-  // Get last measurement time
-  unsigned long getLastMeasurementTime();
-  
-private:
-  VL53L1X sensor;
-  bool initialized = false;
-  unsigned long lastMeasurementTime = 0;
-};
-
-#endif
+#ifndef SENSOR_MANAGER_H
+#define SENSOR_MANAGER_H
+
+#include <Arduino.h>
+#include <VL53L1X.h>
+
+// What an on-demand sweep is for; only sweeps with the same purpose are shared
+enum SweepPurpose : uint8_t {
+  SWEEP_MEASUREMENT,
+  SWEEP_ZERO_POINT,
+  SWEEP_DOUGH_HEIGHT
+};
+
+class SensorManager {
+public:
+  SensorManager();
+  
+  // Initialize sensor
+  bool begin();
+  
+  // Take a single measurement
+  uint16_t getDistance();
+  
+  // Take multiple measurements and return average
+  uint16_t getAveragedDistance(uint8_t samples = 5);
+  
+  // Shared averaged reading for on-demand requests. Reuses the last sweep
+  // for the same purpose if it finished within SENSOR_SWEEP_JOIN_MS
+  // (requests that queued behind it on the loop task) or maxAgeMs. sweepId
+  // identifies the sweep the result came from.
+  uint16_t getSharedDistance(SweepPurpose purpose, uint8_t samples, unsigned long maxAgeMs = 0,
+                             uint32_t* sweepId = nullptr);
+  
+  // Mark a sweep as stored as a data point; false if it already was
+  bool claimSweep(uint32_t sweepId);
+  
+  // Median-based outlier filter: sorts samples in place and returns the
+  // average of those within 12% of the median (the median if none are)
+  static uint16_t filterSamples(uint16_t* measurements, uint8_t count);
+  
+  // Check if sensor is initialized
+  bool isInitialized();
+  
+  // Get last measurement time
+  unsigned long getLastMeasurementTime();
+  
+private:
+  VL53L1X sensor;
+  bool initialized = false;
+  unsigned long lastMeasurementTime = 0;
+  
+  // Last completed shared sweep
+  uint32_t sweepCount = 0;
+  uint16_t sweepDistance = 0;
+  uint8_t sweepSamples = 0;
+  SweepPurpose sweepPurpose = SWEEP_MEASUREMENT;
+  unsigned long sweepCompletedAt = 0;
+  uint32_t claimedSweep = 0;
+};
+
+#endif
@@ -1,1369 +1,1719 @@
-#include "WebPages.h"
-
-String WebPages::getIndexHTML() {
-  return R"rawliteral(
-<!DOCTYPE html>
-<html lang="en">
-<head>
-    <meta charset="UTF-8">
-    <meta name="viewport" content="width=device-width, initial-scale=1.0">
-    <title>Dough Tracker</title>
-    <script src="https://cdn.jsdelivr.net/npm/chart.js"></script>
-    <script src="https://cdn.jsdelivr.net/npm/hammerjs@2.0.8"></script>
-    <script src="https://cdn.jsdelivr.net/npm/chartjs-plugin-zoom@2.0.1/dist/chartjs-plugin-zoom.min.js"></script>
-    <style>
-)rawliteral" + getInlineCSS() + R"rawliteral(
-    </style>
-</head>
-<body>
-    <div class="container">
-        <header>
-            <h1>🍞 Dough Tracker</h1>
-            <div class="wifi-status">
-                <span id="wifiStatus" class="status-indicator"></span>
-                <span id="ipAddress">IP: --</span>
-            </div>
-        </header>
-
-        <main>
-            <!-- Status Section -->
-            <section class="status-section">
-                <div class="status-box">
-                    <h2 id="initialThickness">0 mm</h2>
-                    <p>Initial Thickness</p>
-                </div>
-                <div class="status-box">
-                    <h2 id="thickness">0 mm</h2>
-                    <p>Current Thickness</p>
-                </div>
-                <div class="status-box">
-                    <h2 id="risePercentage">0%</h2>
-                    <p>Current Rise</p>
-                </div>
-                <div class="status-box">
-                    <h2 id="elapsedTime">0:00</h2>
-                    <p>Elapsed Time</p>
-                </div>
-            </section>
-
-            <!-- Chart Section -->
-            <section class="chart-section">
-                <h2>Rise Progress</h2>
-                <p style="font-size: 12px; color: #7D6658; margin-bottom: 10px;">Scroll to zoom, Ctrl+drag to pan, double-click to reset</p>
-                <div class="chart-container">
-                    <canvas id="riseChart"></canvas>
-                </div>
-            </section>
-
-            <!-- Controls Section -->
-            <section class="controls-section">
-                <h2>Controls</h2>
-                <div class="button-grid">
-                    <button onclick="calibrateZero()" class="btn btn-primary">📏 Calibrate empty container</button>
-                    <button onclick="calibrateDough()" class="btn btn-primary">🍞 Calibrate fresh starter</button>
-                </div>
-                <div style="margin-top: 20px; padding-top: 15px; border-top: 1px solid #E6D5C3;">
-                    <h3 style="margin-bottom: 10px; font-size: 16px;">📦 Container Presets</h3>
-                    <div style="display: flex; gap: 8px; flex-wrap: wrap; align-items: center;">
-                        <select id="presetSelect" style="flex: 1; min-width: 150px; padding: 8px;">
-                            <option value="">-- Select --</option>
-                        </select>
-                        <button onclick="loadPreset()" class="btn btn-success">Load</button>
-                        <button onclick="delPreset()" class="btn btn-danger">Del</button>
-                    </div>
-                    <div style="display: flex; gap: 8px; margin-top: 10px; align-items: center;">
-                        <input type="text" id="presetName" placeholder="Preset name" maxlength="11" style="flex: 1; padding: 8px;">
-                        <button onclick="savePreset()" class="btn btn-primary">Save Current</button>
-                    </div>
-                </div>
-            </section>
-
-            <!-- Data Table -->
-            <section class="data-section">
-                <div class="collapsible-header" onclick="toggleSection('historyContent')">
-                    <h2>📊 Measurement History</h2>
-                    <span class="toggle-arrow" id="historyArrow">▼</span>
-                </div>
-                <div id="historyContent" class="collapsible-content">
-                    <div class="table-wrapper">
-                        <table id="dataTable">
-                            <thead>
-                                <tr>
-                                    <th>Time</th>
-                                    <th>Thickness (mm)</th>
-                                    <th>Rise (%)</th>
-                                </tr>
-                            </thead>
-                            <tbody id="tableBody">
-                            </tbody>
-                        </table>
-                    </div>
-                    <div style="margin-top: 15px;">
-                        <button onclick="showResetDataDialog()" class="btn btn-danger">🗑️ Reset Data</button>
-                    </div>
-                </div>
-            </section>
-
-            <!-- WiFi Configuration Section -->
-            <section class="wifi-config-section">
-                <div class="collapsible-header" onclick="toggleSection('wifiContent')">
-                    <h2>📡 WiFi Configuration</h2>
-                    <span class="toggle-arrow" id="wifiArrow">▼</span>
-                </div>
-                <div id="wifiContent" class="collapsible-content">
-                <div class="wifi-controls">
-                    <button onclick="scanNetworks()" class="btn btn-primary">Scan Networks</button>
-                    <div id="scanStatus" style="margin-top: 10px; display: none;">Scanning...</div>
-                </div>
-                <div id="networkList" style="margin-top: 15px;">
-                    <label for="networkSelect">Available Networks:</label>
-                    <select id="networkSelect" style="width: 100%; padding: 8px; margin-top: 8px;">
-                        <option value="">-- Select a network --</option>
-                    </select>
-                </div>
-                <div style="margin-top: 15px;">
-                    <label for="wifiPassword">Password:</label>
-                    <input type="password" id="wifiPassword" placeholder="Enter WiFi password" style="width: 100%; padding: 8px; margin-top: 8px;">
-                </div>
-                <div style="margin-top: 15px;">
-                    <button onclick="connectToWiFi()" class="btn btn-success">Connect</button>
-                    <div id="connectStatus" style="margin-top: 10px; display: none; padding: 10px; background: #e3f2fd; border-radius: 6px;"></div>
-                </div>
-                <div style="margin-top: 15px; padding-top: 15px; border-top: 1px solid #E6D5C3;">
-                    <button onclick="showResetWifiDialog()" class="btn btn-warning">🔌 Reset WiFi</button>
-                </div>
-                </div>
-            </section>
-
-            <!-- Discord Webhook Configuration Section -->
-            <section class="webhook-config-section">
-                <div class="collapsible-header" onclick="toggleSection('webhookContent')">
-                    <h2>🔔 Discord Notifications</h2>
-                    <span class="toggle-arrow" id="webhookArrow">▼</span>
-                </div>
-                <div id="webhookContent" class="collapsible-content">
-                    <div class="webhook-info" style="margin-bottom: 15px; padding: 15px; background: #E3F2FD; border-radius: 8px; font-size: 14px;">
-                        <p style="margin-bottom: 8px;"><strong>Get notified when your dough reaches:</strong></p>
-                        <ul style="margin-left: 20px; line-height: 1.6;">
-                            <li>50% rise - "Your dough has risen 50%, it's getting there!"</li>
-                            <li>100% rise - "Your dough has risen 100%, it's doubled!"</li>
-                            <li>200% rise - "Wow, you dough has tripled!"</li>
-                        </ul>
-                    </div>
-
-                    <div class="webhook-status" style="margin-bottom: 15px; padding: 10px; background: #f5f5f5; border-radius: 6px;">
-                        <div style="display: flex; justify-content: space-between; align-items: center;">
-                            <span>Status:</span>
-                            <span id="webhookStatus" style="font-weight: bold;">Not configured</span>
-                        </div>
-                        <div id="webhookThresholds" style="margin-top: 10px; font-size: 13px; display: none;">
-                            <div>✓ 50% <span id="threshold50Status"></span></div>
-                            <div>✓ 100% <span id="threshold100Status"></span></div>
-                            <div>✓ 200% <span id="threshold200Status"></span></div>
-                        </div>
-                    </div>
-
-                    <div style="margin-top: 15px;">
-                        <label for="webhookURL">Discord Webhook URL:</label>
-                        <input type="text" id="webhookURL" placeholder="https://discord.com/api/webhooks/..."
-                               style="width: 100%; padding: 8px; margin-top: 8px; font-family: monospace; font-size: 12px;">
-                        <p style="font-size: 12px; color: #666; margin-top: 5px;">
-                            Get your webhook URL from Discord: Server Settings → Integrations → Webhooks
-                        </p>
-                    </div>
-
-                    <div style="margin-top: 15px;">
-                        <label style="display: flex; align-items: center; gap: 8px; cursor: pointer;">
-                            <input type="checkbox" id="webhookEnabled" checked>
-                            <span>Enable notifications</span>
-                        </label>
-                    </div>
-
-                    <div style="margin-top: 15px; display: flex; gap: 10px;">
-                        <button onclick="saveWebhook()" class="btn btn-primary">💾 Save Webhook</button>
-                        <button onclick="testWebhook()" class="btn btn-secondary" id="testWebhookBtn">🧪 Test</button>
-                    </div>
-                </div>
-            </section>
-        </main>
-
-        <footer>
-            <p>Sourdough Tracker v1.0 | Last update: <span id="lastUpdate">--:--:--</span></p>
-        </footer>
-    </div>
-
-    <!-- Offset Dialog -->
-    <div id="offsetDialog" class="dialog" style="display: none;">
-        <div class="dialog-content">
-            <h3>Set Measurement Offset</h3>
-            <p>Enter offset value in millimeters:</p>
-            <input type="number" id="offsetInput" placeholder="0" min="-50" max="50">
-            <div class="dialog-buttons">
-                <button onclick="saveOffset()" class="btn btn-primary">Save</button>
-                <button onclick="closeDialog()" class="btn btn-secondary">Cancel</button>
-            </div>
-        </div>
-    </div>
-
-    <!-- Confirmation Dialog -->
-    <div id="confirmDialog" class="dialog" style="display: none;">
-        <div class="dialog-content">
-            <h3 id="confirmTitle">Confirm Action</h3>
-            <p id="confirmMessage">Are you sure?</p>
-            <div class="dialog-buttons">
-                <button id="confirmYes" class="btn btn-primary">Confirm</button>
-                <button onclick="closeConfirmDialog()" class="btn btn-secondary">Cancel</button>
-            </div>
-        </div>
-    </div>
-
-    <script>
-)rawliteral" + getInlineJavaScript() + R"rawliteral(
-    </script>
-</body>
-</html>
-)rawliteral";
-}
-
-String WebPages::getInlineCSS() {
-  return R"rawliteral(
-* {
-    margin: 0;
-    padding: 0;
-    box-sizing: border-box;
-}
-
-body {
-    font-family: Georgia, Palatino, serif;
-    background: linear-gradient(135deg, #FAF3E0 0%, #EBD9C5 100%);
-    min-height: 100vh;
-    color: #3E2723;
-}
-
-.container {
-    max-width: 1000px;
-    margin: 0 auto;
-    padding: 20px;
-}
-
-header {
-    background: white;
-    border-radius: 14px;
-    padding: 20px;
-    margin-bottom: 20px;
-    box-shadow: 0 4px 12px rgba(139, 94, 60, 0.15);
-    display: flex;
-    justify-content: space-between;
-    align-items: center;
-}
-
-header h1 {
-    font-size: 28px;
-    color: #3E2723;
-}
-
-.wifi-status {
-    display: flex;
-    align-items: center;
-    gap: 10px;
-    font-size: 14px;
-}
-
-.status-indicator {
-    width: 12px;
-    height: 12px;
-    border-radius: 50%;
-    background: #ff6b6b;
-    display: inline-block;
-}
-
-.status-indicator.connected {
-    background: #51cf66;
-}
-
-main {
-    display: grid;
-    gap: 20px;
-}
-
-section {
-    background: #FFFAF5;
-    border-radius: 14px;
-    padding: 20px;
-    box-shadow: 0 4px 12px rgba(139, 94, 60, 0.12);
-}
-
-section h2 {
-    margin-bottom: 15px;
-    color: #3E2723;
-    font-size: 20px;
-}
-
-.status-section {
-    display: grid;
-    grid-template-columns: repeat(auto-fit, minmax(150px, 1fr));
-    gap: 15px;
-}
-
-.status-box {
-    text-align: center;
-    padding: 20px;
-    background: linear-gradient(135deg, #E8956B 0%, #D4A574 100%);
-    color: #FAF3E0;
-    border-radius: 14px;
-    transition: all 0.3s cubic-bezier(0.25, 0.46, 0.45, 0.94);
-}
-
-.status-box:hover {
-    transform: translateY(-4px) scale(1.03);
-    box-shadow: 0 6px 16px rgba(198, 110, 78, 0.25);
-}
-
-.status-box h2 {
-    font-size: 32px;
-    margin-bottom: 10px;
-    color: #FAF3E0;
-    transition: all 0.5s cubic-bezier(0.25, 0.46, 0.45, 0.94);
-}
-
-.status-box p {
-    font-size: 14px;
-    opacity: 0.95;
-}
-
-.chart-container {
-    position: relative;
-    height: 300px;
-}
-
-.table-wrapper {
-    overflow-x: auto;
-}
-
-table {
-    width: 100%;
-    border-collapse: collapse;
-}
-
-thead {
-    background: #F5EFE6;
-}
-
-th {
-    padding: 12px;
-    text-align: left;
-    font-weight: 600;
-    border-bottom: 2px solid #E6D5C3;
-    color: #3E2723;
-}
-
-td {
-    padding: 10px 12px;
-    border-bottom: 1px solid #F0E8DC;
-    color: #5D4037;
-}
-
-tr:hover {
-    background: #FAF3E0;
-}
-
-.controls-section {
-    background: #F5EFE6;
-}
-
-.button-grid {
-    display: grid;
-    grid-template-columns: repeat(auto-fit, minmax(150px, 1fr));
-    gap: 10px;
-}
-
-.btn {
-    padding: 12px 16px;
-    border: none;
-    border-radius: 10px;
-    font-size: 14px;
-    font-weight: 600;
-    cursor: pointer;
-    font-family: 'Trebuchet MS', Tahoma, sans-serif;
-    transition: all 0.3s cubic-bezier(0.25, 0.46, 0.45, 0.94);
-}
-
-.btn:hover {
-    transform: translateY(-3px) scale(1.02);
-    box-shadow: 0 6px 16px rgba(198, 110, 78, 0.20);
-}
-
-.btn:active {
-    transform: translateY(1px) scale(0.98);
-    box-shadow: inset 0 2px 4px rgba(139, 94, 60, 0.2);
-}
-
-.btn-primary {
-    background: #C66E4E;
-    color: white;
-}
-
-.btn-primary:hover {
-    background: #B45F43;
-}
-
-.btn-success {
-    background: #8B9D6F;
-    color: white;
-}
-
-.btn-success:hover {
-    background: #7A8B60;
-}
-
-.btn-secondary {
-    background: #9C8275;
-    color: white;
-}
-
-.btn-secondary:hover {
-    background: #8A7366;
-}
-
-.btn-danger {
-    background: #BA4727;
-    color: white;
-}
-
-.btn-danger:hover {
-    background: #A33C1F;
-}
-
-.btn-warning {
-    background: #E6B87D;
-    color: #3E2723;
-}
-
-.btn-warning:hover {
-    background: #D4A574;
-}
-
-footer {
-    text-align: center;
-    padding: 20px;
-    color: #7D6658;
-    font-size: 12px;
-}
-
-.dialog {
-    position: fixed;
-    top: 0;
-    left: 0;
-    right: 0;
-    bottom: 0;
-    background: rgba(139, 94, 60, 0.5);
-    display: flex;
-    align-items: center;
-    justify-content: center;
-    z-index: 1000;
-}
-
-.dialog-content {
-    background: #FFFAF5;
-    border-radius: 14px;
-    padding: 30px;
-    box-shadow: 0 10px 40px rgba(139, 94, 60, 0.3);
-    max-width: 400px;
-}
-
-.dialog-content h3 {
-    margin-bottom: 15px;
-    color: #3E2723;
-}
-
-.dialog-content input {
-    width: 100%;
-    padding: 10px;
-    margin: 15px 0;
-    border: 2px solid #E6D5C3;
-    border-radius: 8px;
-    font-size: 16px;
-    font-family: Georgia, Palatino, serif;
-    background: white;
-    color: #3E2723;
-}
-
-.dialog-content input:focus {
-    outline: none;
-    border-color: #C66E4E;
-}
-
-.dialog-buttons {
-    display: flex;
-    gap: 10px;
-    margin-top: 20px;
-}
-
-.dialog-buttons button {
-    flex: 1;
-}
-
-.collapsible-header {
-    display: flex;
-    justify-content: space-between;
-    align-items: center;
-    cursor: pointer;
-    user-select: none;
-    margin: -20px -20px 0 -20px;
-    padding: 20px;
-    border-bottom: 1px solid #eee;
-}
-
-.collapsible-header h2 {
-    margin: 0;
-}
-
-.toggle-arrow {
-    font-size: 12px;
-    transition: transform 0.3s ease;
-    color: #999999;
-}
-
-.collapsible-content {
-    display: none;
-    animation: slideDown 0.3s ease;
-}
-
-.collapsible-content.expanded {
-    display: block;
-}
-
-@keyframes slideDown {
-    from {
-        opacity: 0;
-        max-height: 0;
-    }
-    to {
-        opacity: 1;
-        max-height: 1000px;
-    }
-}
-
-.wifi-content-expanded {
-    display: block;
-}
-
-/* Toast Notification System */
-.toast-container {
-    position: fixed;
-    top: 20px;
-    right: 20px;
-    z-index: 9999;
-    display: flex;
-    flex-direction: column;
-    gap: 10px;
-}
-
-.toast {
-    background: white;
-    border-left: 4px solid #C66E4E;
-    border-radius: 10px;
-    padding: 16px 20px;
-    box-shadow: 0 4px 12px rgba(139, 94, 60, 0.25);
-    min-width: 300px;
-    max-width: 400px;
-    display: flex;
-    align-items: center;
-    gap: 12px;
-    animation: slideInRight 0.3s ease;
-    font-family: 'Trebuchet MS', Tahoma, sans-serif;
-}
-
-.toast.success { border-left-color: #8B9D6F; }
-.toast.error { border-left-color: #BA4727; }
-.toast.warning { border-left-color: #E6B87D; }
-
-.toast-icon {
-    font-size: 20px;
-    flex-shrink: 0;
-}
-
-.toast-message {
-    flex: 1;
-    color: #3E2723;
-    font-size: 14px;
-}
-
-@keyframes slideInRight {
-    from {
-        transform: translateX(400px);
-        opacity: 0;
-    }
-    to {
-        transform: translateX(0);
-        opacity: 1;
-    }
-}
-
-@keyframes fadeOut {
-    to {
-        opacity: 0;
-        transform: translateX(400px);
-    }
-}
-
-/* Button Loading States */
-.btn.loading {
-    position: relative;
-    pointer-events: none;
-    opacity: 0.7;
-}
-
-.btn.loading::after {
-    content: '';
-    position: absolute;
-    width: 16px;
-    height: 16px;
-    top: 50%;
-    left: 50%;
-    margin-left: -8px;
-    margin-top: -8px;
-    border: 2px solid white;
-    border-radius: 50%;
-    border-top-color: transparent;
-    animation: spin 0.6s linear infinite;
-}
-
-@keyframes spin {
-    to { transform: rotate(360deg); }
-}
-
-/* Status Box Pulse Animation */
-.status-box.updated {
-    animation: pulse-warm 0.6s ease;
-}
-
-@keyframes pulse-warm {
-    0%, 100% {
-        transform: scale(1);
-        box-shadow: 0 4px 8px rgba(139, 94, 60, 0.15);
-    }
-    50% {
-        transform: scale(1.05);
-        box-shadow: 0 6px 20px rgba(198, 110, 78, 0.3);
-    }
-}
-
-@media (max-width: 600px) {
-    header {
-        flex-direction: column;
-        gap: 15px;
-    }
-
-    .button-grid {
-        grid-template-columns: 1fr;
-    }
-
-    .toast {
-        min-width: 250px;
-        max-width: calc(100vw - 40px);
-    }
-}
-)rawliteral";
-}
-
-String WebPages::getInlineJavaScript() {
-  return R"rawliteral(
-let chart = null;
-let autoRefreshInterval = null;
-let calibrationTime = 0;  // Store calibration timestamp globally
-
-// Toggle section visibility
-function toggleSection(contentId) {
-    const content = document.getElementById(contentId);
-    const arrow = document.getElementById(contentId === 'historyContent' ? 'historyArrow' : 'wifiArrow');
-    
-    if (content.classList.contains('expanded')) {
-        content.classList.remove('expanded');
-        arrow.style.transform = 'rotate(0deg)';
-    } else {
-        content.classList.add('expanded');
-        arrow.style.transform = 'rotate(180deg)';
-    }
-}
-
-// Webhook configuration functions
-function saveWebhook() {
-    const url = document.getElementById('webhookURL').value.trim();
-    const enabled = document.getElementById('webhookEnabled').checked;
-
-    if (url && !url.startsWith('https://discord.com/api/webhooks/') &&
-        !url.startsWith('https://discordapp.com/api/webhooks/')) {
-        showToast('Invalid Discord webhook URL', 'error');
-        return;
-    }
-
-    const data = {
-        url: url,
-        enabled: enabled
-    };
-
-    fetch('/api/webhook', {
-        method: 'POST',
-        headers: { 'Content-Type': 'application/json' },
-        body: JSON.stringify(data)
-    })
-    .then(response => response.json())
-    .then(data => {
-        if (data.success) {
-            showToast('Webhook settings saved!', 'success');
-            updateWebhookStatus();
-        } else {
-            showToast('Failed to save webhook', 'error');
-        }
-    })
-    .catch(error => {
-        console.error('Error saving webhook:', error);
-        showToast('Error saving webhook', 'error');
-    });
-}
-
-function testWebhook() {
-    const btn = document.getElementById('testWebhookBtn');
-    setButtonLoading(btn, true);
-
-    fetch('/api/test-webhook', { method: 'POST' })
-        .then(response => response.json())
-        .then(data => {
-            setButtonLoading(btn, false);
-            if (data.success) {
-                showToast('Test notification sent! Check Discord.', 'success');
-            } else {
-                showToast(data.error || 'Test failed', 'error');
-            }
-        })
-        .catch(error => {
-            setButtonLoading(btn, false);
-            console.error('Error testing webhook:', error);
-            showToast('Error sending test', 'error');
-        });
-}
-
-function updateWebhookStatus() {
-    fetch('/api/webhook')
-        .then(response => response.json())
-        .then(data => {
-            const statusEl = document.getElementById('webhookStatus');
-            const urlInput = document.getElementById('webhookURL');
-            const enabledCheckbox = document.getElementById('webhookEnabled');
-            const thresholdsDiv = document.getElementById('webhookThresholds');
-
-            urlInput.value = data.url || '';
-            enabledCheckbox.checked = data.enabled;
-
-            if (data.configured && data.enabled) {
-                statusEl.textContent = 'Active ✓';
-                statusEl.style.color = '#51cf66';
-
-                // Show threshold status
-                thresholdsDiv.style.display = 'block';
-                document.getElementById('threshold50Status').textContent =
-                    data.threshold50Reached ? '(sent)' : '(pending)';
-                document.getElementById('threshold100Status').textContent =
-                    data.threshold100Reached ? '(sent)' : '(pending)';
-                document.getElementById('threshold200Status').textContent =
-                    data.threshold200Reached ? '(sent)' : '(pending)';
-            } else if (data.configured && !data.enabled) {
-                statusEl.textContent = 'Configured (disabled)';
-                statusEl.style.color = '#ff8c00';
-                thresholdsDiv.style.display = 'none';
-            } else {
-                statusEl.textContent = 'Not configured';
-                statusEl.style.color = '#999';
-                thresholdsDiv.style.display = 'none';
-            }
-        })
-        .catch(error => {
-            console.error('Error fetching webhook status:', error);
-        });
-}
-
-// Container preset functions
-function loadPresets() {
-    fetch('/api/presets')
-        .then(response => response.json())
-        .then(data => {
-            const select = document.getElementById('presetSelect');
-            select.innerHTML = '<option value="">-- Select --</option>';
-            data.presets.forEach((p, i) => {
-                const opt = document.createElement('option');
-                opt.value = i;
-                opt.textContent = p.n + ' (' + p.z + 'mm)';
-                select.appendChild(opt);
-            });
-        })
-        .catch(error => console.error('Error loading presets:', error));
-}
-
-function loadPreset() {
-    const idx = document.getElementById('presetSelect').value;
-    if (idx === '') { showToast('Select a preset first', 'warning'); return; }
-
-    fetch('/api/presets', {
-        method: 'DELETE',
-        headers: { 'Content-Type': 'application/json' },
-        body: JSON.stringify({ i: parseInt(idx), a: 'l' })
-    })
-    .then(response => response.json())
-    .then(data => {
-        if (data.ok) {
-            showToast('Preset loaded!', 'success');
-            updateStatus();
-        } else {
-            showToast(data.e || 'Load failed', 'error');
-        }
-    })
-    .catch(error => showToast('Error: ' + error, 'error'));
-}
-
-function delPreset() {
-    const idx = document.getElementById('presetSelect').value;
-    if (idx === '') { showToast('Select a preset first', 'warning'); return; }
-
-    showConfirmDialog('Delete Preset', 'Delete this preset?', function() {
-        fetch('/api/presets', {
-            method: 'DELETE',
-            headers: { 'Content-Type': 'application/json' },
-            body: JSON.stringify({ i: parseInt(idx), a: 'd' })
-        })
-        .then(response => response.json())
-        .then(data => {
-            if (data.ok) {
-                showToast('Preset deleted', 'success');
-                loadPresets();
-            } else {
-                showToast(data.e || 'Delete failed', 'error');
-            }
-        })
-        .catch(error => showToast('Error: ' + error, 'error'));
-    });
-}
-
-function savePreset() {
-    const name = document.getElementById('presetName').value.trim();
-    if (!name) { showToast('Enter a name', 'warning'); return; }
-
-    fetch('/api/presets', {
-        method: 'POST',
-        headers: { 'Content-Type': 'application/json' },
-        body: JSON.stringify({ n: name })
-    })
-    .then(response => response.json())
-    .then(data => {
-        if (data.ok) {
-            showToast('Preset saved!', 'success');
-            document.getElementById('presetName').value = '';
-            loadPresets();
-        } else {
-            showToast(data.e || 'Save failed', 'error');
-        }
-    })
-    .catch(error => showToast('Error: ' + error, 'error'));
-}
-
-// Initialize on page load
-document.addEventListener('DOMContentLoaded', function() {
-    initializeChart();
-    updateStatus();
-    updateWebhookStatus();
-    loadPresets();
-    autoRefreshInterval = setInterval(function() {
-        updateStatus();
-        updateWebhookStatus();
-    }, 30000); // Update every 30 seconds
-});
-
-function initializeChart() {
-    const ctx = document.getElementById('riseChart');
-    if (!ctx) return;
-    
-    chart = new Chart(ctx, {
-        type: 'line',
-        data: {
-            labels: [],
-            datasets: [{
-                label: 'Dough Rise (%)',
-                data: [],
-                borderColor: '#C66E4E',
-                backgroundColor: 'rgba(198, 110, 78, 0.1)',
-                tension: 0.3,
-                fill: true,
-                pointBackgroundColor: '#C66E4E',
-                pointBorderColor: '#FAF3E0',
-                pointBorderWidth: 2,
-                pointRadius: 2.5,
-                pointHoverRadius: 4
-            }]
-        },
-        options: {
-            responsive: true,
-            maintainAspectRatio: false,
-            plugins: {
-                legend: {
-                    display: true,
-                    position: 'top'
-                },
-                zoom: {
-                    pan: {
-                        enabled: true,
-                        mode: 'x',
-                        modifierKey: 'ctrl'
-                    },
-                    zoom: {
-                        wheel: {
-                            enabled: true,
-                            speed: 0.1
-                        },
-                        pinch: {
-                            enabled: true
-                        },
-                        mode: 'x'
-                    },
-                    limits: {
-                        x: {min: 'original', max: 'original'}
-                    }
-                }
-            },
-            scales: {
-                y: {
-                    beginAtZero: true,
-                    title: {
-                        display: true,
-                        text: 'Rise Percentage (%)'
-                    }
-                }
-            }
-        }
-    });
-
-    // Add double-click to reset zoom
-    ctx.ondblclick = function() {
-        chart.resetZoom();
-    };
-}
-
-// Toast notification system
-function showToast(message, type = 'info') {
-    let container = document.querySelector('.toast-container');
-    if (!container) {
-        container = document.createElement('div');
-        container.className = 'toast-container';
-        document.body.appendChild(container);
-    }
-
-    const icons = {
-        success: '✓',
-        error: '✗',
-        warning: '⚠',
-        info: 'ℹ'
-    };
-
-    const toast = document.createElement('div');
-    toast.className = `toast ${type}`;
-    toast.innerHTML = `
-        <span class="toast-icon">${icons[type] || icons.info}</span>
-        <span class="toast-message">${message}</span>
-    `;
-
-    container.appendChild(toast);
-
-    setTimeout(() => {
-        toast.style.animation = 'fadeOut 0.3s ease forwards';
-        setTimeout(() => toast.remove(), 300);
-    }, 3000);
-}
-
-// Button loading state helpers
-function setButtonLoading(button, loading) {
-    if (loading) {
-        button.classList.add('loading');
-        button.disabled = true;
-    } else {
-        button.classList.remove('loading');
-        button.disabled = false;
-    }
-}
-
-// Custom confirmation dialog
-function showConfirmDialog(title, message, onConfirm) {
-    document.getElementById('confirmTitle').textContent = title;
-    document.getElementById('confirmMessage').textContent = message;
-    document.getElementById('confirmDialog').style.display = 'flex';
-
-    // Remove old listeners and add new one
-    const yesBtn = document.getElementById('confirmYes');
-    const newYesBtn = yesBtn.cloneNode(true);
-    yesBtn.parentNode.replaceChild(newYesBtn, yesBtn);
-
-    newYesBtn.onclick = function() {
-        closeConfirmDialog();
-        onConfirm();
-    };
-}
-
-function closeConfirmDialog() {
-    document.getElementById('confirmDialog').style.display = 'none';
-}
-
-function updateStatus() {
-    // Fetch data from /data endpoint
-    let measurements = null;
-    let statusData = null;
-    let dataFetched = false;
-    let statusFetched = false;
-    
-    function updateChartIfReady() {
-        if (dataFetched && statusFetched && measurements) {
-            updateChart(measurements);
-        }
-    }
-    
-    fetch('/data')
-        .then(response => response.json())
-        .then(data => {
-            measurements = data.measurements;
-            dataFetched = true;
-            updateUI(data);
-            updateChartIfReady();
-        })
-        .catch(error => {
-            console.error('Error fetching data:', error);
-        });
-    
-    // Fetch WiFi and calibration status
-    fetch('/status')
-        .then(response => response.json())
-        .then(data => {
-            statusData = data;
-            statusFetched = true;
-            updateWifiStatus(data);
-            updateCalibrationStatus(data);
-            updateChartIfReady();
-        })
-        .catch(error => {
-            console.error('Error fetching status:', error);
-        });
-}
-
-function updateUI(data) {
-    if (!data || !data.measurements || data.measurements.length === 0) {
-        return;
-    }
-
-    const latest = data.measurements[data.measurements.length - 1];
-
-    // Update with pulse animation
-    const statusBoxes = document.querySelectorAll('.status-box');
-    statusBoxes.forEach(box => box.classList.add('updated'));
-    setTimeout(() => {
-        statusBoxes.forEach(box => box.classList.remove('updated'));
-    }, 600);
-
-    // Update status boxes
-    document.getElementById('risePercentage').textContent = latest.rise.toFixed(1) + '%';
-    document.getElementById('thickness').textContent = latest.thickness + ' mm';
-
-    // Elapsed time will be updated in updateCalibrationStatus with calibration timestamp
-    // Update chart
-    updateChart(data.measurements);
-
-    // Update table
-    updateTable(data.measurements);
-
-    // Update last update time
-    document.getElementById('lastUpdate').textContent = new Date().toLocaleTimeString();
-}
-
-function formatTime24h(timestamp) {
-    // Format timestamp in 24hr format for Bergen, Norway (Europe/Oslo timezone)
-    const date = new Date(timestamp * 1000);
-    return date.toLocaleString('no-NO', {
-        hour12: false,
-        hour: '2-digit',
-        minute: '2-digit',
-        second: '2-digit',
-        timeZone: 'Europe/Oslo'
-    });
-}
-
-function updateChart(measurements) {
-    if (!chart) return;
-    
-    // Calculate elapsed time for each measurement from calibration time
-    const baselineTime = calibrationTime > 0 ? calibrationTime : measurements[0].timestamp;
-    chart.data.labels = measurements.map(m => {
-        // Get clock time
-        const timeStr = formatTime24h(m.timestamp);
-        
-        // Calculate elapsed time from baseline (calibration time or first measurement)
-        const elapsedSeconds = Math.floor((m.timestamp - baselineTime));
-        const hours = Math.floor(elapsedSeconds / 3600);
-        const minutes = Math.floor((elapsedSeconds % 3600) / 60);
-        
-        // Format as "HH:MM (Elapsed: H:MM)" (e.g., "10:15 (Elapsed: 15:00)")
-        return timeStr + '\n(Elapsed: ' + hours + ':' + String(minutes).padStart(2, '0') + ')';
-    });
-    
-    chart.data.datasets[0].data = measurements.map(m => m.rise);
-    chart.update();
-}
-
-function updateTable(measurements) {
-    const tbody = document.getElementById('tableBody');
-    tbody.innerHTML = '';
-    
-    measurements.forEach(m => {
-        const row = tbody.insertRow();
-        // Use 24hr format for time display
-        const timeStr = formatTime24h(m.timestamp);
-        row.innerHTML = `
-            <td>${timeStr}</td>
-            <td>${m.thickness} mm</td>
-            <td>${m.rise.toFixed(1)}%</td>
-        `;
-    });
-}
-
-function updateWifiStatus(status) {
-    const indicator = document.querySelector('.status-indicator');
-    const ipElement = document.getElementById('ipAddress');
-    const wifiContent = document.getElementById('wifiContent');
-    const wifiArrow = document.getElementById('wifiArrow');
-    
-    if (status.wifiConnected) {
-        indicator.classList.add('connected');
-        ipElement.textContent = 'IP: ' + status.ip;
-        
-        // Auto-collapse WiFi section when connected
-        if (wifiContent && wifiContent.classList.contains('expanded')) {
-            wifiContent.classList.remove('expanded');
-            wifiArrow.style.transform = 'rotate(0deg)';
-        }
-    } else {
-        indicator.classList.remove('connected');
-        ipElement.textContent = 'IP: Not connected';
-        
-        // Auto-expand WiFi section when disconnected
-        if (wifiContent && !wifiContent.classList.contains('expanded')) {
-            wifiContent.classList.add('expanded');
-            wifiArrow.style.transform = 'rotate(180deg)';
-        }
-    }
-}
-
-function updateCalibrationStatus(status) {
-    // Update initial thickness from calibration
-    const initialThicknessElement = document.getElementById('initialThickness');
-    if (initialThicknessElement) {
-        initialThicknessElement.textContent = status.initialThickness + ' mm';
-    }
-    
-    // Calculate and update elapsed time from calibration time
-    if (status.calibrationTime && status.calibrationTime > 0) {
-        // Set the global calibration time so chart can use it
-        calibrationTime = status.calibrationTime;
-        
-        const calibrationTimeSeconds = status.calibrationTime;
-        const now = Math.floor(Date.now() / 1000);
-        const elapsedSeconds = now - calibrationTimeSeconds;
-        
-        const hours = Math.floor(elapsedSeconds / 3600);
-        const minutes = Math.floor((elapsedSeconds % 3600) / 60);
-        
-        const elapsedTimeElement = document.getElementById('elapsedTime');
-        if (elapsedTimeElement) {
-            elapsedTimeElement.textContent = hours + ':' + String(minutes).padStart(2, '0');
-        }
-    }
-}
-
-function calibrateZero() {
-    showConfirmDialog(
-        'Calibrate Empty Container',
-        'Please place the empty container under the sensor, then click Confirm to calibrate.',
-        function() {
-            const btn = event.target;
-            setButtonLoading(btn, true);
-
-            fetch('/api/calibrate', { method: 'POST' })
-                .then(response => response.json())
-                .then(data => {
-                    showToast('Calibration set to: ' + data.zeroPoint + ' mm', 'success');
-                    updateStatus();
-                })
-                .catch(error => showToast('Error: ' + error, 'error'))
-                .finally(() => setButtonLoading(btn, false));
-        }
-    );
-}
-
-function calibrateDough() {
-    showConfirmDialog(
-        'Calibrate Fresh Starter',
-        'Please place the fresh dough/starter in the container, then click Confirm to set the initial thickness.',
-        function() {
-            const btn = event.target;
-            setButtonLoading(btn, true);
-
-            fetch('/api/calibrate-dough', { method: 'POST' })
-                .then(response => response.json())
-                .then(data => {
-                    showToast('Dough calibrated! Initial thickness: ' + data.initialThickness + ' mm', 'success');
-                    updateStatus();
-                })
-                .catch(error => showToast('Error: ' + error, 'error'))
-                .finally(() => setButtonLoading(btn, false));
-        }
-    );
-}
-
-function showOffsetDialog() {
-    document.getElementById('offsetDialog').style.display = 'flex';
-}
-
-function closeDialog() {
-    document.getElementById('offsetDialog').style.display = 'none';
-}
-
-function saveOffset() {
-    const offset = parseInt(document.getElementById('offsetInput').value) || 0;
-    const btn = event.target;
-    setButtonLoading(btn, true);
-
-    fetch('/api/offset', {
-        method: 'POST',
-        headers: { 'Content-Type': 'application/json' },
-        body: JSON.stringify({ offset: offset })
-    })
-    .then(response => response.json())
-    .then(data => {
-        showToast('Offset set to: ' + data.offset + ' mm', 'success');
-        closeDialog();
-        updateStatus();
-    })
-    .catch(error => showToast('Error: ' + error, 'error'))
-    .finally(() => setButtonLoading(btn, false));
-}
-
-function showResetDataDialog() {
-    showConfirmDialog(
-        'Reset Data',
-        'Delete all measurement data? This action cannot be undone.',
-        function() {
-            const btn = event.target;
-            setButtonLoading(btn, true);
-
-            fetch('/api/reset-data', { method: 'POST' })
-                .then(response => response.json())
-                .then(data => {
-                    showToast('Data reset complete', 'success');
-                    updateStatus();
-                })
-                .catch(error => showToast('Error: ' + error, 'error'))
-                .finally(() => setButtonLoading(btn, false));
-        }
-    );
-}
-
-function showResetWifiDialog() {
-    showConfirmDialog(
-        'Reset WiFi',
-        'Reset WiFi settings? The device will reboot and you will need to reconnect.',
-        function() {
-            const btn = event.target;
-            setButtonLoading(btn, true);
-
-            fetch('/api/reset-wifi', { method: 'POST' })
-                .then(response => response.json())
-                .then(data => {
-                    showToast('WiFi reset - device rebooting...', 'warning');
-                })
-                .catch(error => showToast('Error: ' + error, 'error'))
-                .finally(() => setButtonLoading(btn, false));
-        }
-    );
-}
-
-function scanNetworks() {
-    const scanStatus = document.getElementById('scanStatus');
-    const btn = event.target;
-
-    scanStatus.style.display = 'block';
-    scanStatus.textContent = 'Scanning...';
-    setButtonLoading(btn, true);
-
-    fetch('/api/scan-networks')
-        .then(response => response.json())
-        .then(data => {
-            const select = document.getElementById('networkSelect');
-            select.innerHTML = '<option value="">-- Select a network --</option>';
-
-            data.forEach(network => {
-                const option = document.createElement('option');
-                option.value = network.ssid;
-                option.textContent = network.ssid + ' (Signal: ' + network.rssi + ' dBm)';
-                select.appendChild(option);
-            });
-
-            scanStatus.textContent = 'Found ' + data.length + ' networks';
-            showToast('Found ' + data.length + ' WiFi networks', 'success');
-            setTimeout(() => { scanStatus.style.display = 'none'; }, 3000);
-        })
-        .catch(error => {
-            scanStatus.textContent = 'Error scanning networks';
-            showToast('Error scanning networks: ' + error, 'error');
-            setTimeout(() => { scanStatus.style.display = 'none'; }, 3000);
-        })
-        .finally(() => setButtonLoading(btn, false));
-}
-
-function connectToWiFi() {
-    const ssid = document.getElementById('networkSelect').value;
-    const password = document.getElementById('wifiPassword').value;
-    const connectStatus = document.getElementById('connectStatus');
-    const btn = event.target;
-
-    if (!ssid) {
-        showToast('Please select a network', 'warning');
-        return;
-    }
-
-    connectStatus.style.display = 'block';
-    connectStatus.textContent = 'Connecting to ' + ssid + '...';
-    setButtonLoading(btn, true);
-
-    fetch('/api/connect-wifi', {
-        method: 'POST',
-        headers: { 'Content-Type': 'application/json' },
-        body: JSON.stringify({ ssid: ssid, password: password })
-    })
-    .then(response => response.json())
-    .then(data => {
-        if (data.success) {
-            connectStatus.textContent = 'Successfully connected to ' + ssid + '! Device IP: ' + data.ip;
-            connectStatus.style.backgroundColor = '#c8e6c9';
-            showToast('Successfully connected to ' + ssid + '!', 'success');
-            setTimeout(() => {
-                connectStatus.style.display = 'none';
-                setTimeout(() => { location.reload(); }, 2000);
-            }, 3000);
-        } else {
-            connectStatus.textContent = 'Connection failed: ' + (data.error || 'Unknown error');
-            connectStatus.style.backgroundColor = '#ffcdd2';
-            showToast('Connection failed: ' + (data.error || 'Unknown error'), 'error');
-        }
-    })
-    .catch(error => {
-        connectStatus.textContent = 'Error: ' + error;
-        connectStatus.style.backgroundColor = '#ffcdd2';
-        showToast('Error: ' + error, 'error');
-    })
-    .finally(() => setButtonLoading(btn, false));
-}
-)rawliteral";
-}
+#include "WebPages.h"
+
+String WebPages::getIndexHTML() {
+  return R"rawliteral(
+<!DOCTYPE html>
+<html lang="en">
+<head>
+    <meta charset="UTF-8">
+    <meta name="viewport" content="width=device-width, initial-scale=1.0">
+    <title>Dough Tracker</title>
+    <script src="https://cdn.jsdelivr.net/npm/chart.js"></script>
+    <script src="https://cdn.jsdelivr.net/npm/hammerjs@2.0.8"></script>
+    <script src="https://cdn.jsdelivr.net/npm/chartjs-plugin-zoom@2.0.1/dist/chartjs-plugin-zoom.min.js"></script>
+    <style>
+)rawliteral" + getInlineCSS() + R"rawliteral(
+    </style>
+</head>
+<body>
+    <div class="container">
+        <header>
+            <h1>🍞 Dough Tracker</h1>
+            <div class="wifi-status">
+                <span id="wifiStatus" class="status-indicator"></span>
+                <span id="ipAddress">IP: --</span>
+            </div>
+        </header>
+
+        <main>
+            <!-- Status Section -->
+            <section class="status-section">
+                <div class="status-box">
+                    <h2 id="initialThickness">0 mm</h2>
+                    <p>Initial Thickness</p>
+                </div>
+                <div class="status-box">
+                    <h2 id="thickness">0 mm</h2>
+                    <p>Current Thickness</p>
+                </div>
+                <div class="status-box">
+                    <h2 id="risePercentage">0%</h2>
+                    <p>Current Rise</p>
+                </div>
+                <div class="status-box">
+                    <h2 id="elapsedTime">0:00</h2>
+                    <p>Elapsed Time</p>
+                </div>
+            </section>
+
+            <!-- Chart Section -->
+            <section class="chart-section">
+                <h2>Rise Progress</h2>
+                <p style="font-size: 12px; color: #7D6658; margin-bottom: 10px;">Scroll to zoom, Ctrl+drag to pan, double-click to reset</p>
+                <div class="chart-container">
+                    <canvas id="riseChart"></canvas>
+                </div>
+            </section>
+
+            <!-- Controls Section -->
+            <section class="controls-section">
+                <h2>Controls</h2>
+                <div class="button-grid">
+                    <button onclick="calibrateZero()" class="btn btn-primary">📏 Calibrate empty container</button>
+                    <button onclick="calibrateDough()" class="btn btn-primary">🍞 Calibrate fresh starter</button>
+                </div>
+                <div style="margin-top: 20px; padding-top: 15px; border-top: 1px solid #E6D5C3;">
+                    <h3 style="margin-bottom: 10px; font-size: 16px;">📦 Container Presets</h3>
+                    <div style="display: flex; gap: 8px; flex-wrap: wrap; align-items: center;">
+                        <select id="presetSelect" style="flex: 1; min-width: 150px; padding: 8px;">
+                            <option value="">-- Select --</option>
+                        </select>
+                        <button onclick="loadPreset()" class="btn btn-success">Load</button>
+                        <button onclick="delPreset()" class="btn btn-danger">Del</button>
+                    </div>
+                    <div style="display: flex; gap: 8px; margin-top: 10px; align-items: center;">
+                        <input type="text" id="presetName" placeholder="Preset name" maxlength="11" style="flex: 1; padding: 8px;">
+                        <button onclick="savePreset()" class="btn btn-primary">Save Current</button>
+                    </div>
+                </div>
+            </section>
+
+            <!-- Data Table -->
+            <section class="data-section">
+                <div class="collapsible-header" onclick="toggleSection('historyContent')">
+                    <h2>📊 Measurement History</h2>
+                    <span class="toggle-arrow" id="historyArrow">▼</span>
+                </div>
+                <div id="historyContent" class="collapsible-content">
+                    <div class="table-wrapper">
+                        <table id="dataTable">
+                            <thead>
+                                <tr>
+                                    <th>Time</th>
+                                    <th>Thickness (mm)</th>
+                                    <th>Rise (%)</th>
+                                </tr>
+                            </thead>
+                            <tbody id="tableBody">
+                            </tbody>
+                        </table>
+                    </div>
+                    <div style="margin-top: 15px;">
+                        <button onclick="showResetDataDialog()" class="btn btn-danger">🗑️ Reset Data</button>
+                    </div>
+                </div>
+            </section>
+
+            <!-- WiFi Configuration Section -->
+            <section class="wifi-config-section">
+                <div class="collapsible-header" onclick="toggleSection('wifiContent')">
+                    <h2>📡 WiFi Configuration</h2>
+                    <span class="toggle-arrow" id="wifiArrow">▼</span>
+                </div>
+                <div id="wifiContent" class="collapsible-content">
+                <div class="wifi-controls">
+                    <button onclick="scanNetworks()" class="btn btn-primary">Scan Networks</button>
+                    <div id="scanStatus" style="margin-top: 10px; display: none;">Scanning...</div>
+                </div>
+                <div id="networkList" style="margin-top: 15px;">
+                    <label for="networkSelect">Available Networks:</label>
+                    <select id="networkSelect" style="width: 100%; padding: 8px; margin-top: 8px;">
+                        <option value="">-- Select a network --</option>
+                    </select>
+                </div>
+                <div style="margin-top: 15px;">
+                    <label for="wifiPassword">Password:</label>
+                    <input type="password" id="wifiPassword" placeholder="Enter WiFi password" style="width: 100%; padding: 8px; margin-top: 8px;">
+                </div>
+                <div style="margin-top: 15px;">
+                    <button onclick="connectToWiFi()" class="btn btn-success">Connect</button>
+                    <div id="connectStatus" style="margin-top: 10px; display: none; padding: 10px; background: #e3f2fd; border-radius: 6px;"></div>
+                </div>
+                <div style="margin-top: 15px; padding-top: 15px; border-top: 1px solid #E6D5C3;">
+                    <button onclick="showResetWifiDialog()" class="btn btn-warning">🔌 Reset WiFi</button>
+                </div>
+                </div>
+            </section>
+
+            <!-- Notification Configuration Section -->
+            <section class="webhook-config-section">
+                <div class="collapsible-header" onclick="toggleSection('webhookContent')">
+                    <h2>🔔 Notifications</h2>
+                    <span class="toggle-arrow" id="webhookArrow">▼</span>
+                </div>
+                <div id="webhookContent" class="collapsible-content">
+                    <div class="webhook-info" style="margin-bottom: 15px; padding: 15px; background: #E3F2FD; border-radius: 8px; font-size: 14px;">
+                        <p style="margin-bottom: 8px;"><strong>Get notified when your dough reaches:</strong></p>
+                        <div id="thresholdList"></div>
+                        <button onclick="addThresholdRow()" class="btn btn-secondary" style="margin-top: 8px;">➕ Add threshold</button>
+                        <p style="font-size: 12px; color: #666; margin-top: 5px;">
+                            Falling thresholds fire when the rise drops back to the value (e.g. the dough collapsing).
+                            <code>{threshold}</code> and <code>{rise}</code> in a message are replaced with the values.
+                        </p>
+                    </div>
+
+                    <div class="webhook-status" style="margin-bottom: 15px; padding: 10px; background: #f5f5f5; border-radius: 6px;">
+                        <div style="display: flex; justify-content: space-between; align-items: center;">
+                            <span>Status:</span>
+                            <span id="webhookStatus" style="font-weight: bold;">Not configured</span>
+                        </div>
+                        <div id="webhookThresholds" style="margin-top: 10px; font-size: 13px; display: none;"></div>
+                    </div>
+
+                    <div style="margin-top: 15px;">
+                        <label>Send notifications to:</label>
+                        <div id="targetList" style="margin-top: 8px;"></div>
+                        <button onclick="addTargetRow()" class="btn btn-secondary">➕ Add target</button>
+                        <p style="font-size: 12px; color: #666; margin-top: 5px;">
+                            Discord: Server Settings → Integrations → Webhooks. ntfy: the topic URL.
+                            Home Assistant: a webhook trigger URL, or a notify service URL with a long-lived token.
+                            JSON templates can use <code>{message}</code>, <code>{event}</code>, <code>{rise}</code>,
+                            <code>{threshold}</code> and <code>{time}</code>.
+                        </p>
+                    </div>
+
+                    <div style="margin-top: 15px;">
+                        <label style="display: flex; align-items: center; gap: 8px; cursor: pointer;">
+                            <input type="checkbox" id="webhookEnabled" checked>
+                            <span>Enable notifications</span>
+                        </label>
+                    </div>
+
+                    <div style="margin-top: 15px;">
+                        <label style="display: flex; align-items: center; gap: 8px; cursor: pointer;">
+                            <input type="checkbox" id="webhookHeadsUp">
+                            <span>Heads-up</span>
+                            <input type="number" id="webhookHeadsUpMinutes" min="1" max="240" value="20"
+                                   style="width: 60px; padding: 4px;">
+                            <span>min before a threshold is predicted</span>
+                        </label>
+                    </div>
+
+                    <div style="margin-top: 15px;">
+                        <label style="display: flex; align-items: center; gap: 8px;">
+                            <span>Combine notifications within</span>
+                            <input type="number" id="webhookDigestWindow" min="0" max="3600" value="0"
+                                   style="width: 70px; padding: 4px;">
+                            <span>s into one digest</span>
+                        </label>
+                        <p style="font-size: 12px; color: #666; margin-top: 5px;">
+                            With 0, only notifications that are already waiting (several thresholds at once,
+                            or a backlog after an outage) are combined.
+                        </p>
+                    </div>
+
+                    <div style="margin-top: 15px; display: flex; gap: 10px;">
+                        <button onclick="saveWebhook()" class="btn btn-primary">💾 Save Webhook</button>
+                        <button onclick="testWebhook()" class="btn btn-secondary" id="testWebhookBtn">🧪 Test</button>
+                    </div>
+                </div>
+            </section>
+        </main>
+
+        <footer>
+            <p>Sourdough Tracker v1.0 | Last update: <span id="lastUpdate">--:--:--</span></p>
+        </footer>
+    </div>
+
+    <!-- Offset Dialog -->
+    <div id="offsetDialog" class="dialog" style="display: none;">
+        <div class="dialog-content">
+            <h3>Set Measurement Offset</h3>
+            <p>Enter offset value in millimeters:</p>
+            <input type="number" id="offsetInput" placeholder="0" min="-50" max="50">
+            <div class="dialog-buttons">
+                <button onclick="saveOffset()" class="btn btn-primary">Save</button>
+                <button onclick="closeDialog()" class="btn btn-secondary">Cancel</button>
+            </div>
+        </div>
+    </div>
+
+    <!-- Confirmation Dialog -->
+    <div id="confirmDialog" class="dialog" style="display: none;">
+        <div class="dialog-content">
+            <h3 id="confirmTitle">Confirm Action</h3>
+            <p id="confirmMessage">Are you sure?</p>
+            <div class="dialog-buttons">
+                <button id="confirmYes" class="btn btn-primary">Confirm</button>
+                <button onclick="closeConfirmDialog()" class="btn btn-secondary">Cancel</button>
+            </div>
+        </div>
+    </div>
+
+    <script>
+)rawliteral" + getInlineJavaScript() + R"rawliteral(
+    </script>
+</body>
+</html>
+)rawliteral";
+}
+
+String WebPages::getInlineCSS() {
+  return R"rawliteral(
+* {
+    margin: 0;
+    padding: 0;
+    box-sizing: border-box;
+}
+
+body {
+    font-family: Georgia, Palatino, serif;
+    background: linear-gradient(135deg, #FAF3E0 0%, #EBD9C5 100%);
+    min-height: 100vh;
+    color: #3E2723;
+}
+
+.container {
+    max-width: 1000px;
+    margin: 0 auto;
+    padding: 20px;
+}
+
+header {
+    background: white;
+    border-radius: 14px;
+    padding: 20px;
+    margin-bottom: 20px;
+    box-shadow: 0 4px 12px rgba(139, 94, 60, 0.15);
+    display: flex;
+    justify-content: space-between;
+    align-items: center;
+}
+
+header h1 {
+    font-size: 28px;
+    color: #3E2723;
+}
+
+.wifi-status {
+    display: flex;
+    align-items: center;
+    gap: 10px;
+    font-size: 14px;
+}
+
+.status-indicator {
+    width: 12px;
+    height: 12px;
+    border-radius: 50%;
+    background: #ff6b6b;
+    display: inline-block;
+}
+
+.status-indicator.connected {
+    background: #51cf66;
+}
+
+main {
+    display: grid;
+    gap: 20px;
+}
+
+section {
+    background: #FFFAF5;
+    border-radius: 14px;
+    padding: 20px;
+    box-shadow: 0 4px 12px rgba(139, 94, 60, 0.12);
+}
+
+section h2 {
+    margin-bottom: 15px;
+    color: #3E2723;
+    font-size: 20px;
+}
+
+.status-section {
+    display: grid;
+    grid-template-columns: repeat(auto-fit, minmax(150px, 1fr));
+    gap: 15px;
+}
+
+.status-box {
+    text-align: center;
+    padding: 20px;
+    background: linear-gradient(135deg, #E8956B 0%, #D4A574 100%);
+    color: #FAF3E0;
+    border-radius: 14px;
+    transition: all 0.3s cubic-bezier(0.25, 0.46, 0.45, 0.94);
+}
+
+.status-box:hover {
+    transform: translateY(-4px) scale(1.03);
+    box-shadow: 0 6px 16px rgba(198, 110, 78, 0.25);
+}
+
+.status-box h2 {
+    font-size: 32px;
+    margin-bottom: 10px;
+    color: #FAF3E0;
+    transition: all 0.5s cubic-bezier(0.25, 0.46, 0.45, 0.94);
+}
+
+.status-box p {
+    font-size: 14px;
+    opacity: 0.95;
+}
+
+.chart-container {
+    position: relative;
+    height: 300px;
+}
+
+.table-wrapper {
+    overflow-x: auto;
+}
+
+table {
+    width: 100%;
+    border-collapse: collapse;
+}
+
+thead {
+    background: #F5EFE6;
+}
+
+th {
+    padding: 12px;
+    text-align: left;
+    font-weight: 600;
+    border-bottom: 2px solid #E6D5C3;
+    color: #3E2723;
+}
+
+td {
+    padding: 10px 12px;
+    border-bottom: 1px solid #F0E8DC;
+    color: #5D4037;
+}
+
+tr:hover {
+    background: #FAF3E0;
+}
+
+.controls-section {
+    background: #F5EFE6;
+}
+
+.button-grid {
+    display: grid;
+    grid-template-columns: repeat(auto-fit, minmax(150px, 1fr));
+    gap: 10px;
+}
+
+.btn {
+    padding: 12px 16px;
+    border: none;
+    border-radius: 10px;
+    font-size: 14px;
+    font-weight: 600;
+    cursor: pointer;
+    font-family: 'Trebuchet MS', Tahoma, sans-serif;
+    transition: all 0.3s cubic-bezier(0.25, 0.46, 0.45, 0.94);
+}
+
+.btn:hover {
+    transform: translateY(-3px) scale(1.02);
+    box-shadow: 0 6px 16px rgba(198, 110, 78, 0.20);
+}
+
+.btn:active {
+    transform: translateY(1px) scale(0.98);
+    box-shadow: inset 0 2px 4px rgba(139, 94, 60, 0.2);
+}
+
+.btn-primary {
+    background: #C66E4E;
+    color: white;
+}
+
+.btn-primary:hover {
+    background: #B45F43;
+}
+
+.btn-success {
+    background: #8B9D6F;
+    color: white;
+}
+
+.btn-success:hover {
+    background: #7A8B60;
+}
+
+.btn-secondary {
+    background: #9C8275;
+    color: white;
+}
+
+.btn-secondary:hover {
+    background: #8A7366;
+}
+
+.btn-danger {
+    background: #BA4727;
+    color: white;
+}
+
+.btn-danger:hover {
+    background: #A33C1F;
+}
+
+.btn-warning {
+    background: #E6B87D;
+    color: #3E2723;
+}
+
+.btn-warning:hover {
+    background: #D4A574;
+}
+
+footer {
+    text-align: center;
+    padding: 20px;
+    color: #7D6658;
+    font-size: 12px;
+}
+
+.dialog {
+    position: fixed;
+    top: 0;
+    left: 0;
+    right: 0;
+    bottom: 0;
+    background: rgba(139, 94, 60, 0.5);
+    display: flex;
+    align-items: center;
+    justify-content: center;
+    z-index: 1000;
+}
+
+.dialog-content {
+    background: #FFFAF5;
+    border-radius: 14px;
+    padding: 30px;
+    box-shadow: 0 10px 40px rgba(139, 94, 60, 0.3);
+    max-width: 400px;
+}
+
+.dialog-content h3 {
+    margin-bottom: 15px;
+    color: #3E2723;
+}
+
+.dialog-content input {
+    width: 100%;
+    padding: 10px;
+    margin: 15px 0;
+    border: 2px solid #E6D5C3;
+    border-radius: 8px;
+    font-size: 16px;
+    font-family: Georgia, Palatino, serif;
+    background: white;
+    color: #3E2723;
+}
+
+.dialog-content input:focus {
+    outline: none;
+    border-color: #C66E4E;
+}
+
+.dialog-buttons {
+    display: flex;
+    gap: 10px;
+    margin-top: 20px;
+}
+
+.dialog-buttons button {
+    flex: 1;
+}
+
+.collapsible-header {
+    display: flex;
+    justify-content: space-between;
+    align-items: center;
+    cursor: pointer;
+    user-select: none;
+    margin: -20px -20px 0 -20px;
+    padding: 20px;
+    border-bottom: 1px solid #eee;
+}
+
+.collapsible-header h2 {
+    margin: 0;
+}
+
+.toggle-arrow {
+    font-size: 12px;
+    transition: transform 0.3s ease;
+    color: #999999;
+}
+
+.collapsible-content {
+    display: none;
+    animation: slideDown 0.3s ease;
+}
+
+.collapsible-content.expanded {
+    display: block;
+}
+
+@keyframes slideDown {
+    from {
+        opacity: 0;
+        max-height: 0;
+    }
+    to {
+        opacity: 1;
+        max-height: 1000px;
+    }
+}
+
+.wifi-content-expanded {
+    display: block;
+}
+
+/* Toast Notification System */
+.toast-container {
+    position: fixed;
+    top: 20px;
+    right: 20px;
+    z-index: 9999;
+    display: flex;
+    flex-direction: column;
+    gap: 10px;
+}
+
+.toast {
+    background: white;
+    border-left: 4px solid #C66E4E;
+    border-radius: 10px;
+    padding: 16px 20px;
+    box-shadow: 0 4px 12px rgba(139, 94, 60, 0.25);
+    min-width: 300px;
+    max-width: 400px;
+    display: flex;
+    align-items: center;
+    gap: 12px;
+    animation: slideInRight 0.3s ease;
+    font-family: 'Trebuchet MS', Tahoma, sans-serif;
+}
+
+.toast.success { border-left-color: #8B9D6F; }
+.toast.error { border-left-color: #BA4727; }
+.toast.warning { border-left-color: #E6B87D; }
+
+.toast-icon {
+    font-size: 20px;
+    flex-shrink: 0;
+}
+
+.toast-message {
+    flex: 1;
+    color: #3E2723;
+    font-size: 14px;
+}
+
+@keyframes slideInRight {
+    from {
+        transform: translateX(400px);
+        opacity: 0;
+    }
+    to {
+        transform: translateX(0);
+        opacity: 1;
+    }
+}
+
+@keyframes fadeOut {
+    to {
+        opacity: 0;
+        transform: translateX(400px);
+    }
+}
+
+/* Button Loading States */
+.btn.loading {
+    position: relative;
+    pointer-events: none;
+    opacity: 0.7;
+}
+
+.btn.loading::after {
+    content: '';
+    position: absolute;
+    width: 16px;
+    height: 16px;
+    top: 50%;
+    left: 50%;
+    margin-left: -8px;
+    margin-top: -8px;
+    border: 2px solid white;
+    border-radius: 50%;
+    border-top-color: transparent;
+    animation: spin 0.6s linear infinite;
+}
+
+@keyframes spin {
+    to { transform: rotate(360deg); }
+}
+
+/* Status Box Pulse Animation */
+.status-box.updated {
+    animation: pulse-warm 0.6s ease;
+}
+
+@keyframes pulse-warm {
+    0%, 100% {
+        transform: scale(1);
+        box-shadow: 0 4px 8px rgba(139, 94, 60, 0.15);
+    }
+    50% {
+        transform: scale(1.05);
+        box-shadow: 0 6px 20px rgba(198, 110, 78, 0.3);
+    }
+}
+
+@media (max-width: 600px) {
+    header {
+        flex-direction: column;
+        gap: 15px;
+    }
+
+    .button-grid {
+        grid-template-columns: 1fr;
+    }
+
+    .toast {
+        min-width: 250px;
+        max-width: calc(100vw - 40px);
+    }
+}
+)rawliteral";
+}
+
+String WebPages::getInlineJavaScript() {
+  return R"rawliteral(
+let chart = null;
+let autoRefreshInterval = null;
+let calibrationTime = 0;  // Store calibration timestamp globally
+let overviewMeasurements = [];  // Whole history at chart resolution
+let zoomWindow = null;  // Detailed points for the zoomed-in range: {from, to, measurements}
+let zoomTimer = null;
+const windowCache = new Map();  // "from-to" -> measurements
+const WINDOW_CACHE_SIZE = 16;
+
+// Toggle section visibility
+function toggleSection(contentId) {
+    const content = document.getElementById(contentId);
+    const arrow = document.getElementById(contentId === 'historyContent' ? 'historyArrow' : 'wifiArrow');
+    
+    if (content.classList.contains('expanded')) {
+        content.classList.remove('expanded');
+        arrow.style.transform = 'rotate(0deg)';
+    } else {
+        content.classList.add('expanded');
+        arrow.style.transform = 'rotate(180deg)';
+    }
+}
+
+// Webhook configuration functions
+let thresholdsEdited = false;  // Keep unsaved edits across refreshes
+let maxThresholds = 16;
+
+function addThresholdRow(threshold) {
+    const list = document.getElementById('thresholdList');
+    if (list.children.length >= maxThresholds) {
+        showToast('At most ' + maxThresholds + ' thresholds', 'warning');
+        return;
+    }
+    const t = threshold || { rise: 150, falling: false, message: 'Your dough has risen {rise}%' };
+    const row = document.createElement('div');
+    row.className = 'threshold-row';
+    row.style.cssText = 'display: flex; gap: 6px; align-items: center; margin-bottom: 6px;';
+
+    const rise = document.createElement('input');
+    rise.type = 'number';
+    rise.min = -100;
+    rise.max = 10000;
+    rise.value = Math.round(t.rise);
+    rise.style.cssText = 'width: 70px; padding: 4px;';
+    rise.className = 'threshold-rise';
+
+    const fallingLabel = document.createElement('label');
+    fallingLabel.style.cssText = 'display: flex; align-items: center; gap: 4px; font-size: 12px;';
+    const falling = document.createElement('input');
+    falling.type = 'checkbox';
+    falling.checked = t.falling;
+    falling.className = 'threshold-falling';
+    fallingLabel.appendChild(document.createTextNode('%'));
+    fallingLabel.appendChild(falling);
+    fallingLabel.appendChild(document.createTextNode('falling'));
+
+    const message = document.createElement('input');
+    message.type = 'text';
+    message.maxLength = 95;
+    message.value = t.message;
+    message.style.cssText = 'flex: 1; padding: 4px; font-size: 12px;';
+    message.className = 'threshold-message';
+
+    const remove = document.createElement('button');
+    remove.className = 'btn btn-danger';
+    remove.textContent = '✕';
+    remove.onclick = () => { row.remove(); thresholdsEdited = true; };
+
+    row.append(rise, fallingLabel, message, remove);
+    row.addEventListener('input', () => { thresholdsEdited = true; });
+    list.appendChild(row);
+    if (!threshold) thresholdsEdited = true;
+}
+
+let targetsEdited = false;
+let maxTargets = 4;
+const TARGET_FORMATS = { discord: 'Discord', ntfy: 'ntfy', json: 'JSON', homeassistant: 'Home Assistant' };
+
+function addTargetRow(target) {
+    const list = document.getElementById('targetList');
+    if (list.children.length >= maxTargets) {
+        showToast('At most ' + maxTargets + ' targets', 'warning');
+        return;
+    }
+    const t = target || { name: '', format: 'discord', url: '', enabled: true, hasToken: false, template: '' };
+    const row = document.createElement('div');
+    row.className = 'target-row';
+    row.style.cssText = 'padding: 8px; margin-bottom: 8px; background: #f5f5f5; border-radius: 6px;';
+
+    const line = document.createElement('div');
+    line.style.cssText = 'display: flex; gap: 6px; align-items: center;';
+    const enabled = document.createElement('input');
+    enabled.type = 'checkbox';
+    enabled.checked = t.enabled;
+    enabled.className = 'target-enabled';
+    const name = document.createElement('input');
+    name.type = 'text';
+    name.maxLength = 23;
+    name.placeholder = 'Name';
+    name.value = t.name;
+    name.className = 'target-name';
+    name.style.cssText = 'width: 90px; padding: 4px;';
+    const format = document.createElement('select');
+    format.className = 'target-format';
+    Object.keys(TARGET_FORMATS).forEach(key => {
+        const opt = document.createElement('option');
+        opt.value = key;
+        opt.textContent = TARGET_FORMATS[key];
+        format.appendChild(opt);
+    });
+    format.value = t.format;
+    const remove = document.createElement('button');
+    remove.className = 'btn btn-danger';
+    remove.textContent = '✕';
+    remove.onclick = () => { row.remove(); targetsEdited = true; };
+    line.append(enabled, name, format, remove);
+
+    const url = document.createElement('input');
+    url.type = 'text';
+    url.placeholder = 'https://...';
+    url.value = t.url;
+    url.className = 'target-url';
+    url.style.cssText = 'width: 100%; padding: 6px; margin-top: 6px; font-family: monospace; font-size: 12px;';
+
+    const token = document.createElement('input');
+    token.type = 'password';
+    token.placeholder = t.hasToken ? 'Token set (leave empty to keep)' : 'Bearer token (optional)';
+    token.className = 'target-token';
+    token.style.cssText = 'width: 100%; padding: 6px; margin-top: 6px; font-size: 12px;';
+
+    const template = document.createElement('textarea');
+    template.placeholder = 'JSON body template (empty for the default)';
+    template.maxLength = 191;
+    template.value = t.template || '';
+    template.className = 'target-template';
+    template.style.cssText = 'width: 100%; padding: 6px; margin-top: 6px; font-family: monospace; font-size: 12px;';
+    const showTemplate = () => { template.style.display = format.value === 'json' ? 'block' : 'none'; };
+    format.addEventListener('change', showTemplate);
+    showTemplate();
+
+    const stats = document.createElement('div');
+    stats.className = 'target-stats';
+    stats.style.cssText = 'font-size: 12px; color: #666; margin-top: 4px;';
+    if (t.stats && (t.stats.sent || t.stats.failed)) {
+        stats.textContent = t.stats.sent + ' sent, ' + t.stats.failed + ' failed, last HTTP ' +
+            t.stats.lastStatus + ' in ' + t.stats.lastMs + ' ms (avg ' + t.stats.avgMs +
+            ', max ' + t.stats.maxMs + ' ms)';
+    }
+
+    row.append(line, url, token, template, stats);
+    row.addEventListener('input', () => { targetsEdited = true; });
+    list.appendChild(row);
+    if (!target) targetsEdited = true;
+}
+
+function readTargetRows() {
+    const rows = document.querySelectorAll('#targetList .target-row');
+    return Array.from(rows).map(row => {
+        const target = {
+            name: row.querySelector('.target-name').value.trim(),
+            format: row.querySelector('.target-format').value,
+            url: row.querySelector('.target-url').value.trim(),
+            enabled: row.querySelector('.target-enabled').checked,
+            template: row.querySelector('.target-template').value.trim()
+        };
+        // Only send a token when one was typed; the device keeps the old one
+        const token = row.querySelector('.target-token').value;
+        if (token) target.token = token;
+        return target;
+    });
+}
+
+function readThresholdRows() {
+    const rows = document.querySelectorAll('#thresholdList .threshold-row');
+    return Array.from(rows).map(row => ({
+        rise: parseInt(row.querySelector('.threshold-rise').value, 10),
+        falling: row.querySelector('.threshold-falling').checked,
+        message: row.querySelector('.threshold-message').value.trim()
+    }));
+}
+
+function saveWebhook() {
+    const enabled = document.getElementById('webhookEnabled').checked;
+
+    const targets = readTargetRows();
+    const names = new Set(targets.map(t => t.name));
+    if (targets.some(t => !t.name || !/^https?:\/\//.test(t.url)) || names.size !== targets.length) {
+        showToast('Each target needs a unique name and an http(s) URL', 'error');
+        return;
+    }
+
+    const thresholds = readThresholdRows();
+    if (thresholds.some(t => isNaN(t.rise) || t.rise < -100 || t.rise > 10000 || !t.message)) {
+        showToast('Each threshold needs a rise and a message', 'error');
+        return;
+    }
+
+    const data = {
+        targets: targets,
+        enabled: enabled,
+        headsUp: document.getElementById('webhookHeadsUp').checked,
+        headsUpMinutes: parseInt(document.getElementById('webhookHeadsUpMinutes').value, 10) || 20,
+        digestWindow: Math.min(3600, Math.max(0, parseInt(document.getElementById('webhookDigestWindow').value, 10) || 0)),
+        thresholds: thresholds
+    };
+
+    fetch('/api/webhook', {
+        method: 'POST',
+        headers: { 'Content-Type': 'application/json' },
+        body: JSON.stringify(data)
+    })
+    .then(response => response.json())
+    .then(data => {
+        if (data.success) {
+            showToast('Webhook settings saved!', 'success');
+            thresholdsEdited = false;
+            targetsEdited = false;
+            updateWebhookStatus();
+        } else {
+            showToast('Failed to save webhook', 'error');
+        }
+    })
+    .catch(error => {
+        console.error('Error saving webhook:', error);
+        showToast('Error saving webhook', 'error');
+    });
+}
+
+function testWebhook() {
+    const btn = document.getElementById('testWebhookBtn');
+    setButtonLoading(btn, true);
+
+    fetch('/api/test-webhook', { method: 'POST' })
+        .then(response => response.json())
+        .then(data => {
+            setButtonLoading(btn, false);
+            const total = (data.targets || []).filter(t => t.enabled).length;
+            if (data.success && data.accepted === total) {
+                showToast('Test notification sent to ' + total + ' target(s)!', 'success');
+            } else if (data.success) {
+                showToast('Test sent to ' + data.accepted + ' of ' + total + ' targets', 'warning');
+            } else {
+                showToast(data.error || 'Test failed', 'error');
+            }
+            updateWebhookStatus();
+        })
+        .catch(error => {
+            setButtonLoading(btn, false);
+            console.error('Error testing webhook:', error);
+            showToast('Error sending test', 'error');
+        });
+}
+
+function updateWebhookStatus() {
+    fetch('/api/webhook')
+        .then(response => response.json())
+        .then(applyWebhookStatus)
+        .catch(error => {
+            console.error('Error fetching webhook status:', error);
+        });
+}
+
+function applyWebhookStatus(data) {
+    const statusEl = document.getElementById('webhookStatus');
+    const enabledCheckbox = document.getElementById('webhookEnabled');
+    const thresholdsDiv = document.getElementById('webhookThresholds');
+
+    maxTargets = data.maxTargets || maxTargets;
+    if (!targetsEdited) {
+        document.getElementById('targetList').innerHTML = '';
+        data.targets.forEach(t => addTargetRow(t));
+    }
+    enabledCheckbox.checked = data.enabled;
+    document.getElementById('webhookHeadsUp').checked = data.headsUp;
+    document.getElementById('webhookHeadsUpMinutes').value = data.headsUpMinutes;
+    document.getElementById('webhookDigestWindow').value = data.digestWindow;
+    maxThresholds = data.maxThresholds || maxThresholds;
+    if (!thresholdsEdited) {
+        document.getElementById('thresholdList').innerHTML = '';
+        data.thresholds.forEach(t => addThresholdRow(t));
+    }
+
+    if (data.configured && data.enabled) {
+        statusEl.textContent = 'Active ✓';
+        statusEl.style.color = '#51cf66';
+
+        // Show threshold status
+        thresholdsDiv.style.display = 'block';
+        thresholdsDiv.innerHTML = '';
+        // Reached thresholds still in the outbox are waiting for delivery
+        const queued = (data.outbox || []).filter(e => e.event === 'threshold');
+        data.thresholds.forEach(t => {
+            const waiting = queued.find(e => e.threshold === t.rise && e.falling === t.falling);
+            const state = !t.reached ? '(pending)' :
+                waiting ? '(queued for ' + waiting.pending.join(', ') + ')' : '(sent)';
+            const line = document.createElement('div');
+            line.textContent = (t.reached ? '✓ ' : '○ ') + (t.falling ? '↓ ' : '') +
+                Math.round(t.rise) + '% ' + state;
+            thresholdsDiv.appendChild(line);
+        });
+    } else if (data.configured && !data.enabled) {
+        statusEl.textContent = 'Configured (disabled)';
+        statusEl.style.color = '#ff8c00';
+        thresholdsDiv.style.display = 'none';
+    } else {
+        statusEl.textContent = 'Not configured';
+        statusEl.style.color = '#999';
+        thresholdsDiv.style.display = 'none';
+    }
+}
+
+// Container preset functions
+function loadPresets() {
+    fetch('/api/presets')
+        .then(response => response.json())
+        .then(data => applyPresets(data.presets))
+        .catch(error => console.error('Error loading presets:', error));
+}
+
+function applyPresets(presets) {
+    const select = document.getElementById('presetSelect');
+    const selected = select.value;  // Keep the choice across refreshes
+    select.innerHTML = '<option value="">-- Select --</option>';
+    presets.forEach((p, i) => {
+        const opt = document.createElement('option');
+        opt.value = i;
+        opt.textContent = p.n + ' (' + p.z + 'mm)';
+        select.appendChild(opt);
+    });
+    if (selected !== '' && selected < presets.length) select.value = selected;
+}
+
+// About one point per pixel of chart width: the device downsamples longer
+// series so the phone does not have to
+function chartPointBudget() {
+    const canvas = document.getElementById('riseChart');
+    const width = canvas ? canvas.clientWidth : 0;
+    return Math.max(50, Math.round(width || 400));
+}
+
+// Everything the page shows, fetched in one request. The device serves one
+// connection at a time, so this avoids queueing several round trips on
+// first paint and on each refresh.
+function bootstrap() {
+    fetch('/api/bootstrap?maxPoints=' + chartPointBudget())
+        .then(response => response.json())
+        .then(data => {
+            // Calibration time first: the chart's elapsed-time axis uses it
+            updateWifiStatus(data.status);
+            updateCalibrationStatus(data.status);
+            updateUI(data);
+            applyWebhookStatus(data.webhook);
+            applyPresets(data.presets);
+        })
+        .catch(error => {
+            console.error('Error fetching bootstrap data:', error);
+        });
+}
+
+function loadPreset() {
+    const idx = document.getElementById('presetSelect').value;
+    if (idx === '') { showToast('Select a preset first', 'warning'); return; }
+
+    fetch('/api/presets', {
+        method: 'DELETE',
+        headers: { 'Content-Type': 'application/json' },
+        body: JSON.stringify({ i: parseInt(idx), a: 'l' })
+    })
+    .then(response => response.json())
+    .then(data => {
+        if (data.ok) {
+            showToast('Preset loaded!', 'success');
+            updateStatus();
+        } else {
+            showToast(data.e || 'Load failed', 'error');
+        }
+    })
+    .catch(error => showToast('Error: ' + error, 'error'));
+}
+
+function delPreset() {
+    const idx = document.getElementById('presetSelect').value;
+    if (idx === '') { showToast('Select a preset first', 'warning'); return; }
+
+    showConfirmDialog('Delete Preset', 'Delete this preset?', function() {
+        fetch('/api/presets', {
+            method: 'DELETE',
+            headers: { 'Content-Type': 'application/json' },
+            body: JSON.stringify({ i: parseInt(idx), a: 'd' })
+        })
+        .then(response => response.json())
+        .then(data => {
+            if (data.ok) {
+                showToast('Preset deleted', 'success');
+                loadPresets();
+            } else {
+                showToast(data.e || 'Delete failed', 'error');
+            }
+        })
+        .catch(error => showToast('Error: ' + error, 'error'));
+    });
+}
+
+function savePreset() {
+    const name = document.getElementById('presetName').value.trim();
+    if (!name) { showToast('Enter a name', 'warning'); return; }
+
+    fetch('/api/presets', {
+        method: 'POST',
+        headers: { 'Content-Type': 'application/json' },
+        body: JSON.stringify({ n: name })
+    })
+    .then(response => response.json())
+    .then(data => {
+        if (data.ok) {
+            showToast('Preset saved!', 'success');
+            document.getElementById('presetName').value = '';
+            loadPresets();
+        } else {
+            showToast(data.e || 'Save failed', 'error');
+        }
+    })
+    .catch(error => showToast('Error: ' + error, 'error'));
+}
+
+// Initialize on page load
+document.addEventListener('DOMContentLoaded', function() {
+    initializeChart();
+    bootstrap();
+    autoRefreshInterval = setInterval(bootstrap, 30000); // Update every 30 seconds
+});
+
+function initializeChart() {
+    const ctx = document.getElementById('riseChart');
+    if (!ctx) return;
+    
+    chart = new Chart(ctx, {
+        type: 'line',
+        data: {
+            datasets: [{
+                label: 'Dough Rise (%)',
+                data: [],
+                borderColor: '#C66E4E',
+                backgroundColor: 'rgba(198, 110, 78, 0.1)',
+                tension: 0.3,
+                fill: true,
+                pointBackgroundColor: '#C66E4E',
+                pointBorderColor: '#FAF3E0',
+                pointBorderWidth: 2,
+                pointRadius: 2.5,
+                pointHoverRadius: 4
+            }]
+        },
+        options: {
+            responsive: true,
+            maintainAspectRatio: false,
+            plugins: {
+                legend: {
+                    display: true,
+                    position: 'top'
+                },
+                zoom: {
+                    pan: {
+                        enabled: true,
+                        mode: 'x',
+                        modifierKey: 'ctrl',
+                        onPanComplete: scheduleWindowLoad
+                    },
+                    zoom: {
+                        wheel: {
+                            enabled: true,
+                            speed: 0.1
+                        },
+                        pinch: {
+                            enabled: true
+                        },
+                        mode: 'x',
+                        onZoomComplete: scheduleWindowLoad
+                    },
+                    limits: {
+                        x: {min: 'original', max: 'original'}
+                    }
+                },
+                tooltip: {
+                    callbacks: {
+                        title: items => items.length ? formatChartTime(items[0].parsed.x).join(' ') : ''
+                    }
+                }
+            },
+            scales: {
+                x: {
+                    type: 'linear',
+                    ticks: {
+                        maxRotation: 0,
+                        callback: value => formatChartTime(value)
+                    }
+                },
+                y: {
+                    beginAtZero: true,
+                    title: {
+                        display: true,
+                        text: 'Rise Percentage (%)'
+                    }
+                }
+            }
+        }
+    });
+
+    // Add double-click to reset zoom
+    ctx.ondblclick = function() {
+        chart.resetZoom();
+        zoomWindow = null;
+        renderChart();
+    };
+}
+
+// Toast notification system
+function showToast(message, type = 'info') {
+    let container = document.querySelector('.toast-container');
+    if (!container) {
+        container = document.createElement('div');
+        container.className = 'toast-container';
+        document.body.appendChild(container);
+    }
+
+    const icons = {
+        success: '✓',
+        error: '✗',
+        warning: '⚠',
+        info: 'ℹ'
+    };
+
+    const toast = document.createElement('div');
+    toast.className = `toast ${type}`;
+    toast.innerHTML = `
+        <span class="toast-icon">${icons[type] || icons.info}</span>
+        <span class="toast-message">${message}</span>
+    `;
+
+    container.appendChild(toast);
+
+    setTimeout(() => {
+        toast.style.animation = 'fadeOut 0.3s ease forwards';
+        setTimeout(() => toast.remove(), 300);
+    }, 3000);
+}
+
+// Button loading state helpers
+function setButtonLoading(button, loading) {
+    if (loading) {
+        button.classList.add('loading');
+        button.disabled = true;
+    } else {
+        button.classList.remove('loading');
+        button.disabled = false;
+    }
+}
+
+// Custom confirmation dialog
+function showConfirmDialog(title, message, onConfirm) {
+    document.getElementById('confirmTitle').textContent = title;
+    document.getElementById('confirmMessage').textContent = message;
+    document.getElementById('confirmDialog').style.display = 'flex';
+
+    // Remove old listeners and add new one
+    const yesBtn = document.getElementById('confirmYes');
+    const newYesBtn = yesBtn.cloneNode(true);
+    yesBtn.parentNode.replaceChild(newYesBtn, yesBtn);
+
+    newYesBtn.onclick = function() {
+        closeConfirmDialog();
+        onConfirm();
+    };
+}
+
+function closeConfirmDialog() {
+    document.getElementById('confirmDialog').style.display = 'none';
+}
+
+function updateStatus() {
+    // Fetch data from /data endpoint
+    let measurements = null;
+    let statusData = null;
+    let dataFetched = false;
+    let statusFetched = false;
+    
+    function updateChartIfReady() {
+        if (dataFetched && statusFetched && measurements) {
+            updateChart(measurements);
+        }
+    }
+    
+    fetch('/data?maxPoints=' + chartPointBudget())
+        .then(response => response.json())
+        .then(data => {
+            measurements = data.measurements;
+            dataFetched = true;
+            updateUI(data);
+            updateChartIfReady();
+        })
+        .catch(error => {
+            console.error('Error fetching data:', error);
+        });
+    
+    // Fetch WiFi and calibration status
+    fetch('/status')
+        .then(response => response.json())
+        .then(data => {
+            statusData = data;
+            statusFetched = true;
+            updateWifiStatus(data);
+            updateCalibrationStatus(data);
+            updateChartIfReady();
+        })
+        .catch(error => {
+            console.error('Error fetching status:', error);
+        });
+}
+
+function updateUI(data) {
+    if (!data || !data.measurements || data.measurements.length === 0) {
+        return;
+    }
+
+    const latest = data.measurements[data.measurements.length - 1];
+
+    // Update with pulse animation
+    const statusBoxes = document.querySelectorAll('.status-box');
+    statusBoxes.forEach(box => box.classList.add('updated'));
+    setTimeout(() => {
+        statusBoxes.forEach(box => box.classList.remove('updated'));
+    }, 600);
+
+    // Update status boxes
+    document.getElementById('risePercentage').textContent = latest.rise.toFixed(1) + '%';
+    document.getElementById('thickness').textContent = latest.thickness + ' mm';
+
+    // Elapsed time will be updated in updateCalibrationStatus with calibration timestamp
+    // Update chart
+    updateChart(data.measurements);
+
+    // Update table
+    updateTable(data.measurements);
+
+    // Update last update time
+    document.getElementById('lastUpdate').textContent = new Date().toLocaleTimeString();
+}
+
+function formatTime24h(timestamp) {
+    // Format timestamp in 24hr format for Bergen, Norway (Europe/Oslo timezone)
+    const date = new Date(timestamp * 1000);
+    return date.toLocaleString('no-NO', {
+        hour12: false,
+        hour: '2-digit',
+        minute: '2-digit',
+        second: '2-digit',
+        timeZone: 'Europe/Oslo'
+    });
+}
+
+// Axis and tooltip label for a timestamp: clock time and elapsed time
+function formatChartTime(timestamp) {
+    const first = overviewMeasurements.length ? overviewMeasurements[0].timestamp : timestamp;
+    const baselineTime = calibrationTime > 0 ? calibrationTime : first;
+    const elapsedSeconds = Math.max(0, Math.floor(timestamp - baselineTime));
+    const hours = Math.floor(elapsedSeconds / 3600);
+    const minutes = Math.floor((elapsedSeconds % 3600) / 60);
+    return [formatTime24h(timestamp), '(Elapsed: ' + hours + ':' + String(minutes).padStart(2, '0') + ')'];
+}
+
+function updateChart(measurements) {
+    if (!chart) return;
+    
+    // New measurements make cached windows that reach the present stale
+    const last = overviewMeasurements.length ? overviewMeasurements[overviewMeasurements.length - 1].timestamp : 0;
+    const newest = measurements.length ? measurements[measurements.length - 1].timestamp : 0;
+    if (newest !== last) windowCache.clear();
+    
+    overviewMeasurements = measurements;
+    renderChart();
+}
+
+// Overview points outside the zoomed range, detailed points inside it
+function renderChart() {
+    let points = overviewMeasurements;
+    if (zoomWindow) {
+        points = overviewMeasurements.filter(m => m.timestamp < zoomWindow.from)
+            .concat(zoomWindow.measurements)
+            .concat(overviewMeasurements.filter(m => m.timestamp > zoomWindow.to));
+    }
+    chart.data.datasets[0].data = points.map(m => ({x: m.timestamp, y: m.rise}));
+    chart.update('none');
+}
+
+// Zoom and pan fire continuously; fetch once the gesture settles
+function scheduleWindowLoad() {
+    clearTimeout(zoomTimer);
+    zoomTimer = setTimeout(loadVisibleWindow, 250);
+}
+
+// Fetch the visible time range at the resolution the canvas can show. The
+// range is widened to a power-of-two grid so small pans hit the cache.
+function loadVisibleWindow() {
+    if (!chart || overviewMeasurements.length === 0) return;
+    if (chart.getZoomLevel() <= 1) {
+        zoomWindow = null;
+        renderChart();
+        return;
+    }
+    
+    const scale = chart.scales.x;
+    const span = Math.max(1, scale.max - scale.min);
+    let step = 1;
+    while (step < span / 4) step *= 2;
+    const from = Math.max(0, Math.floor(scale.min / step) * step);
+    const to = Math.ceil(scale.max / step) * step;
+    const maxPoints = Math.round(chartPointBudget() * (to - from) / span);
+    const key = from + '-' + to;
+    
+    const cached = windowCache.get(key);
+    if (cached) {
+        zoomWindow = {from: from, to: to, measurements: cached};
+        renderChart();
+        return;
+    }
+    
+    fetch('/data?from=' + from + '&to=' + to + '&maxPoints=' + maxPoints)
+        .then(response => response.json())
+        .then(data => {
+            windowCache.set(key, data.measurements);
+            if (windowCache.size > WINDOW_CACHE_SIZE) {
+                windowCache.delete(windowCache.keys().next().value);
+            }
+            if (chart.getZoomLevel() <= 1) return;  // Zoom was reset meanwhile
+            zoomWindow = {from: from, to: to, measurements: data.measurements};
+            renderChart();
+        })
+        .catch(error => console.error('Error fetching chart range:', error));
+}
+
+function updateTable(measurements) {
+    const tbody = document.getElementById('tableBody');
+    tbody.innerHTML = '';
+    
+    measurements.forEach(m => {
+        const row = tbody.insertRow();
+        // Use 24hr format for time display
+        const timeStr = formatTime24h(m.timestamp);
+        row.innerHTML = `
+            <td>${timeStr}</td>
+            <td>${m.thickness} mm</td>
+            <td>${m.rise.toFixed(1)}%</td>
+        `;
+    });
+}
+
+function updateWifiStatus(status) {
+    const indicator = document.querySelector('.status-indicator');
+    const ipElement = document.getElementById('ipAddress');
+    const wifiContent = document.getElementById('wifiContent');
+    const wifiArrow = document.getElementById('wifiArrow');
+    
+    if (status.wifiConnected) {
+        indicator.classList.add('connected');
+        ipElement.textContent = 'IP: ' + status.ip;
+        
+        // Auto-collapse WiFi section when connected
+        if (wifiContent && wifiContent.classList.contains('expanded')) {
+            wifiContent.classList.remove('expanded');
+            wifiArrow.style.transform = 'rotate(0deg)';
+        }
+    } else {
+        indicator.classList.remove('connected');
+        ipElement.textContent = 'IP: Not connected';
+        
+        // Auto-expand WiFi section when disconnected
+        if (wifiContent && !wifiContent.classList.contains('expanded')) {
+            wifiContent.classList.add('expanded');
+            wifiArrow.style.transform = 'rotate(180deg)';
+        }
+    }
+}
+
+function updateCalibrationStatus(status) {
+    // Update initial thickness from calibration
+    const initialThicknessElement = document.getElementById('initialThickness');
+    if (initialThicknessElement) {
+        initialThicknessElement.textContent = status.initialThickness + ' mm';
+    }
+    
+    // Calculate and update elapsed time from calibration time
+    if (status.calibrationTime && status.calibrationTime > 0) {
+        // Set the global calibration time so chart can use it
+        calibrationTime = status.calibrationTime;
+        
+        const calibrationTimeSeconds = status.calibrationTime;
+        const now = Math.floor(Date.now() / 1000);
+        const elapsedSeconds = now - calibrationTimeSeconds;
+        
+        const hours = Math.floor(elapsedSeconds / 3600);
+        const minutes = Math.floor((elapsedSeconds % 3600) / 60);
+        
+        const elapsedTimeElement = document.getElementById('elapsedTime');
+        if (elapsedTimeElement) {
+            elapsedTimeElement.textContent = hours + ':' + String(minutes).padStart(2, '0');
+        }
+    }
+}
+
+function calibrateZero() {
+    showConfirmDialog(
+        'Calibrate Empty Container',
+        'Please place the empty container under the sensor, then click Confirm to calibrate.',
+        function() {
+            const btn = event.target;
+            setButtonLoading(btn, true);
+
+            fetch('/api/calibrate', { method: 'POST' })
+                .then(response => response.json())
+                .then(data => {
+                    showToast('Calibration set to: ' + data.zeroPoint + ' mm', 'success');
+                    updateStatus();
+                })
+                .catch(error => showToast('Error: ' + error, 'error'))
+                .finally(() => setButtonLoading(btn, false));
+        }
+    );
+}
+
+function calibrateDough() {
+    showConfirmDialog(
+        'Calibrate Fresh Starter',
+        'Please place the fresh dough/starter in the container, then click Confirm to set the initial thickness.',
+        function() {
+            const btn = event.target;
+            setButtonLoading(btn, true);
+
+            fetch('/api/calibrate-dough', { method: 'POST' })
+                .then(response => response.json())
+                .then(data => {
+                    showToast('Dough calibrated! Initial thickness: ' + data.initialThickness + ' mm', 'success');
+                    updateStatus();
+                })
+                .catch(error => showToast('Error: ' + error, 'error'))
+                .finally(() => setButtonLoading(btn, false));
+        }
+    );
+}
+
+function showOffsetDialog() {
+    document.getElementById('offsetDialog').style.display = 'flex';
+}
+
+function closeDialog() {
+    document.getElementById('offsetDialog').style.display = 'none';
+}
+
+function saveOffset() {
+    const offset = parseInt(document.getElementById('offsetInput').value) || 0;
+    const btn = event.target;
+    setButtonLoading(btn, true);
+
+    fetch('/api/offset', {
+        method: 'POST',
+        headers: { 'Content-Type': 'application/json' },
+        body: JSON.stringify({ offset: offset })
+    })
+    .then(response => response.json())
+    .then(data => {
+        showToast('Offset set to: ' + data.offset + ' mm', 'success');
+        closeDialog();
+        updateStatus();
+    })
+    .catch(error => showToast('Error: ' + error, 'error'))
+    .finally(() => setButtonLoading(btn, false));
+}
+
+function showResetDataDialog() {
+    showConfirmDialog(
+        'Reset Data',
+        'Delete all measurement data? This action cannot be undone.',
+        function() {
+            const btn = event.target;
+            setButtonLoading(btn, true);
+
+            fetch('/api/reset-data', { method: 'POST' })
+                .then(response => response.json())
+                .then(data => {
+                    showToast('Data reset complete', 'success');
+                    updateStatus();
+                })
+                .catch(error => showToast('Error: ' + error, 'error'))
+                .finally(() => setButtonLoading(btn, false));
+        }
+    );
+}
+
+function showResetWifiDialog() {
+    showConfirmDialog(
+        'Reset WiFi',
+        'Reset WiFi settings? The device will reboot and you will need to reconnect.',
+        function() {
+            const btn = event.target;
+            setButtonLoading(btn, true);
+
+            fetch('/api/reset-wifi', { method: 'POST' })
+                .then(response => response.json())
+                .then(data => {
+                    showToast('WiFi reset - device rebooting...', 'warning');
+                })
+                .catch(error => showToast('Error: ' + error, 'error'))
+                .finally(() => setButtonLoading(btn, false));
+        }
+    );
+}
+
+function scanNetworks() {
+    const scanStatus = document.getElementById('scanStatus');
+    const btn = event.target;
+
+    scanStatus.style.display = 'block';
+    scanStatus.textContent = 'Scanning...';
+    setButtonLoading(btn, true);
+
+    fetch('/api/scan-networks')
+        .then(response => response.json())
+        .then(data => {
+            const select = document.getElementById('networkSelect');
+            select.innerHTML = '<option value="">-- Select a network --</option>';
+
+            data.forEach(network => {
+                const option = document.createElement('option');
+                option.value = network.ssid;
+                option.textContent = network.ssid + ' (Signal: ' + network.rssi + ' dBm)';
+                select.appendChild(option);
+            });
+
+            scanStatus.textContent = 'Found ' + data.length + ' networks';
+            showToast('Found ' + data.length + ' WiFi networks', 'success');
+            setTimeout(() => { scanStatus.style.display = 'none'; }, 3000);
+        })
+        .catch(error => {
+            scanStatus.textContent = 'Error scanning networks';
+            showToast('Error scanning networks: ' + error, 'error');
+            setTimeout(() => { scanStatus.style.display = 'none'; }, 3000);
+        })
+        .finally(() => setButtonLoading(btn, false));
+}
+
+function connectToWiFi() {
+    const ssid = document.getElementById('networkSelect').value;
+    const password = document.getElementById('wifiPassword').value;
+    const connectStatus = document.getElementById('connectStatus');
+    const btn = event.target;
+
+    if (!ssid) {
+        showToast('Please select a network', 'warning');
+        return;
+    }
+
+    connectStatus.style.display = 'block';
+    connectStatus.textContent = 'Connecting to ' + ssid + '...';
+    setButtonLoading(btn, true);
+
+    fetch('/api/connect-wifi', {
+        method: 'POST',
+        headers: { 'Content-Type': 'application/json' },
+        body: JSON.stringify({ ssid: ssid, password: password })
+    })
+    .then(response => response.json())
+    .then(data => {
+        if (!data.success) throw new Error(data.error || 'Unknown error');
+        // The device answers at once and connects in the background
+        return waitForWiFiJob(data.job, connectStatus);
+    })
+    .then(job => {
+        const address = job.ip + (job.hostname ? ' (http://' + job.hostname + ')' : '');
+        connectStatus.textContent = 'Successfully connected to ' + ssid + '! Device IP: ' + address;
+        connectStatus.style.backgroundColor = '#c8e6c9';
+        showToast('Successfully connected to ' + ssid + '!', 'success');
+        // On the setup hotspot the page has to move to the new network
+        if (location.hostname === '192.168.4.1') {
+            connectStatus.textContent += '. Switch your phone back to your own WiFi and open that address.';
+            return;
+        }
+        setTimeout(() => {
+            connectStatus.style.display = 'none';
+            setTimeout(() => { location.reload(); }, 2000);
+        }, 3000);
+    })
+    .catch(error => {
+        connectStatus.textContent = 'Connection failed: ' + error.message;
+        connectStatus.style.backgroundColor = '#ffcdd2';
+        showToast('Connection failed: ' + error.message, 'error');
+    })
+    .finally(() => setButtonLoading(btn, false));
+}
+
+// Poll a connection attempt until it is decided. Failed polls are retried:
+// the hotspot can drop for a moment when the device joins the network.
+function waitForWiFiJob(jobId, connectStatus) {
+    const deadline = Date.now() + 45000;
+    return new Promise((resolve, reject) => {
+        const poll = () => {
+            fetch('/api/connect-wifi?job=' + jobId)
+            .then(response => response.json())
+            .then(job => {
+                if (job.state === 'connected') return resolve(job);
+                if (job.state === 'failed') return reject(new Error(job.error));
+                if (job.error) return reject(new Error(job.error));
+                connectStatus.textContent = 'Connecting to ' + job.ssid + '... ' +
+                    Math.round(job.elapsedMs / 1000) + ' s';
+                next();
+            })
+            .catch(next);
+        };
+        const next = () => {
+            if (Date.now() > deadline) return reject(new Error('No answer from the device'));
+            setTimeout(poll, 1000);
+        };
+        setTimeout(poll, 500);
+    });
+}
+)rawliteral";
+}
@@ -1,190 +1,530 @@
-#include "WebhookManager.h"
-#include <WiFi.h>
-
-WebhookManager::WebhookManager() {
-}
-
-void WebhookManager::begin() {
-  Serial.println("[WebhookManager] Initializing...");
-  loadFromNVS();
-  loadThresholdsFromNVS();
-
-  if (webhookURL.length() > 0) {
-    Serial.printf("[WebhookManager] Webhook URL loaded: %s\n", webhookURL.c_str());
-  } else {
-    Serial.println("[WebhookManager] No webhook URL configured");
-  }
-
-  Serial.printf("[WebhookManager] Notifications %s\n", enabled ? "enabled" : "disabled");
-  Serial.printf("[WebhookManager] Thresholds - 50%%: %s, 100%%: %s, 200%%: %s\n",
-                threshold50Reached ? "reached" : "pending",
-                threshold100Reached ? "reached" : "pending",
-                threshold200Reached ? "reached" : "pending");
-}
-
-void WebhookManager::setWebhookURL(const String& url) {
-  webhookURL = url;
-  saveToNVS();
-  Serial.printf("[WebhookManager] Webhook URL saved: %s\n", url.c_str());
-}
-
-String WebhookManager::getWebhookURL() {
-  return webhookURL;
-}
-
-bool WebhookManager::isConfigured() {
-  return webhookURL.length() > 0;
-}
-
-void WebhookManager::setEnabled(bool en) {
-  enabled = en;
-  saveToNVS();
-  Serial.printf("[WebhookManager] Notifications %s\n", enabled ? "enabled" : "disabled");
-}
-
-bool WebhookManager::isEnabled() {
-  return enabled;
-}
-
-bool WebhookManager::isThreshold50Reached() {
-  return threshold50Reached;
-}
-
-bool WebhookManager::isThreshold100Reached() {
-  return threshold100Reached;
-}
-
-bool WebhookManager::isThreshold200Reached() {
-  return threshold200Reached;
-}
-
-void WebhookManager::checkAndNotify(float currentRisePercentage) {
-  if (!enabled || webhookURL.length() == 0) {
-    return;
-  }
-
-  // Check WiFi connection
-  if (WiFi.status() != WL_CONNECTED) {
-    Serial.println("[WebhookManager] WiFi not connected, skipping notification");
-    return;
-  }
-
-  // Only check rising thresholds (not falling)
-  if (currentRisePercentage < lastRisePercentage) {
-    lastRisePercentage = currentRisePercentage;
-    return;
-  }
-
-  // Check 200% first (highest threshold)
-  if (!threshold200Reached && currentRisePercentage >= 200.0) {
-    Serial.println("[WebhookManager] 200% threshold reached, sending notification...");
-    if (sendDiscordMessage("Wow, you dough has tripled!")) {
-      threshold200Reached = true;
-      saveThresholdsToNVS();
-      Serial.println("[WebhookManager] 200% threshold notification sent successfully");
-    }
-  }
-  // Check 100%
-  else if (!threshold100Reached && currentRisePercentage >= 100.0) {
-    Serial.println("[WebhookManager] 100% threshold reached, sending notification...");
-    if (sendDiscordMessage("Your dough has risen 100%, it's doubled!")) {
-      threshold100Reached = true;
-      saveThresholdsToNVS();
-      Serial.println("[WebhookManager] 100% threshold notification sent successfully");
-    }
-  }
-  // Check 50%
-  else if (!threshold50Reached && currentRisePercentage >= 50.0) {
-    Serial.println("[WebhookManager] 50% threshold reached, sending notification...");
-    if (sendDiscordMessage("Your dough has risen 50%, it's getting there!")) {
-      threshold50Reached = true;
-      saveThresholdsToNVS();
-      Serial.println("[WebhookManager] 50% threshold notification sent successfully");
-    }
-  }
-
-  lastRisePercentage = currentRisePercentage;
-}
-
-void WebhookManager::resetThresholds() {
-  Serial.println("[WebhookManager] Resetting thresholds for new fermentation cycle");
-  threshold50Reached = false;
-  threshold100Reached = false;
-  threshold200Reached = false;
-  lastRisePercentage = 0.0;
-  saveThresholdsToNVS();
-}
-
-bool WebhookManager::sendTestNotification() {
-  if (!isConfigured()) {
-    Serial.println("[WebhookManager] Cannot send test - webhook not configured");
-    return false;
-  }
-
-  if (WiFi.status() != WL_CONNECTED) {
-    Serial.println("[WebhookManager] Cannot send test - WiFi not connected");
-    return false;
-  }
-
-  Serial.println("[WebhookManager] Sending test notification...");
-  return sendDiscordMessage("Test notification from your DoughTracker! 🍞");
-}
-
-bool WebhookManager::sendDiscordMessage(const String& message) {
-  HTTPClient http;
-
-  http.begin(webhookURL);
-  http.addHeader("Content-Type", "application/json");
-  http.setTimeout(5000);
-
-  // Build JSON payload - escape quotes in message
-  String payload = "{\"content\":\"" + message + "\"}";
-
-  int httpCode = http.POST(payload);
-
-  bool success = (httpCode >= 200 && httpCode < 300);
-
-  if (success) {
-    Serial.printf("[WebhookManager] Discord notification sent: %s (HTTP %d)\n",
-                  message.c_str(), httpCode);
-  } else {
-    Serial.printf("[WebhookManager] Failed to send notification. HTTP Code: %d\n", httpCode);
-    if (httpCode > 0) {
-      String response = http.getString();
-      Serial.printf("[WebhookManager] Response: %s\n", response.c_str());
-    }
-  }
-
-  http.end();
-  return success;
-}
-
-void WebhookManager::loadFromNVS() {
-  preferences.begin("webhook", true); // Read-only
-  webhookURL = preferences.getString("url", "");
-  enabled = preferences.getBool("enabled", true);
-  preferences.end();
-}
-
-void WebhookManager::saveToNVS() {
-  preferences.begin("webhook", false); // Read-write
-  preferences.putString("url", webhookURL);
-  preferences.putBool("enabled", enabled);
-  preferences.end();
-}
-
-void WebhookManager::loadThresholdsFromNVS() {
-  preferences.begin("webhook", true); // Read-only
-  threshold50Reached = preferences.getBool("threshold50", false);
-  threshold100Reached = preferences.getBool("threshold100", false);
-  threshold200Reached = preferences.getBool("threshold200", false);
-  preferences.end();
-}
-
-void WebhookManager::saveThresholdsToNVS() {
-  preferences.begin("webhook", false); // Read-write
-  preferences.putBool("threshold50", threshold50Reached);
-  preferences.putBool("threshold100", threshold100Reached);
-  preferences.putBool("threshold200", threshold200Reached);
-  preferences.end();
-}
+#include "WebhookManager.h"
+#include <WiFi.h>
+#include "DataManager.h"
+#include "Metrics.h"
+#include "Log.h"
+#include <math.h>
+#include <time.h>
+
+WebhookManager::WebhookManager() {
+}
+
+void WebhookManager::begin() {
+  LOG_I(Webhook, "[WebhookManager] Initializing...\n");
+  notifier.begin();
+  loadFromNVS();
+  loadStateFromNVS();
+  outbox.begin(&notifier);
+  outbox.setDigest(digestWindow, formatDigest, this);
+
+  if (!isConfigured()) {
+    LOG_I(Webhook, "[WebhookManager] No notification targets configured\n");
+  }
+
+  LOG_I(Webhook, "[WebhookManager] Notifications %s\n", enabled ? "enabled" : "disabled");
+  LOG_I(Webhook, "[WebhookManager] Heads-up %s (%u min)\n", headsUpEnabled ? "enabled" : "disabled",
+                headsUpLeadMinutes);
+  LOG_I(Webhook, "[WebhookManager] Digest window %u s\n", digestWindow);
+  for (uint8_t i = 0; i < thresholdCount; i++) {
+    LOG_I(Webhook, "[WebhookManager] Threshold %s%.2f%%: %s\n", thresholds[i].falling ? "falling to " : "",
+                  riseToPercent(thresholds[i].rise), (reached & (1 << i)) ? "reached" : "pending");
+  }
+}
+
+void WebhookManager::setDataManager(DataManager* dataMgr) {
+  dataManager = dataMgr;
+}
+
+void WebhookManager::setWebhookURL(const String& url) {
+  NotifierTarget list[NOTIFIER_MAX_TARGETS];
+  uint8_t count = notifier.getTargetCount();
+  for (uint8_t i = 0; i < count; i++) {
+    list[i] = notifier.getTarget(i);
+  }
+
+  if (url.length() == 0) {
+    if (count == 0) return;
+    memmove(list, list + 1, sizeof(NotifierTarget) * (count - 1));
+    count--;
+  } else {
+    if (count == 0) {
+      memset(&list[0], 0, sizeof(NotifierTarget));
+      snprintf(list[0].name, sizeof(list[0].name), "Discord");
+      list[0].format = NOTIFIER_DISCORD;
+      list[0].enabled = true;
+      count = 1;
+    }
+    snprintf(list[0].url, sizeof(list[0].url), "%s", url.c_str());
+  }
+  setTargets(list, count);
+  LOG_I(Webhook, "[WebhookManager] Webhook URL saved: %s\n", url.c_str());
+}
+
+String WebhookManager::getWebhookURL() {
+  return notifier.getTargetCount() > 0 ? String(notifier.getTarget(0).url) : String();
+}
+
+bool WebhookManager::isConfigured() {
+  return notifier.hasTargets();
+}
+
+Notifier& WebhookManager::getNotifier() {
+  return notifier;
+}
+
+bool WebhookManager::setTargets(const NotifierTarget* list, uint8_t count) {
+  if (!notifier.setTargets(list, count)) return false;
+  outbox.retarget();
+  if (outbox.isDirty()) saveStateToNVS();
+  return true;
+}
+
+NotificationOutbox& WebhookManager::getOutbox() {
+  return outbox;
+}
+
+uint16_t WebhookManager::getSession() {
+  return session;
+}
+
+void WebhookManager::setEnabled(bool en) {
+  enabled = en;
+  saveToNVS();
+  LOG_I(Webhook, "[WebhookManager] Notifications %s\n", enabled ? "enabled" : "disabled");
+}
+
+bool WebhookManager::isEnabled() {
+  return enabled;
+}
+
+void WebhookManager::setHeadsUp(bool en, uint16_t leadMinutes) {
+  headsUpEnabled = en;
+  if (leadMinutes < 1) leadMinutes = 1;
+  if (leadMinutes > HEADS_UP_MAX_LEAD_MINUTES) leadMinutes = HEADS_UP_MAX_LEAD_MINUTES;
+  headsUpLeadMinutes = leadMinutes;
+  if (!headsUpEnabled) confirmationTime = 0;
+  saveToNVS();
+  LOG_I(Webhook, "[WebhookManager] Heads-up %s (%u min)\n", headsUpEnabled ? "enabled" : "disabled",
+                headsUpLeadMinutes);
+}
+
+bool WebhookManager::isHeadsUpEnabled() {
+  return headsUpEnabled;
+}
+
+uint16_t WebhookManager::getHeadsUpLeadMinutes() {
+  return headsUpLeadMinutes;
+}
+
+void WebhookManager::setDigestWindow(uint16_t seconds) {
+  if (seconds > DIGEST_MAX_WINDOW_SECONDS) seconds = DIGEST_MAX_WINDOW_SECONDS;
+  digestWindow = seconds;
+  outbox.setDigest(digestWindow, formatDigest, this);
+  saveToNVS();
+  LOG_I(Webhook, "[WebhookManager] Digest window %u s\n", digestWindow);
+}
+
+uint16_t WebhookManager::getDigestWindow() {
+  return digestWindow;
+}
+
+unsigned long WebhookManager::getConfirmationTime() {
+  return confirmationTime;
+}
+
+bool WebhookManager::takeDueConfirmation() {
+  if (confirmationTime == 0 || (unsigned long)time(nullptr) < confirmationTime) return false;
+  confirmationTime = 0;
+  return true;
+}
+
+uint8_t WebhookManager::getThresholdCount() {
+  return thresholdCount;
+}
+
+const WebhookThreshold& WebhookManager::getThreshold(uint8_t index) {
+  return thresholds[index < thresholdCount ? index : 0];
+}
+
+bool WebhookManager::isThresholdReached(uint8_t index) {
+  return index < thresholdCount && (reached & (1 << index));
+}
+
+bool WebhookManager::setThresholds(const WebhookThreshold* list, uint8_t count) {
+  if (count > WEBHOOK_MAX_THRESHOLDS) return false;
+
+  // Carry the state of thresholds that stay over to their new index
+  uint16_t newReached = 0, newArmed = 0, newHeadsUp = 0;
+  WebhookThreshold previous[WEBHOOK_MAX_THRESHOLDS];
+  uint8_t previousCount = thresholdCount;
+  memcpy(previous, thresholds, sizeof(WebhookThreshold) * previousCount);
+
+  for (uint8_t i = 0; i < count; i++) {
+    thresholds[i] = list[i];
+    thresholds[i].message[WEBHOOK_MESSAGE_SIZE - 1] = '\0';
+  }
+  thresholdCount = count;
+  sortThresholds();
+
+  for (uint8_t i = 0; i < thresholdCount; i++) {
+    for (uint8_t j = 0; j < previousCount; j++) {
+      if (previous[j].rise == thresholds[i].rise && previous[j].falling == thresholds[i].falling) {
+        if (reached & (1 << j)) newReached |= 1 << i;
+        if (armed & (1 << j)) newArmed |= 1 << i;
+        if (headsUpSent & (1 << j)) newHeadsUp |= 1 << i;
+        break;
+      }
+    }
+  }
+  reached = newReached;
+  armed = newArmed;
+  headsUpSent = newHeadsUp;
+
+  saveThresholdListToNVS();
+  saveStateToNVS();
+  LOG_I(Webhook, "[WebhookManager] %d thresholds saved\n", thresholdCount);
+  return true;
+}
+
+// Rising thresholds lowest first, then falling ones highest first
+void WebhookManager::sortThresholds() {
+  auto before = [](const WebhookThreshold& a, const WebhookThreshold& b) {
+    if (a.falling != b.falling) return !a.falling;
+    return a.falling ? a.rise > b.rise : a.rise < b.rise;
+  };
+  // Insertion sort: a handful of entries, and only when the list changes
+  for (uint8_t i = 1; i < thresholdCount; i++) {
+    WebhookThreshold entry = thresholds[i];
+    uint8_t j = i;
+    while (j > 0 && before(entry, thresholds[j - 1])) {
+      thresholds[j] = thresholds[j - 1];
+      j--;
+    }
+    thresholds[j] = entry;
+  }
+}
+
+void WebhookManager::setDefaultThresholds() {
+  static const WebhookThreshold DEFAULTS[] = {
+    {50 * RISE_SCALE, false, "Your dough has risen 50%, it's getting there!"},
+    {100 * RISE_SCALE, false, "Your dough has risen 100%, it's doubled!"},
+    {200 * RISE_SCALE, false, "Wow, you dough has tripled!"},
+  };
+  thresholdCount = sizeof(DEFAULTS) / sizeof(DEFAULTS[0]);
+  memcpy(thresholds, DEFAULTS, sizeof(DEFAULTS));
+}
+
+void WebhookManager::checkAndNotify(RiseFixed currentRise) {
+  if (!enabled || !isConfigured()) {
+    return;
+  }
+
+  // One pass over the sorted list finds every threshold this measurement
+  // crossed, so a jump over several sends all of them
+  uint16_t crossed = 0;
+  uint16_t previousArmed = armed;
+  for (uint8_t i = 0; i < thresholdCount; i++) {
+    const WebhookThreshold& threshold = thresholds[i];
+    uint16_t bit = 1 << i;
+    if (!threshold.falling) {
+      // Rising ones are sorted, so none after a higher one can be crossed
+      if (currentRise < threshold.rise) {
+        while (i + 1 < thresholdCount && !thresholds[i + 1].falling) i++;
+        continue;
+      }
+      if (!(reached & bit)) crossed |= bit;
+    } else if (currentRise > threshold.rise) {
+      armed |= bit;
+    } else if ((armed & bit) && !(reached & bit)) {
+      crossed |= bit;
+    }
+  }
+
+  // Queued notifications count as sent: the outbox delivers them, even
+  // across an outage or a reboot
+  bool changed = armed != previousArmed;
+  for (uint8_t i = 0; i < thresholdCount; i++) {
+    if (!(crossed & (1 << i))) continue;
+    char message[WEBHOOK_MESSAGE_SIZE + 32];
+    formatMessage(thresholds[i], currentRise, message, sizeof(message));
+    LOG_I(Webhook, "[WebhookManager] %s%.2f%% threshold reached, queueing notification...\n",
+                  thresholds[i].falling ? "Falling " : "", riseToPercent(thresholds[i].rise));
+    queueNotification(OUTBOX_THRESHOLD, thresholds[i], currentRise, message, 0);
+    reached |= 1 << i;
+    changed = true;
+  }
+  if (checkHeadsUp(currentRise)) changed = true;
+
+  // Try to deliver right away, then write state and queue in one go
+  outbox.service(WiFi.status() == WL_CONNECTED);
+  if (changed || outbox.isDirty()) saveStateToNVS();
+}
+
+void WebhookManager::handle() {
+  if (!enabled) return;
+  outbox.service(WiFi.status() == WL_CONNECTED);
+  // Batch delivery progress into few writes; an emptied queue is written
+  // at once so nothing is delivered twice after a reboot
+  if (outbox.isDirty() &&
+      (outbox.getCount() == 0 || millis() - lastStateSave >= OUTBOX_SAVE_INTERVAL_MS)) {
+    saveStateToNVS();
+  }
+}
+
+void WebhookManager::formatDigest(const OutboxEntry* const* entries, uint8_t count, String& message,
+                                  void* context) {
+  WebhookManager* self = static_cast<WebhookManager*>(context);
+  message = "DoughTracker: ";
+  message += count;
+  message += " updates";
+  for (uint8_t i = 0; i < count; i++) {
+    // Leave room for the summary; Discord caps messages at 2000 characters
+    if (message.length() + strlen(entries[i]->message) + 160 > DIGEST_MESSAGE_SIZE) {
+      message += "\n• and ";
+      message += (unsigned)(count - i);
+      message += " more";
+      break;
+    }
+    message += "\n• ";
+    message += entries[i]->message;
+  }
+
+  DataManager* data = self->dataManager;
+  if (!data || data->getCount() == 0) return;
+  char line[96];
+  char rise[16];
+  formatPercent(data->getCurrentRise(), rise, sizeof(rise));
+  // No rate until the window holds enough points
+  float rate = data->getRiseRatePercentPerHour();
+  if (isnan(rate)) {
+    snprintf(line, sizeof(line), "\nNow %s%%", rise);
+  } else {
+    snprintf(line, sizeof(line), "\nNow %s%% (%+.1f%%/h)", rise, rate);
+  }
+  message += line;
+
+  const RiseForecast& forecast = data->getForecast();
+  unsigned long at, earliest, latest;
+  unsigned long now = time(nullptr);
+  if (forecast.isReady() && forecast.predictPeakTime(&at, &earliest, &latest) && at > now) {
+    snprintf(line, sizeof(line), ", peak ~%.0f%% in ~%lu min", forecast.getPeakRise(),
+             ((at - now) + 150) / 300 * 5);
+    message += line;
+  }
+}
+
+void WebhookManager::queueNotification(OutboxKind kind, const WebhookThreshold& threshold,
+                                       RiseFixed currentRise, const char* message, uint32_t expires) {
+  OutboxEntry entry = {};
+  entry.session = session;
+  entry.kind = kind;
+  entry.falling = threshold.falling;
+  entry.threshold = threshold.rise;
+  entry.rise = currentRise;
+  entry.created = time(nullptr);
+  entry.expires = expires;
+  snprintf(entry.message, sizeof(entry.message), "%s", message);
+  outbox.enqueue(entry);
+}
+
+void WebhookManager::formatMessage(const WebhookThreshold& threshold, RiseFixed currentRise,
+                                   char* out, size_t size) {
+  size_t used = 0;
+  const char* p = threshold.message;
+  while (*p && used + 1 < size) {
+    if (strncmp(p, "{threshold}", 11) == 0) {
+      used += formatPercent(threshold.rise, out + used, size - used);
+      p += 11;
+    } else if (strncmp(p, "{rise}", 6) == 0) {
+      used += formatPercent(currentRise, out + used, size - used);
+      p += 6;
+    } else {
+      out[used++] = *p++;
+    }
+    if (used >= size) used = size - 1;
+  }
+  out[used] = '\0';
+}
+
+// What a rising threshold means, for heads-up messages
+static void thresholdPhrase(RiseFixed rise, char* out, size_t size) {
+  if (rise == 100 * RISE_SCALE) {
+    snprintf(out, size, "double");
+  } else if (rise == 200 * RISE_SCALE) {
+    snprintf(out, size, "triple");
+  } else {
+    size_t used = snprintf(out, size, "reach ");
+    used += formatPercent(rise, out + used, size - used);
+    snprintf(out + used, size - used, "%%");
+  }
+}
+
+bool WebhookManager::checkHeadsUp(RiseFixed currentRise) {
+  if (!headsUpEnabled || !dataManager) return false;
+  const RiseForecast& forecast = dataManager->getForecast();
+  if (!forecast.isReady()) return false;
+
+  bool queued = false;
+  unsigned long now = time(nullptr);
+  unsigned long lead = (unsigned long)headsUpLeadMinutes * 60;
+
+  for (uint8_t i = 0; i < thresholdCount; i++) {
+    const WebhookThreshold& threshold = thresholds[i];
+    if (threshold.falling || (reached & (1 << i)) || (headsUpSent & (1 << i))) continue;
+
+    unsigned long at, earliest, latest;
+    if (!forecast.predictTime(riseToPercent(threshold.rise), &at, &earliest, &latest)) continue;
+    // Overdue crossings are left to the regular threshold check
+    if (at <= now || at - now > lead) continue;
+    // Only warn when the forecast is sure enough for "~N min" to mean something
+    if ((latest - earliest) / 2 > lead) continue;
+
+    // Measure right at the predicted crossing to confirm it
+    if (confirmationTime == 0 || at < confirmationTime) confirmationTime = at;
+
+    unsigned long minutes = ((at - now) + 150) / 300 * 5;  // Nearest 5 minutes
+    if (minutes < 5) minutes = 5;
+    char phrase[24];
+    thresholdPhrase(threshold.rise, phrase, sizeof(phrase));
+    char message[96];
+    snprintf(message, sizeof(message), "Heads-up: your dough is expected to %s in ~%lu min",
+             phrase, minutes);
+    LOG_I(Webhook, "[WebhookManager] %.2f%% predicted in %lu s, queueing heads-up...\n",
+                  riseToPercent(threshold.rise), at - now);
+    // Pointless once the crossing itself is due
+    queueNotification(OUTBOX_HEADS_UP, threshold, currentRise, message, at);
+    headsUpSent |= 1 << i;
+    queued = true;
+  }
+  return queued;
+}
+
+void WebhookManager::resetThresholds() {
+  LOG_I(Webhook, "[WebhookManager] Resetting thresholds for new fermentation cycle\n");
+  reached = 0;
+  armed = 0;
+  headsUpSent = 0;
+  confirmationTime = 0;
+  session++;
+  outbox.clear();  // Notifications about the previous dough
+  saveStateToNVS();
+}
+
+uint8_t WebhookManager::sendTestNotification() {
+  if (!isConfigured()) {
+    LOG_I(Webhook, "[WebhookManager] Cannot send test - webhook not configured\n");
+    return 0;
+  }
+
+  if (WiFi.status() != WL_CONNECTED) {
+    LOG_I(Webhook, "[WebhookManager] Cannot send test - WiFi not connected\n");
+    return 0;
+  }
+
+  LOG_I(Webhook, "[WebhookManager] Sending test notification...\n");
+  Notification notification = {"test", "Test notification from your DoughTracker! 🍞",
+                               dataManager ? dataManager->getCurrentRise() : 0, 0, false};
+  uint8_t accepted = notifier.deliver(notification);
+  uint8_t count = 0;
+  for (; accepted; accepted &= accepted - 1) count++;
+  return count;
+}
+
+void WebhookManager::loadFromNVS() {
+  preferences.begin("webhook", true); // Read-only
+  String legacyURL = preferences.getString("url", "");
+  enabled = preferences.getBool("enabled", true);
+  headsUpEnabled = preferences.getBool("headsup", false);
+  headsUpLeadMinutes = preferences.getUShort("headsupLead", HEADS_UP_LEAD_MINUTES);
+  digestWindow = preferences.getUShort("digestWindow", DIGEST_WINDOW_SECONDS);
+  preferences.end();
+
+  // The single Discord URL from before notification targets
+  if (legacyURL.length() > 0) {
+    if (notifier.getTargetCount() == 0) setWebhookURL(legacyURL);
+    preferences.begin("webhook", false); // Read-write
+    preferences.remove("url");
+    preferences.end();
+  }
+}
+
+void WebhookManager::saveToNVS() {
+  preferences.begin("webhook", false); // Read-write
+  preferences.putBool("enabled", enabled);
+  preferences.putBool("headsup", headsUpEnabled);
+  preferences.putUShort("headsupLead", headsUpLeadMinutes);
+  preferences.putUShort("digestWindow", digestWindow);
+  preferences.end();
+  metrics.recordNvsWrite("webhook", 4);
+}
+
+// Threshold state as stored in NVS; count guards against a list that
+// changed without its state
+struct ThresholdStateBlob {
+  uint8_t version;
+  uint8_t count;
+  uint16_t reached;
+  uint16_t armed;
+  uint16_t headsUpSent;
+  uint16_t session;      // Since version 2
+};
+
+static const uint8_t THRESHOLD_STATE_VERSION = 2;
+static const size_t THRESHOLD_STATE_V1_SIZE = 8;
+
+void WebhookManager::loadStateFromNVS() {
+  preferences.begin("webhook", true); // Read-only
+
+  size_t length = preferences.getBytesLength("thresholds");
+  if (length > 0 && length % sizeof(WebhookThreshold) == 0 &&
+      length / sizeof(WebhookThreshold) <= WEBHOOK_MAX_THRESHOLDS) {
+    thresholdCount = preferences.getBytes("thresholds", thresholds, sizeof(thresholds)) / sizeof(WebhookThreshold);
+    for (uint8_t i = 0; i < thresholdCount; i++) {
+      thresholds[i].message[WEBHOOK_MESSAGE_SIZE - 1] = '\0';
+    }
+    sortThresholds();
+  } else {
+    setDefaultThresholds();
+  }
+
+  ThresholdStateBlob state = {};
+  size_t stateLength = preferences.getBytes("state", &state, sizeof(state));
+  if ((stateLength == sizeof(state) && state.version == THRESHOLD_STATE_VERSION) ||
+      (stateLength == THRESHOLD_STATE_V1_SIZE && state.version == 1)) {
+    session = state.session;
+    if (state.count == thresholdCount) {
+      reached = state.reached;
+      armed = state.armed;
+      headsUpSent = state.headsUpSent;
+    }
+  } else if (preferences.isKey("threshold50")) {
+    // Flags from before the configurable list, for the default 50/100/200%
+    reached = (preferences.getBool("threshold50", false) ? 1 : 0) |
+              (preferences.getBool("threshold100", false) ? 2 : 0) |
+              (preferences.getBool("threshold200", false) ? 4 : 0);
+  }
+  outbox.load(preferences);
+  preferences.end();
+}
+
+void WebhookManager::saveStateToNVS() {
+  ThresholdStateBlob state = {THRESHOLD_STATE_VERSION, thresholdCount, reached, armed, headsUpSent, session};
+  preferences.begin("webhook", false); // Read-write
+  preferences.putBytes("state", &state, sizeof(state));
+  outbox.save(preferences);
+  if (preferences.isKey("threshold50")) {
+    preferences.remove("threshold50");
+    preferences.remove("threshold100");
+    preferences.remove("threshold200");
+  }
+  preferences.end();
+  metrics.recordNvsWrite("webhook", 2);
+  lastStateSave = millis();
+}
+
+void WebhookManager::saveThresholdListToNVS() {
+  preferences.begin("webhook", false); // Read-write
+  preferences.putBytes("thresholds", thresholds, sizeof(WebhookThreshold) * thresholdCount);
+  preferences.end();
+  metrics.recordNvsWrite("webhook", 1);
+}
@@ -1,65 +1,143 @@
-#ifndef WEBHOOK_MANAGER_H
-#define WEBHOOK_MANAGER_H
-
-#include <Arduino.h>
-#include <HTTPClient.h>
-#include <Preferences.h>
-
-class WebhookManager {
-public:
-  WebhookManager();
-
-  // Initialize - load settings from NVS
-  void begin();
-
-  // Set Discord webhook URL
-  void setWebhookURL(const String& url);
-
-  // Get current webhook URL
-  String getWebhookURL();
-
-  // Check if webhook is configured
-  bool isConfigured();
-
-  // Check thresholds and send notifications if needed
-  void checkAndNotify(float currentRisePercentage);
-
-  // Reset threshold flags (called when starting new fermentation)
-  void resetThresholds();
-
-  // Enable/disable webhook notifications
-  void setEnabled(bool enabled);
-  bool isEnabled();
-
-  // Get threshold status for UI display
-  bool isThreshold50Reached();
-  bool isThreshold100Reached();
-  bool isThreshold200Reached();
-
-  // Send a test notification
-  bool sendTestNotification();
-
-private:
-  Preferences preferences;
-  String webhookURL = "";
-  bool enabled = true;
-
-  // Threshold flags - track which thresholds have been crossed
-  bool threshold50Reached = false;
-  bool threshold100Reached = false;
-  bool threshold200Reached = false;
-
-  // Last rise percentage to detect direction
-  float lastRisePercentage = 0.0;
-
-  // Send Discord webhook notification
-  bool sendDiscordMessage(const String& message);
-
-  // NVS persistent storage methods
-  void loadFromNVS();
-  void saveToNVS();
-  void saveThresholdsToNVS();
-  void loadThresholdsFromNVS();
-};
-
-#endif
+#ifndef WEBHOOK_MANAGER_H
+#define WEBHOOK_MANAGER_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "FixedPoint.h"
+#include "Notifier.h"
+#include "NotificationOutbox.h"
+#include "config.h"
+
+class DataManager;  // Forward declaration
+
+// One notification threshold
+struct WebhookThreshold {
+  RiseFixed rise;                      // Hundredths of a percent
+  bool falling;                        // Fires when the rise drops back to it (collapse)
+  char message[WEBHOOK_MESSAGE_SIZE];  // Template: {threshold} and {rise} are filled in
+};
+
+class WebhookManager {
+public:
+  WebhookManager();
+
+  // Initialize - load settings from NVS
+  void begin();
+
+  // Set data manager pointer (for the rise forecast behind heads-up notifications)
+  void setDataManager(DataManager* dataMgr);
+
+  // Set the URL of the first target (added as a Discord target if there
+  // is none; an empty URL removes it)
+  void setWebhookURL(const String& url);
+
+  // URL of the first target, empty if there is none
+  String getWebhookURL();
+
+  // Check if at least one target is configured
+  bool isConfigured();
+
+  // Notification targets and their delivery stats
+  Notifier& getNotifier();
+
+  // Replace the notification targets; queued notifications go to the new ones
+  bool setTargets(const NotifierTarget* targets, uint8_t count);
+
+  // Notifications waiting for delivery
+  NotificationOutbox& getOutbox();
+
+  // Fermentation counter, advanced by resetThresholds()
+  uint16_t getSession();
+
+  // Check thresholds and queue notifications for the ones crossed
+  void checkAndNotify(RiseFixed currentRise);
+
+  // Deliver queued notifications; call from loop()
+  void handle();
+
+  // Reset threshold flags (called when starting new fermentation)
+  void resetThresholds();
+
+  // Enable/disable webhook notifications
+  void setEnabled(bool enabled);
+  bool isEnabled();
+
+  // Notification thresholds: rising ones lowest first, then falling ones
+  // highest first, i.e. the order a rise and a collapse cross them
+  uint8_t getThresholdCount();
+  const WebhookThreshold& getThreshold(uint8_t index);
+  bool isThresholdReached(uint8_t index);
+
+  // Replace the threshold list (at most WEBHOOK_MAX_THRESHOLDS). Thresholds
+  // that are in both lists keep their reached state.
+  bool setThresholds(const WebhookThreshold* thresholds, uint8_t count);
+
+  // Heads-up notifications: warn leadMinutes before the forecast predicts
+  // a threshold crossing, and ask for a measurement at that time
+  void setHeadsUp(bool enabled, uint16_t leadMinutes);
+  bool isHeadsUpEnabled();
+  uint16_t getHeadsUpLeadMinutes();
+
+  // Coalescing window: notifications queued within it go out as one digest
+  // with the current rise, rate and forecast (0: merge only bursts and
+  // backlogs that are already waiting)
+  void setDigestWindow(uint16_t seconds);
+  uint16_t getDigestWindow();
+
+  // Time of the extra measurement at a predicted crossing (0 if none)
+  unsigned long getConfirmationTime();
+
+  // True once the confirmation measurement is due; clears it
+  bool takeDueConfirmation();
+
+  // Send a test notification to every target; returns how many accepted it
+  uint8_t sendTestNotification();
+
+private:
+  Preferences preferences;
+  Notifier notifier;
+  NotificationOutbox outbox;
+  bool enabled = true;
+
+  WebhookThreshold thresholds[WEBHOOK_MAX_THRESHOLDS];
+  uint8_t thresholdCount = 0;
+
+  // Threshold state, a bit per threshold index, stored as one NVS blob
+  uint16_t reached = 0;      // Notification sent
+  uint16_t armed = 0;        // Falling threshold: the rise has been above it
+  uint16_t headsUpSent = 0;
+  uint16_t session = 0;
+  unsigned long lastStateSave = 0;  // millis()
+
+  DataManager* dataManager = nullptr;
+  bool headsUpEnabled = false;
+  uint16_t headsUpLeadMinutes = HEADS_UP_LEAD_MINUTES;
+  unsigned long confirmationTime = 0;   // Unix seconds
+  uint16_t digestWindow = DIGEST_WINDOW_SECONDS;
+
+  void setDefaultThresholds();
+  void sortThresholds();
+
+  // Fill a message template for a threshold
+  void formatMessage(const WebhookThreshold& threshold, RiseFixed currentRise, char* out, size_t size);
+
+  // Queue a heads-up for thresholds the forecast expects soon; true if any
+  bool checkHeadsUp(RiseFixed currentRise);
+
+  // NotificationOutbox::DigestFunction; context is the WebhookManager
+  static void formatDigest(const OutboxEntry* const* entries, uint8_t count, String& message,
+                           void* context);
+
+  void queueNotification(OutboxKind kind, const WebhookThreshold& threshold, RiseFixed currentRise,
+                         const char* message, uint32_t expires);
+
+  // NVS persistent storage methods
+  void loadFromNVS();
+  void saveToNVS();
+  // Threshold state and outbox, written together
+  void saveStateToNVS();
+  void loadStateFromNVS();
+  void saveThresholdListToNVS();
+};
+
+#endif
@@ -1,209 +1,382 @@
-#include "WifiManager.h"
-#include <Preferences.h>
-#include <ESPmDNS.h>
-
-static Preferences preferences;
-
-WifiManager::WifiManager() {
-}
-
-void WifiManager::begin() {
-  Serial.println("[WifiManager] Initializing WiFi manager...");
-  
-  // Try to auto-connect
-  if (autoConnect()) {
-    connected = true;
-    Serial.printf("[WifiManager] Connected to: %s\n", currentSSID.c_str());
-  } else {
-    Serial.println("[WifiManager] No stored credentials found or connection failed");
-    connected = false;
-  }
-}
-
-void WifiManager::startSetup() {
-  Serial.println("[WifiManager] Starting WiFi setup...");
-  
-  // Scan networks
-  Serial.println("[WifiManager] Scanning WiFi networks...");
-  int networks = WiFi.scanNetworks();
-  
-  Serial.printf("[WifiManager] Found %d networks\n", networks);
-  for (int i = 0; i < networks; i++) {
-    Serial.printf("[WifiManager]   %d. %s (RSSI: %d)\n", i + 1, WiFi.SSID(i).c_str(), WiFi.RSSI(i));
-  }
-}
-
-bool WifiManager::connectToNetwork(const char* ssid, const char* password) {
-  Serial.printf("[WifiManager] Connecting to: %s\n", ssid);
-  
-  WiFi.mode(WIFI_STA);
-  WiFi.begin(ssid, password);
-  
-  // Wait for connection (up to 20 seconds)
-  int attempts = 0;
-  while (WiFi.status() != WL_CONNECTED && attempts < 40) {
-    delay(500);
-    Serial.print(".");
-    attempts++;
-  }
-  
-  if (WiFi.status() == WL_CONNECTED) {
-    connected = true;
-    currentSSID = ssid;
-    saveCredentials(ssid, password);
-    
-    Serial.printf("\n[WifiManager] Connected successfully!\n");
-    Serial.printf("[WifiManager] IP Address: %s\n", WiFi.localIP().toString().c_str());
-    
-    return true;
-  } else {
-    Serial.println("\n[WifiManager] Connection failed!");
-    connected = false;
-    return false;
-  }
-}
-
-bool WifiManager::autoConnect() {
-  String ssid, password;
-  loadCredentials(ssid, password);
-  
-  if (ssid.length() == 0) {
-    Serial.println("[WifiManager] No stored credentials found");
-    return false;
-  }
-  
-  Serial.printf("[WifiManager] Attempting auto-connect to: %s\n", ssid.c_str());
-  
-  return connectToNetwork(ssid.c_str(), password.c_str());
-}
-
-bool WifiManager::isConnected() {
-  return (WiFi.status() == WL_CONNECTED);
-}
-
-String WifiManager::getSSID() {
-  if (isConnected()) {
-    return WiFi.SSID();
-  }
-  return "Not connected";
-}
-
-String WifiManager::getLocalIP() {
-  if (isConnected()) {
-    return WiFi.localIP().toString();
-  }
-  return "0.0.0.0";
-}
-
-bool WifiManager::setupMDNS(const char* hostname) {
-  if (!isConnected()) {
-    Serial.println("[WifiManager] Cannot setup mDNS - not connected to WiFi");
-    return false;
-  }
-  
-  Serial.printf("[WifiManager] Setting up mDNS hostname: %s.local\n", hostname);
-  
-  if (!MDNS.begin(hostname)) {
-    Serial.println("[WifiManager] ERROR: Failed to start mDNS!");
-    return false;
-  }
-  
-  Serial.printf("[WifiManager] mDNS started - access at %s.local\n", hostname);
-  return true;
-}
-
-String WifiManager::getNetworksJSON() {
-  Serial.println("[WifiManager] Scanning networks for JSON...");
-  
-  String json = "[";
-  int networks = WiFi.scanNetworks();
-  
-  for (int i = 0; i < networks; i++) {
-    if (i > 0) json += ",";
-    
-    json += "{\"ssid\":\"";
-    json += WiFi.SSID(i);
-    json += "\",\"rssi\":";
-    json += WiFi.RSSI(i);
-    json += "}";
-  }
-  
-  json += "]";
-  return json;
-}
-
-void WifiManager::resetWiFi() {
-  Serial.println("[WifiManager] Resetting WiFi settings...");
-  
-  WiFi.disconnect(true);  // Disconnect and turn off WiFi
-  clearCredentials();
-  
-  connected = false;
-  currentSSID = "";
-  
-  Serial.println("[WifiManager] WiFi reset complete");
-}
-
-void WifiManager::handleEvents() {
-  if (isConnected() && !connected) {
-    connected = true;
-    Serial.println("[WifiManager] WiFi connected!");
-  } else if (!isConnected() && connected) {
-    connected = false;
-    Serial.println("[WifiManager] WiFi disconnected!");
-  }
-}
-
-void WifiManager::startAPMode(const char* ssid, const char* password) {
-  Serial.printf("[WifiManager] Starting AP mode: %s\n", ssid);
-  
-  // Stop any existing connection
-  WiFi.disconnect(true);
-  delay(100);
-  
-  // Start AP mode
-  WiFi.mode(WIFI_AP);
-  WiFi.softAP(ssid, password);
-  
-  apModeActive = true;
-  
-  IPAddress apIP = WiFi.softAPIP();
-  Serial.printf("[WifiManager] AP Mode started!\n");
-  Serial.printf("[WifiManager] AP SSID: %s\n", ssid);
-  Serial.printf("[WifiManager] AP IP: %s\n", apIP.toString().c_str());
-  Serial.printf("[WifiManager] Clients can connect and access web interface at: http://%s\n", apIP.toString().c_str());
-}
-
-bool WifiManager::isAPModeActive() {
-  return apModeActive;
-}
-
-void WifiManager::saveCredentials(const char* ssid, const char* password) {
-  preferences.begin("wifi", false);
-  preferences.putString("ssid", ssid);
-  preferences.putString("password", password);
-  preferences.end();
-  
-  Serial.println("[WifiManager] Credentials saved");
-}
-
-void WifiManager::loadCredentials(String& ssid, String& password) {
-  preferences.begin("wifi", true);
-  
-  ssid = preferences.getString("ssid", "");
-  password = preferences.getString("password", "");
-  
-  preferences.end();
-  
-  if (ssid.length() > 0) {
-    Serial.printf("[WifiManager] Credentials loaded: SSID=%s\n", ssid.c_str());
-  }
-}
-
-void WifiManager::clearCredentials() {
-  preferences.begin("wifi", false);
-  preferences.clear();
-  preferences.end();
-  
-  Serial.println("[WifiManager] Credentials cleared");
-}
+#include "WifiManager.h"
+#include <Preferences.h>
+#include <ESPmDNS.h>
+#include "Metrics.h"
+#include "Log.h"
+#include "config.h"
+#include <time.h>
+
+static Preferences preferences;
+
+WifiManager::WifiManager() {
+}
+
+void WifiManager::begin() {
+  LOG_I(Wifi, "[WifiManager] Initializing WiFi manager...\n");
+  
+  WiFi.onEvent([this](WiFiEvent_t event, WiFiEventInfo_t info) {
+    this->onWiFiEvent(event, info);
+  });
+  
+  if (isConnected()) {
+    // The radio is still associated (e.g. after a software reset)
+    connected = true;
+    currentSSID = WiFi.SSID();
+    LOG_I(Wifi, "[WifiManager] Connected to: %s\n", currentSSID.c_str());
+    onConnected();
+  } else if (autoConnect()) {
+    // Start now, so the connection comes up while the rest of setup() runs
+    advanceConnect();
+  } else {
+    startAPMode(WIFI_AP_SSID, WIFI_AP_PASSWORD);
+  }
+}
+
+void WifiManager::startSetup() {
+  LOG_I(Wifi, "[WifiManager] Starting WiFi setup...\n");
+  
+  // Scan networks
+  LOG_I(Wifi, "[WifiManager] Scanning WiFi networks...\n");
+  int networks = WiFi.scanNetworks();
+  
+  LOG_I(Wifi, "[WifiManager] Found %d networks\n", networks);
+  for (int i = 0; i < networks; i++) {
+    LOG_I(Wifi, "[WifiManager]   %d. %s (RSSI: %d)\n", i + 1, WiFi.SSID(i).c_str(), WiFi.RSSI(i));
+  }
+}
+
+uint16_t WifiManager::startConnect(const char* ssid, const char* password) {
+  return queueConnect(ssid, password, false);
+}
+
+bool WifiManager::autoConnect() {
+  String ssid, password;
+  loadCredentials(ssid, password);
+  
+  if (ssid.length() == 0) {
+    LOG_I(Wifi, "[WifiManager] No stored credentials found\n");
+    return false;
+  }
+  
+  LOG_I(Wifi, "[WifiManager] Attempting auto-connect to: %s\n", ssid.c_str());
+  
+  queueConnect(ssid.c_str(), password.c_str(), true);
+  return true;
+}
+
+uint16_t WifiManager::queueConnect(const char* ssid, const char* password, bool automatic) {
+  LOG_I(Wifi, "[WifiManager] Connecting to: %s\n", ssid);
+  
+  job.id = job.id == UINT16_MAX ? 1 : job.id + 1;
+  job.state = WIFI_JOB_CONNECTING;
+  job.automatic = automatic;
+  strncpy(job.ssid, ssid, sizeof(job.ssid) - 1);
+  job.ssid[sizeof(job.ssid) - 1] = '\0';
+  strncpy(pendingPassword, password, sizeof(pendingPassword) - 1);
+  pendingPassword[sizeof(pendingPassword) - 1] = '\0';
+  job.reason = 0;
+  job.startedAt = millis();
+  job.duration = 0;
+  
+  // The radio is reconfigured on the next handleEvents(), after the
+  // request that asked for this has been answered
+  beginPending = true;
+  apStopPending = false;
+  return job.id;
+}
+
+const WifiConnectJob& WifiManager::getConnectJob() {
+  return job;
+}
+
+bool WifiManager::isConnecting() {
+  return job.state == WIFI_JOB_CONNECTING;
+}
+
+void WifiManager::onWiFiEvent(WiFiEvent_t event, WiFiEventInfo_t info) {
+  // WiFi event task: only hand the event over to loop()
+  if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+    eventGotIP = true;
+  } else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
+    eventReason = info.wifi_sta_disconnected.reason;
+    eventDisconnected = true;
+  }
+}
+
+// Reasons that will not go away by retrying
+static bool isDefiniteFailure(uint8_t reason) {
+  return reason == WIFI_REASON_NO_AP_FOUND || reason == WIFI_REASON_AUTH_FAIL ||
+         reason == WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT || reason == WIFI_REASON_HANDSHAKE_TIMEOUT;
+}
+
+void WifiManager::advanceConnect() {
+  if (job.state != WIFI_JOB_CONNECTING) return;
+  
+  if (beginPending) {
+    beginPending = false;
+    eventGotIP = false;
+    eventDisconnected = false;
+    // Alongside the setup hotspot, so the page that asked can follow along
+    WiFi.mode(apModeActive ? WIFI_AP_STA : WIFI_STA);
+    WiFi.begin(job.ssid, pendingPassword);
+    return;
+  }
+  
+  if (eventGotIP) {
+    finishConnect(true, 0);
+  } else if (eventDisconnected) {
+    // Leaving the previous network, or a transient failure the station retries
+    eventDisconnected = false;
+    uint8_t reason = eventReason;
+    LOG_D(Wifi, "[WifiManager] Disconnected while connecting (reason %d)\n", reason);
+    if (isDefiniteFailure(reason)) finishConnect(false, reason);
+  } else if (millis() - job.startedAt >= WIFI_CONNECT_TIMEOUT_MS) {
+    finishConnect(false, 0);
+  }
+}
+
+void WifiManager::finishConnect(bool success, uint8_t reason) {
+  job.duration = millis() - job.startedAt;
+  job.reason = reason;
+  
+  if (success) {
+    job.state = WIFI_JOB_CONNECTED;
+    connected = true;
+    retryPending = false;
+    retryDelay = WIFI_RETRY_MIN_MS;
+    currentSSID = job.ssid;
+    if (!job.automatic) saveCredentials(job.ssid, pendingPassword);
+    LOG_I(Wifi, "[WifiManager] Connected to %s in %lu ms\n", job.ssid, job.duration);
+    onConnected();
+    
+    if (apModeActive) {
+      apStopPending = true;
+      apStopAt = millis() + WIFI_AP_LINGER_MS;
+    }
+  } else {
+    job.state = WIFI_JOB_FAILED;
+    LOG_W(Wifi, "[WifiManager] Connection to %s failed after %lu ms: %s\n", job.ssid, job.duration,
+                 failureText(reason));
+    WiFi.disconnect();  // Stop the station retrying in the background
+    
+    // Back to the stored network if a new one did not work out. If the
+    // stored network itself failed, keep trying it in the background and
+    // make sure the device stays reachable through the hotspot meanwhile.
+    String ssid, password;
+    if (!job.automatic) loadCredentials(ssid, password);
+    if (ssid.length() > 0) {
+      LOG_I(Wifi, "[WifiManager] Reconnecting to: %s\n", ssid.c_str());
+      WiFi.begin(ssid.c_str(), password.c_str());
+    } else {
+      if (job.automatic) scheduleRetry();
+      if (!apModeActive) startAPMode(WIFI_AP_SSID, WIFI_AP_PASSWORD);
+    }
+  }
+  memset(pendingPassword, 0, sizeof(pendingPassword));
+}
+
+void WifiManager::scheduleRetry() {
+  retryPending = true;
+  retryAt = millis() + retryDelay;
+  LOG_I(Wifi, "[WifiManager] Retrying %s in %lu s\n", job.ssid, retryDelay / 1000);
+  retryDelay *= 2;
+  if (retryDelay > WIFI_RETRY_MAX_MS) retryDelay = WIFI_RETRY_MAX_MS;
+}
+
+void WifiManager::onConnected() {
+  LOG_I(Wifi, "[WifiManager] IP Address: %s\n", WiFi.localIP().toString().c_str());
+  
+  if (!timeConfigured) {
+    // SNTP runs in the background; handleEvents() reports when the clock is set
+    configTime(1 * 3600, 0, "pool.ntp.org", "time.nist.gov");
+    timeConfigured = true;
+    waitingForTime = true;
+    timeRequestedAt = millis();
+  }
+  
+  setupMDNS(MDNS_HOSTNAME);
+}
+
+const char* WifiManager::stateName(WifiConnectState state) {
+  switch (state) {
+    case WIFI_JOB_CONNECTING: return "connecting";
+    case WIFI_JOB_CONNECTED: return "connected";
+    case WIFI_JOB_FAILED: return "failed";
+    default: return "idle";
+  }
+}
+
+const char* WifiManager::failureText(uint8_t reason) {
+  switch (reason) {
+    case 0: return "Timed out";
+    case WIFI_REASON_NO_AP_FOUND: return "Network not found";
+    case WIFI_REASON_AUTH_FAIL:
+    case WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT:
+    case WIFI_REASON_HANDSHAKE_TIMEOUT: return "Wrong password";
+    default: return "Connection failed";
+  }
+}
+
+bool WifiManager::isConnected() {
+  return (WiFi.status() == WL_CONNECTED);
+}
+
+String WifiManager::getSSID() {
+  if (isConnected()) {
+    return WiFi.SSID();
+  }
+  return "Not connected";
+}
+
+String WifiManager::getLocalIP() {
+  if (isConnected()) {
+    return WiFi.localIP().toString();
+  }
+  return "0.0.0.0";
+}
+
+bool WifiManager::setupMDNS(const char* hostname) {
+  if (!isConnected()) {
+    LOG_I(Wifi, "[WifiManager] Cannot setup mDNS - not connected to WiFi\n");
+    return false;
+  }
+  
+  LOG_I(Wifi, "[WifiManager] Setting up mDNS hostname: %s.local\n", hostname);
+  
+  if (!MDNS.begin(hostname)) {
+    LOG_E(Wifi, "[WifiManager] ERROR: Failed to start mDNS!\n");
+    return false;
+  }
+  
+  LOG_I(Wifi, "[WifiManager] mDNS started - access at %s.local\n", hostname);
+  return true;
+}
+
+void WifiManager::writeNetworksJSON(JsonWriter& json) {
+  LOG_I(Wifi, "[WifiManager] Scanning networks for JSON...\n");
+  
+  json.beginArray();
+  int networks = WiFi.scanNetworks();
+  
+  for (int i = 0; i < networks; i++) {
+    json.beginObject();
+    json.field("ssid", WiFi.SSID(i));
+    json.field("rssi", WiFi.RSSI(i));
+    json.endObject();
+  }
+  
+  json.endArray();
+}
+
+void WifiManager::resetWiFi() {
+  LOG_I(Wifi, "[WifiManager] Resetting WiFi settings...\n");
+  
+  WiFi.disconnect(true);  // Disconnect and turn off WiFi
+  clearCredentials();
+  
+  connected = false;
+  currentSSID = "";
+  
+  LOG_I(Wifi, "[WifiManager] WiFi reset complete\n");
+}
+
+void WifiManager::handleEvents() {
+  advanceConnect();
+  
+  if (apStopPending && (long)(millis() - apStopAt) >= 0) {
+    apStopPending = false;
+    apModeActive = false;
+    WiFi.softAPdisconnect(true);
+    LOG_I(Wifi, "[WifiManager] Setup hotspot closed\n");
+  }
+  
+  if (waitingForTime) {
+    time_t now = time(nullptr);
+    if (now >= 24 * 3600) {
+      waitingForTime = false;
+      LOG_I(Wifi, "[WifiManager] Time synchronized: %s", ctime(&now));
+    } else if (millis() - timeRequestedAt >= NTP_SYNC_TIMEOUT_MS) {
+      waitingForTime = false;
+      LOG_W(Wifi, "[WifiManager] WARNING: NTP sync timed out - timestamps may be incorrect\n");
+    }
+  }
+  
+  // Status flips while an attempt is under way belong to the attempt
+  if (isConnecting()) return;
+  
+  if (retryPending && !isConnected() && (long)(millis() - retryAt) >= 0) {
+    retryPending = false;
+    if (autoConnect()) return;
+  }
+  
+  if (isConnected() && !connected) {
+    connected = true;
+    retryPending = false;
+    retryDelay = WIFI_RETRY_MIN_MS;
+    metrics.recordWifiReconnect();
+    LOG_I(Wifi, "[WifiManager] WiFi connected!\n");
+  } else if (!isConnected() && connected) {
+    connected = false;
+    metrics.recordWifiDisconnect();
+    LOG_I(Wifi, "[WifiManager] WiFi disconnected!\n");
+  }
+}
+
+void WifiManager::startAPMode(const char* ssid, const char* password) {
+  LOG_I(Wifi, "[WifiManager] Starting AP mode: %s\n", ssid);
+  
+  if (retryPending) {
+    // The stored network is retried alongside, keep the station on
+    WiFi.mode(WIFI_AP_STA);
+  } else {
+    // Stop any existing connection
+    WiFi.disconnect(true);
+    delay(100);
+    WiFi.mode(WIFI_AP);
+  }
+  WiFi.softAP(ssid, password);
+  
+  apModeActive = true;
+  
+  IPAddress apIP = WiFi.softAPIP();
+  LOG_I(Wifi, "[WifiManager] AP Mode started!\n");
+  LOG_I(Wifi, "[WifiManager] AP SSID: %s\n", ssid);
+  LOG_I(Wifi, "[WifiManager] AP IP: %s\n", apIP.toString().c_str());
+  LOG_I(Wifi, "[WifiManager] Clients can connect and access web interface at: http://%s\n", apIP.toString().c_str());
+}
+
+bool WifiManager::isAPModeActive() {
+  return apModeActive;
+}
+
+void WifiManager::saveCredentials(const char* ssid, const char* password) {
+  preferences.begin("wifi", false);
+  preferences.putString("ssid", ssid);
+  preferences.putString("password", password);
+  preferences.end();
+  metrics.recordNvsWrite("wifi", 2);
+  
+  LOG_I(Wifi, "[WifiManager] Credentials saved\n");
+}
+
+void WifiManager::loadCredentials(String& ssid, String& password) {
+  preferences.begin("wifi", true);
+  
+  ssid = preferences.getString("ssid", "");
+  password = preferences.getString("password", "");
+  
+  preferences.end();
+  
+  if (ssid.length() > 0) {
+    LOG_I(Wifi, "[WifiManager] Credentials loaded: SSID=%s\n", ssid.c_str());
+  }
+}
+
+void WifiManager::clearCredentials() {
+  preferences.begin("wifi", false);
+  preferences.clear();
+  preferences.end();
+  metrics.recordNvsWrite("wifi");
+  
+  LOG_I(Wifi, "[WifiManager] Credentials cleared\n");
+}
@@ -1,61 +1,135 @@
-#ifndef WIFI_MANAGER_H
-#define WIFI_MANAGER_H
-
-#include <Arduino.h>
-#include <WiFi.h>
-
-class WifiManager {
-public:
-  WifiManager();
-  
-  // Initialize WiFi manager
-  void begin();
-  
-  // Start WiFi setup (scanning networks)
-  void startSetup();
-  
-  // Connect to a network
-  bool connectToNetwork(const char* ssid, const char* password);
-  
-  // Try to auto-connect using stored credentials
-  bool autoConnect();
-  
-  // Check if connected
-  bool isConnected();
-  
-  // Get current SSID
-  String getSSID();
-  
-  // Get local IP
-  String getLocalIP();
-  
-  // Setup mDNS
-  bool setupMDNS(const char* hostname);
-  
-  // Get available networks as JSON
-  String getNetworksJSON();
-  
-  // Reset WiFi settings
-  void resetWiFi();
-  
-  // Handle WiFi events
-  void handleEvents();
-  
-  // Start WiFi hotspot (AP mode)
-  void startAPMode(const char* ssid, const char* password);
-  
-  // Check if in AP mode
-  bool isAPModeActive();
-  
-private:
-  bool connected = false;
-  String currentSSID = "";
-  bool apModeActive = false;
-  
-  // Store credentials in NVS
-  void saveCredentials(const char* ssid, const char* password);
-  void loadCredentials(String& ssid, String& password);
-  void clearCredentials();
-};
-
-#endif
+#ifndef WIFI_MANAGER_H
+#define WIFI_MANAGER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "JsonWriter.h"
+#include "config.h"
+
+enum WifiConnectState : uint8_t {
+  WIFI_JOB_IDLE,         // No attempt since boot
+  WIFI_JOB_CONNECTING,
+  WIFI_JOB_CONNECTED,
+  WIFI_JOB_FAILED
+};
+
+// One connection attempt, as the setup page polls it
+struct WifiConnectJob {
+  uint16_t id;
+  WifiConnectState state;
+  bool automatic;             // Stored credentials at boot, not a user request
+  char ssid[33];
+  uint8_t reason;             // Disconnect reason that ended it, 0 for a timeout
+  unsigned long startedAt;    // millis()
+  unsigned long duration;     // ms until it connected or failed
+};
+
+/*
+ * WiFi station and setup hotspot.
+ *
+ * Connecting never blocks: startConnect() only records the attempt, and
+ * handleEvents() (called from loop()) starts it and advances it from the WiFi
+ * events, which only set flags on the WiFi event task. An attempt fails on a
+ * definite disconnect reason (network not found, wrong password) or after
+ * WIFI_CONNECT_TIMEOUT_MS. While the setup hotspot is up the station connects
+ * alongside it, so the page that asked can follow the attempt; the hotspot
+ * is closed WIFI_AP_LINGER_MS after the connection succeeds, and started
+ * when an attempt fails with no other connection to fall back on. When the
+ * stored network cannot be reached, it is retried alongside the hotspot
+ * with a backoff from WIFI_RETRY_MIN_MS to WIFI_RETRY_MAX_MS.
+ */
+class WifiManager {
+public:
+  WifiManager();
+  
+  // Initialize WiFi manager: auto-connect in the background, or start the
+  // setup hotspot when there are no stored credentials
+  void begin();
+  
+  // Start WiFi setup (scanning networks)
+  void startSetup();
+  
+  // Start connecting to a network; the credentials are stored once it
+  // succeeds. Returns the job ID to poll with getConnectJob().
+  uint16_t startConnect(const char* ssid, const char* password);
+  
+  // Start connecting with the stored credentials; false if there are none
+  bool autoConnect();
+  
+  // The latest connection attempt
+  const WifiConnectJob& getConnectJob();
+  
+  // Check if connected
+  bool isConnected();
+  
+  // A connection attempt is in progress
+  bool isConnecting();
+  
+  // Get current SSID
+  String getSSID();
+  
+  // Get local IP
+  String getLocalIP();
+  
+  // Setup mDNS
+  bool setupMDNS(const char* hostname);
+  
+  // Scan and write available networks as a JSON array
+  void writeNetworksJSON(JsonWriter& json);
+  
+  // Reset WiFi settings
+  void resetWiFi();
+  
+  // Advance the connection attempt, track connection changes; call from loop()
+  void handleEvents();
+  
+  // Start WiFi hotspot (AP mode)
+  void startAPMode(const char* ssid, const char* password);
+  
+  // Check if in AP mode
+  bool isAPModeActive();
+  
+  static const char* stateName(WifiConnectState state);
+  
+  // Why a failed attempt failed
+  static const char* failureText(uint8_t reason);
+  
+private:
+  bool connected = false;
+  String currentSSID = "";
+  bool apModeActive = false;
+  
+  WifiConnectJob job = {};
+  char pendingPassword[65] = "";
+  bool beginPending = false;       // Radio not yet told about the job
+  bool apStopPending = false;
+  unsigned long apStopAt = 0;      // millis()
+  bool retryPending = false;       // Stored network to be tried again
+  unsigned long retryAt = 0;       // millis()
+  unsigned long retryDelay = WIFI_RETRY_MIN_MS;
+  bool timeConfigured = false;
+  bool waitingForTime = false;
+  unsigned long timeRequestedAt = 0;
+  
+  // Set on the WiFi event task, consumed by handleEvents()
+  volatile bool eventGotIP = false;
+  volatile bool eventDisconnected = false;
+  volatile uint8_t eventReason = 0;
+  
+  uint16_t queueConnect(const char* ssid, const char* password, bool automatic);
+  void onWiFiEvent(WiFiEvent_t event, WiFiEventInfo_t info);
+  void advanceConnect();
+  void finishConnect(bool success, uint8_t reason);
+  void scheduleRetry();
+  
+  // Time and mDNS once the station has an address
+  void onConnected();
+  
+
+  // Store credentials in NVS
+  void saveCredentials(const char* ssid, const char* password);
+  void loadCredentials(String& ssid, String& password);
+  void clearCredentials();
+};
+
+#endif
@@ -1,31 +1,108 @@
-#ifndef CONFIG_H
-#define CONFIG_H
-
-// I2C Configuration
-#define I2C_SDA 22
-#define I2C_SCL 23
-#define I2C_FREQ 100000
-
-// Sensor Configuration
-#define SENSOR_ADDRESS 0x29  // VL53L1X default I2C address
-#define MEASUREMENT_INTERVAL 900000  // 15 minutes in ms
-#define SAMPLES_PER_MEASUREMENT 5
-#define MAX_DISTANCE_MM 1000  // Maximum sensor range
-
-// Container Configuration
-#define CONTAINER_HEIGHT_MM 100
-
-// Data Storage
-#define MAX_DATA_POINTS 100  // Circular buffer size
-
-// Web Server
-#define WEB_SERVER_PORT 80
-#define MDNS_HOSTNAME "dough"
-
-// Serial Debug
-#define SERIAL_BAUD 115200
-
-// Sensor timeout
-#define SENSOR_TIMEOUT_MS 2000
-
-#endif
+#ifndef CONFIG_H
+#define CONFIG_H
+
+// I2C Configuration
+#define I2C_SDA 22
+#define I2C_SCL 23
+#define I2C_FREQ 100000
+
+// Sensor Configuration
+#define SENSOR_ADDRESS 0x29  // VL53L1X default I2C address
+#define MEASUREMENT_INTERVAL 900000  // 15 minutes in ms
+#define SAMPLES_PER_MEASUREMENT 5
+#define MAX_DISTANCE_MM 1000  // Maximum sensor range
+#define SENSOR_SWEEP_JOIN_MS 500  // Requests queued behind a sweep share its result
+#define MEASURE_FRESHNESS_MS 3000  // /api/measure reuses a sweep this recent
+
+// Container Configuration
+#define CONTAINER_HEIGHT_MM 100
+
+// Data Storage
+#ifndef MAX_DATA_POINTS
+#define MAX_DATA_POINTS 100  // Circular buffer size (host builds may override)
+#endif
+#define ROLLUP_HOURLY_SLOTS 168  // Hourly min/max/mean, one week
+#define ROLLUP_SIX_HOURLY_SLOTS 120  // 6-hourly min/max/mean, 30 days
+#define RISE_RATE_WINDOW 3600  // Seconds of measurements behind the current rise rate
+
+// Webhook thresholds
+#define WEBHOOK_MAX_THRESHOLDS 16  // Bits in the reached/armed state words
+#define WEBHOOK_MESSAGE_SIZE 96  // Message template buffer, including the terminator
+
+// Notification targets (Discord, ntfy, generic JSON, Home Assistant)
+#define NOTIFIER_MAX_TARGETS 4
+#define NOTIFIER_NAME_SIZE 24
+#define NOTIFIER_URL_SIZE 256
+#define NOTIFIER_TOKEN_SIZE 200  // Home Assistant long-lived tokens are ~183 characters
+#define NOTIFIER_TEMPLATE_SIZE 192  // Generic JSON body template
+#define NOTIFIER_TIMEOUT_MS 5000  // Per-request HTTP timeout
+#define NOTIFIER_TASK_STACK 8192  // Delivery task stack, enough for a TLS handshake
+
+// Notification outbox: undelivered notifications kept in NVS across reboots
+#define OUTBOX_CAPACITY 8
+#define OUTBOX_MAX_AGE_SECONDS (12UL * 3600)  // Dropped undelivered after this
+#define OUTBOX_RETRY_MIN_MS 30000UL  // Backoff after a failed round, doubling...
+#define OUTBOX_RETRY_MAX_MS (15UL * 60000)  // ...up to this
+#define OUTBOX_SAVE_INTERVAL_MS 60000UL  // Delivery progress is written at most this often
+#define DIGEST_WINDOW_SECONDS 0  // Default coalescing window; 0 merges only what is already waiting
+#define DIGEST_MAX_WINDOW_SECONDS 3600
+#define DIGEST_MESSAGE_SIZE 1024  // Longest digest message (Discord allows 2000 characters)
+
+// Heads-up notifications ahead of webhook thresholds
+#define HEADS_UP_LEAD_MINUTES 20  // Default warning time before a predicted crossing
+#define HEADS_UP_MAX_LEAD_MINUTES 240
+
+// WiFi
+#define WIFI_CONNECT_TIMEOUT_MS 20000UL  // A connection attempt fails after this
+#define WIFI_AP_SSID "DoughTracker"  // Setup hotspot when no network is configured or reachable
+#define WIFI_AP_PASSWORD "12345678"
+#define WIFI_AP_LINGER_MS 60000UL  // Hotspot stays up after connecting so the page can show the new address
+#define WIFI_RETRY_MIN_MS 30000UL   // Stored network unreachable at boot: first retry after this,
+#define WIFI_RETRY_MAX_MS 600000UL  // doubling up to this
+#define NTP_SYNC_TIMEOUT_MS 10000UL  // Warn if the clock is still unset this long after connecting
+
+// Web Server
+#define WEB_SERVER_PORT 80
+#define MDNS_HOSTNAME "dough"
+
+// Serial Debug
+#define SERIAL_BAUD 115200
+
+// Logging: compile-time level per module (0=off, 1=error, 2=warn, 3=info, 4=debug)
+// Calls above a module's level are compiled out entirely
+#ifndef LOG_LEVEL_MAIN
+#define LOG_LEVEL_MAIN 3
+#endif
+#ifndef LOG_LEVEL_SENSOR
+#define LOG_LEVEL_SENSOR 3
+#endif
+#ifndef LOG_LEVEL_CALIBRATION
+#define LOG_LEVEL_CALIBRATION 3
+#endif
+#ifndef LOG_LEVEL_DATA
+#define LOG_LEVEL_DATA 3
+#endif
+#ifndef LOG_LEVEL_WIFI
+#define LOG_LEVEL_WIFI 3
+#endif
+#ifndef LOG_LEVEL_WEBSERVER
+#define LOG_LEVEL_WEBSERVER 3
+#endif
+#ifndef LOG_LEVEL_WEBHOOK
+#define LOG_LEVEL_WEBHOOK 3
+#endif
+#ifndef LOG_LEVEL_METRICS
+#define LOG_LEVEL_METRICS 3
+#endif
+
+// Log ring buffer (bytes); queued messages are drained to Serial during idle time
+#define LOG_BUFFER_SIZE 4096
+
+// Recent log history kept in RAM for the /logs WebSocket (bytes, oldest overwritten first)
+#define LOG_HISTORY_SIZE 8192
+#define LOG_STREAM_MAX_CLIENTS 2
+
+// Sensor timeout
+#define SENSOR_TIMEOUT_MS 2000
+
+#endif
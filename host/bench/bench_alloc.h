@@ -0,0 +1,29 @@
+#ifndef BENCH_ALLOC_H
+#define BENCH_ALLOC_H
+
+#include <benchmark/benchmark.h>
+#include <stddef.h>
+
+// Heap allocations made through operator new (String, std containers) since start
+size_t benchAllocationCount();
+size_t benchAllocatedBytes();
+
+// Scope helper: reports allocations and bytes per iteration as benchmark counters
+class AllocationCounter {
+public:
+  explicit AllocationCounter(benchmark::State& state)
+      : state(state), count(benchAllocationCount()), bytes(benchAllocatedBytes()) {}
+  ~AllocationCounter() {
+    state.counters["allocs"] = benchmark::Counter(
+        (double)(benchAllocationCount() - count), benchmark::Counter::kAvgIterations);
+    state.counters["heap_bytes"] = benchmark::Counter(
+        (double)(benchAllocatedBytes() - bytes), benchmark::Counter::kAvgIterations);
+  }
+
+private:
+  benchmark::State& state;
+  size_t count;
+  size_t bytes;
+};
+
+#endif
@@ -0,0 +1,191 @@
+#include <benchmark/benchmark.h>
+#include "DataManager.h"
+#include "CalibrationManager.h"
+#include "SensorManager.h"
+#include "WifiManager.h"
+#include "WebhookManager.h"
+#include "MyWebServer.h"
+#include "config.h"
+#include "bench_alloc.h"
+
+// /data and DataManager::writeMeasurementsJSON serialization, 100 to 10,000 points
+
+static SensorManager sensorMgr;
+static CalibrationManager calibMgr;
+static DataManager dataMgr;
+static WifiManager wifiMgr;
+static WebhookManager webhookMgr;
+static MyWebServer webServer(&sensorMgr, &calibMgr, &dataMgr, &wifiMgr, &webhookMgr);
+
+static void fillMeasurements(uint16_t points) {
+  dataMgr.reset();
+  for (uint16_t i = 0; i < points; i++) {
+    // One measurement every 15 minutes on the virtual clock
+    hostClockAdvance(MEASUREMENT_INTERVAL);
+    // A smooth rise from 40 mm towards ~110 mm with some sensor jitter
+    uint16_t thickness = 40 + (i * 70) / points + (i % 3);
+    float rise = (thickness - 40) * 100.0f / 40.0f;
+    dataMgr.addMeasurement(thickness, rise);
+  }
+}
+
+static WebServer* hostServer() {
+  static bool started = false;
+  if (!started) {
+    webServer.begin();
+    started = true;
+  }
+  return WebServer::hostFind(WEB_SERVER_PORT);
+}
+
+static void BM_DataManagerJSON(benchmark::State& state) {
+  fillMeasurements(state.range(0));
+  size_t bytes = 0;
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    // Stream into a discarding sink, as handleData does into sendContent
+    char buffer[512];
+    bytes = 0;
+    JsonWriter json(buffer, sizeof(buffer), [](const char* data, size_t length, void* context) {
+      benchmark::DoNotOptimize(data);
+      *static_cast<size_t*>(context) += length;
+    }, &bytes);
+    dataMgr.writeMeasurementsJSON(json);
+    json.flush();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_DataManagerJSON)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMicrosecond);
+
+// Downsampled to a 400 px wide chart
+static void BM_DataManagerJSONDownsampled(benchmark::State& state) {
+  fillMeasurements(state.range(0));
+  size_t bytes = 0;
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    char buffer[512];
+    bytes = 0;
+    JsonWriter json(buffer, sizeof(buffer), [](const char* data, size_t length, void* context) {
+      benchmark::DoNotOptimize(data);
+      *static_cast<size_t*>(context) += length;
+    }, &bytes);
+    dataMgr.writeMeasurementsJSON(json, 400);
+    json.flush();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_DataManagerJSONDownsampled)->RangeMultiplier(10)->Range(1000, 10000)->Unit(benchmark::kMicrosecond);
+
+// Last two hours out of the whole ring: binary search plus the range itself
+static void BM_RangeQuery(benchmark::State& state) {
+  fillMeasurements(state.range(0));
+  unsigned long to = hostClockNow();
+  unsigned long from = to - 2 * 3600;
+  size_t points = 0;
+  for (auto _ : state) {
+    points = 0;
+    for (const DataPoint& dp : dataMgr.range(from, to)) {
+      benchmark::DoNotOptimize(&dp);
+      points++;
+    }
+  }
+  state.counters["points"] = points;
+}
+BENCHMARK(BM_RangeQuery)->RangeMultiplier(10)->Range(100, 10000);
+
+// The same selection by scanning every stored point
+static void BM_RangeScan(benchmark::State& state) {
+  fillMeasurements(state.range(0));
+  unsigned long to = hostClockNow();
+  unsigned long from = to - 2 * 3600;
+  size_t points = 0;
+  for (auto _ : state) {
+    points = 0;
+    for (const DataPoint& dp : dataMgr.all()) {
+      if (dp.timestamp >= from && dp.timestamp <= to) {
+        benchmark::DoNotOptimize(&dp);
+        points++;
+      }
+    }
+  }
+  state.counters["points"] = points;
+}
+BENCHMARK(BM_RangeScan)->RangeMultiplier(10)->Range(100, 10000);
+
+static void BM_HandleData(benchmark::State& state) {
+  WebServer* server = hostServer();
+  fillMeasurements(state.range(0));
+  size_t bytes = 0;
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    WebServer::Response response = server->dispatch(HTTP_GET, "/data");
+    bytes = response.body.length();
+    benchmark::DoNotOptimize(response.body.c_str());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_HandleData)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMicrosecond);
+
+static void BM_HandleStatus(benchmark::State& state) {
+  WebServer* server = hostServer();
+  fillMeasurements(100);
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    WebServer::Response response = server->dispatch(HTTP_GET, "/status");
+    benchmark::DoNotOptimize(response.body.c_str());
+  }
+}
+BENCHMARK(BM_HandleStatus)->Unit(benchmark::kMicrosecond);
+
+// Device-side cost of the page's first paint: the four API requests the page
+// used to make, against the single /api/bootstrap that replaces them
+static void BM_FirstPaintSeparate(benchmark::State& state) {
+  WebServer* server = hostServer();
+  fillMeasurements(state.range(0));
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(server->dispatch(HTTP_GET, "/data").body.c_str());
+    benchmark::DoNotOptimize(server->dispatch(HTTP_GET, "/status").body.c_str());
+    benchmark::DoNotOptimize(server->dispatch(HTTP_GET, "/api/webhook").body.c_str());
+    benchmark::DoNotOptimize(server->dispatch(HTTP_GET, "/api/presets").body.c_str());
+  }
+}
+BENCHMARK(BM_FirstPaintSeparate)->Arg(100)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+static void BM_FirstPaintBootstrap(benchmark::State& state) {
+  WebServer* server = hostServer();
+  fillMeasurements(state.range(0));
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    WebServer::Response response = server->dispatch(HTTP_GET, "/api/bootstrap");
+    benchmark::DoNotOptimize(response.body.c_str());
+  }
+}
+BENCHMARK(BM_FirstPaintBootstrap)->Arg(100)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+static void BM_AddMeasurement(benchmark::State& state) {
+  dataMgr.reset();
+  uint16_t i = 0;
+  for (auto _ : state) {
+    dataMgr.addMeasurement(40 + (i++ % 60), 12.5f);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AddMeasurement);
+
+// One filter step of the rise forecast, the per-measurement cost it adds
+static void BM_ForecastUpdate(benchmark::State& state) {
+  RiseForecast forecast;
+  unsigned long t = 1700000000;
+  uint16_t i = 0;
+  for (auto _ : state) {
+    forecast.update(t, 150.0f / (1.0f + expf(-(i - 16) / 4.0f)));
+    t += MEASUREMENT_INTERVAL / 1000;
+    i = (i + 1) % 64;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ForecastUpdate);
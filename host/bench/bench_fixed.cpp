@@ -0,0 +1,108 @@
+#include <benchmark/benchmark.h>
+#include <math.h>
+#include "FixedPoint.h"
+#include "JsonWriter.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Fixed-point rise pipeline against the float code it replaced. The host
+// has an FPU, so these understate the gap on the ESP32-C6, where every float
+// operation is a soft-float call; compare the cycles counters, not ratios
+// from other machines.
+
+static uint64_t readCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+// Average TSC cycles per item over the timed loop
+class CycleCounter {
+public:
+  explicit CycleCounter(benchmark::State& state) : state(state), start(readCycles()) {}
+  ~CycleCounter() {
+    if (state.iterations() > 0 && start != 0) {
+      state.counters["cycles"] = (double)(readCycles() - start) / state.iterations();
+    }
+  }
+
+private:
+  benchmark::State& state;
+  uint64_t start;
+};
+
+static float floatRise(uint16_t current, uint16_t initial) {
+  if (initial == 0) return 0.0;
+  return ((float)(current - initial) / initial) * 100.0;
+}
+
+static void BM_RiseFloat(benchmark::State& state) {
+  uint16_t current = 40;
+  CycleCounter cycles(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(floatRise(current, 40));
+    current = current < 160 ? current + 1 : 40;
+  }
+}
+BENCHMARK(BM_RiseFloat);
+
+static void BM_RiseFixed(benchmark::State& state) {
+  uint16_t current = 40;
+  CycleCounter cycles(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(riseFromThickness(current, 40));
+    current = current < 160 ? current + 1 : 40;
+  }
+}
+BENCHMARK(BM_RiseFixed);
+
+static void BM_DeviationFloat(benchmark::State& state) {
+  uint16_t value = 150;
+  CycleCounter cycles(state);
+  for (auto _ : state) {
+    float deviation = fabsf((float)value - 180.0f) / 180.0f;
+    benchmark::DoNotOptimize(deviation <= 0.12f);
+    value = value < 210 ? value + 1 : 150;
+  }
+}
+BENCHMARK(BM_DeviationFloat);
+
+static void BM_DeviationFixed(benchmark::State& state) {
+  uint16_t value = 150;
+  CycleCounter cycles(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(withinDeviation(value, 180, 120));
+    value = value < 210 ? value + 1 : 150;
+  }
+}
+BENCHMARK(BM_DeviationFixed);
+
+// Serializing one rise value, as /data does for every point
+static void BM_JsonRiseFloat(benchmark::State& state) {
+  char buffer[64];
+  float rise = 0.0f;
+  CycleCounter cycles(state);
+  for (auto _ : state) {
+    JsonWriter json(buffer, sizeof(buffer));
+    json.value(rise);
+    benchmark::DoNotOptimize(json.length());
+    rise = rise < 300.0f ? rise + 1.37f : 0.0f;
+  }
+}
+BENCHMARK(BM_JsonRiseFloat);
+
+static void BM_JsonRiseFixed(benchmark::State& state) {
+  char buffer[64];
+  RiseFixed rise = 0;
+  CycleCounter cycles(state);
+  for (auto _ : state) {
+    JsonWriter json(buffer, sizeof(buffer));
+    json.valueFixed(rise, RISE_DECIMALS);
+    benchmark::DoNotOptimize(json.length());
+    rise = rise < 30000 ? rise + 137 : 0;
+  }
+}
+BENCHMARK(BM_JsonRiseFixed);
@@ -0,0 +1,62 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include "JsonParser.h"
+#include "bench_alloc.h"
+
+// Request body parsing: typical UI bodies, reordered/escaped input and rejection paths
+
+static void BM_ParseConnectWiFi(benchmark::State& state) {
+  const char* body = "{\"ssid\":\"Home Network\",\"password\":\"correct horse battery\"}";
+  size_t length = strlen(body);
+  char ssid[33];
+  char password[65];
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    JsonField fields[] = {
+      JsonParser::stringField("ssid", ssid, sizeof(ssid), 1),
+      JsonParser::stringField("password", password, sizeof(password)),
+    };
+    JsonParser parser;
+    benchmark::DoNotOptimize(parser.parse(body, length, fields, 2));
+  }
+  state.SetBytesProcessed(state.iterations() * length);
+}
+BENCHMARK(BM_ParseConnectWiFi);
+
+static void BM_ParseWebhookEscaped(benchmark::State& state) {
+  // Reordered keys, whitespace, escapes and an unknown nested member
+  const char* body =
+      "{ \"enabled\" : true,\n  \"meta\": {\"tags\": [\"a\", \"b\"]},\n"
+      "  \"url\" : \"https:\\/\\/discord.com\\/api\\/webhooks\\/123456789012345678\\/"
+      "AbCdEfGhIjKlMnOpQrStUvWxYz0123456789_-AbCdEfGhIjKlMnOpQrStUvWxYz\" }";
+  size_t length = strlen(body);
+  char url[256];
+  bool enabled;
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    JsonField fields[] = {
+      JsonParser::stringField("url", url, sizeof(url), 0, false),
+      JsonParser::boolField("enabled", &enabled, false),
+    };
+    JsonParser parser;
+    benchmark::DoNotOptimize(parser.parse(body, length, fields, 2));
+  }
+  state.SetBytesProcessed(state.iterations() * length);
+}
+BENCHMARK(BM_ParseWebhookEscaped);
+
+static void BM_ParseRejectOversized(benchmark::State& state) {
+  // A 40-character SSID is rejected after scanning the whole string
+  std::string body = "{\"ssid\":\"" + std::string(40, 'x') + "\",\"password\":\"\"}";
+  char ssid[33];
+  char password[65];
+  for (auto _ : state) {
+    JsonField fields[] = {
+      JsonParser::stringField("ssid", ssid, sizeof(ssid), 1),
+      JsonParser::stringField("password", password, sizeof(password)),
+    };
+    JsonParser parser;
+    benchmark::DoNotOptimize(parser.parse(body.c_str(), body.length(), fields, 2));
+  }
+}
+BENCHMARK(BM_ParseRejectOversized);
@@ -0,0 +1,49 @@
+#include <Arduino.h>
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+#include "bench_alloc.h"
+
+// Count every operator new so benchmarks can report heap churn per call
+static std::atomic<size_t> allocationCount{0};
+static std::atomic<size_t> allocatedBytes{0};
+
+size_t benchAllocationCount() {
+  return allocationCount.load(std::memory_order_relaxed);
+}
+
+size_t benchAllocatedBytes() {
+  return allocatedBytes.load(std::memory_order_relaxed);
+}
+
+void* operator new(size_t size) {
+  allocationCount.fetch_add(1, std::memory_order_relaxed);
+  allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+  void* p = malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) noexcept {
+  free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  free(p);
+}
+
+// Normally provided by doughtracker.ino; MyWebServer calls it after dough calibration
+void resetMeasurementTimer() {
+}
+
+int main(int argc, char** argv) {
+  // Firmware logging would dominate every measurement; benchmark the logic only
+  Serial.setOutput(nullptr);
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,27 @@
+#include <benchmark/benchmark.h>
+#include "SensorManager.h"
+
+// SensorManager median/outlier filter over one sweep of samples
+
+static void BM_FilterSamples(benchmark::State& state) {
+  const uint8_t count = state.range(0);
+  // Mostly stable readings around 180 mm with one far outlier per sweep
+  uint16_t pattern[10] = {181, 179, 180, 240, 182, 178, 180, 181, 120, 179};
+  uint16_t samples[10];
+  for (auto _ : state) {
+    memcpy(samples, pattern, sizeof(samples));
+    benchmark::DoNotOptimize(SensorManager::filterSamples(samples, count));
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_FilterSamples)->DenseRange(5, 10, 5);
+
+static void BM_FilterSamplesNoOutliers(benchmark::State& state) {
+  uint16_t samples[5];
+  for (auto _ : state) {
+    for (uint8_t i = 0; i < 5; i++) samples[i] = 180 + i;
+    benchmark::DoNotOptimize(SensorManager::filterSamples(samples, 5));
+  }
+  state.SetItemsProcessed(state.iterations() * 5);
+}
+BENCHMARK(BM_FilterSamplesNoOutliers);
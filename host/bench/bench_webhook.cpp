@@ -0,0 +1,83 @@
+#include <benchmark/benchmark.h>
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include "WebhookManager.h"
+
+// WebhookManager threshold evaluation over a full fermentation sweep
+
+static int acceptAll(const HTTPClient::HostRequest& request, String& response, void* context) {
+  (void)request;
+  (void)context;
+  response = "";
+  return 204;
+}
+
+static void BM_CheckAndNotifySweep(benchmark::State& state) {
+  // 96 samples = 24 hours at the 15 minute measurement interval
+  const int samples = 96;
+  WebhookManager webhook;
+  webhook.begin();
+  webhook.setWebhookURL("http://127.0.0.1/webhook");
+  webhook.setEnabled(true);
+  WiFi.hostSetStatus(WL_CONNECTED);
+  HTTPClient::hostSetTransport(acceptAll, nullptr);
+
+  for (auto _ : state) {
+    webhook.resetThresholds();
+    for (int i = 0; i < samples; i++) {
+      webhook.checkAndNotify(riseFromPercent(i * 2.5f));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * samples);
+
+  HTTPClient::hostSetTransport(nullptr, nullptr);
+}
+BENCHMARK(BM_CheckAndNotifySweep)->Unit(benchmark::kMicrosecond);
+
+static void BM_CheckAndNotifyIdle(benchmark::State& state) {
+  // Steady state: every threshold already reached, nothing to send
+  WebhookManager webhook;
+  webhook.begin();
+  webhook.setWebhookURL("http://127.0.0.1/webhook");
+  webhook.setEnabled(true);
+  WiFi.hostSetStatus(WL_CONNECTED);
+  HTTPClient::hostSetTransport(acceptAll, nullptr);
+  webhook.checkAndNotify(250 * RISE_SCALE);
+  webhook.checkAndNotify(250 * RISE_SCALE);
+  webhook.checkAndNotify(250 * RISE_SCALE);
+
+  for (auto _ : state) {
+    webhook.checkAndNotify(250 * RISE_SCALE);
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  HTTPClient::hostSetTransport(nullptr, nullptr);
+}
+BENCHMARK(BM_CheckAndNotifyIdle);
+
+static void BM_CheckAndNotifyFullTable(benchmark::State& state) {
+  // WEBHOOK_MAX_THRESHOLDS thresholds, a quarter of them falling, in the
+  // middle of the rise: the single pass stops at the first unreached one
+  WebhookThreshold thresholds[WEBHOOK_MAX_THRESHOLDS];
+  for (uint8_t i = 0; i < WEBHOOK_MAX_THRESHOLDS; i++) {
+    thresholds[i].falling = i % 4 == 3;
+    thresholds[i].rise = (thresholds[i].falling ? 100 + i * 10 : 25 + i * 20) * RISE_SCALE;
+    snprintf(thresholds[i].message, sizeof(thresholds[i].message), "Threshold %u", i);
+  }
+  WebhookManager webhook;
+  webhook.begin();
+  webhook.setWebhookURL("http://127.0.0.1/webhook");
+  webhook.setEnabled(true);
+  webhook.setThresholds(thresholds, WEBHOOK_MAX_THRESHOLDS);
+  WiFi.hostSetStatus(WL_CONNECTED);
+  HTTPClient::hostSetTransport(acceptAll, nullptr);
+  webhook.checkAndNotify(180 * RISE_SCALE);
+
+  for (auto _ : state) {
+    webhook.checkAndNotify(180 * RISE_SCALE);
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  HTTPClient::hostSetTransport(nullptr, nullptr);
+}
+BENCHMARK(BM_CheckAndNotifyFullTable);
@@ -0,0 +1,112 @@
+#include "LoopbackHttp.h"
+#include <netdb.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <chrono>
+#include <string>
+
+typedef std::chrono::steady_clock Clock;
+
+// Split http://host[:port][/path]; IPv6 hosts are bracketed
+static bool parseURL(const std::string& url, std::string& host, std::string& port, std::string& path) {
+  const std::string scheme = "http://";
+  if (url.compare(0, scheme.size(), scheme) != 0) return false;
+  size_t start = scheme.size();
+  size_t slash = url.find('/', start);
+  std::string authority = url.substr(start, slash == std::string::npos ? std::string::npos : slash - start);
+  path = slash == std::string::npos ? "/" : url.substr(slash);
+  port = "80";
+
+  if (!authority.empty() && authority[0] == '[') {
+    size_t close = authority.find(']');
+    if (close == std::string::npos) return false;
+    host = authority.substr(1, close - 1);
+    if (close + 1 < authority.size() && authority[close + 1] == ':') port = authority.substr(close + 2);
+  } else {
+    size_t colon = authority.find(':');
+    host = authority.substr(0, colon);
+    if (colon != std::string::npos) port = authority.substr(colon + 1);
+  }
+  return !host.empty() && !port.empty();
+}
+
+bool isLoopbackURL(const String& url) {
+  std::string host, port, path;
+  if (!parseURL(url.c_str(), host, port, path)) return false;
+  return host == "localhost" || host == "::1" || host.compare(0, 4, "127.") == 0;
+}
+
+static int connectTo(const std::string& host, const std::string& port) {
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo* result = nullptr;
+  if (getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0) return -1;
+
+  int fd = -1;
+  for (struct addrinfo* ai = result; ai; ai = ai->ai_next) {
+    fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (fd < 0) continue;
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) break;
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(result);
+  return fd;
+}
+
+int sendLoopbackRequest(const HTTPClient::HostRequest& request, String& response) {
+  response = "";
+  std::string host, port, path;
+  if (!isLoopbackURL(request.url) || !parseURL(request.url.c_str(), host, port, path)) {
+    return HTTPC_ERROR_CONNECTION_REFUSED;
+  }
+  Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(request.timeoutMs);
+
+  int fd = connectTo(host, port);
+  if (fd < 0) return HTTPC_ERROR_CONNECTION_REFUSED;
+
+  std::string message = std::string(request.method.c_str()) + " " + path + " HTTP/1.1\r\nHost: " +
+                        host + ":" + port + "\r\nConnection: close\r\n" + request.headers.c_str() +
+                        "Content-Length: " + std::to_string(request.payload.length()) + "\r\n\r\n" +
+                        request.payload.c_str();
+  const char* data = message.data();
+  size_t remaining = message.size();
+  while (remaining > 0) {
+    ssize_t sent = send(fd, data, remaining, MSG_NOSIGNAL);
+    if (sent <= 0) {
+      close(fd);
+      return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+    }
+    data += sent;
+    remaining -= sent;
+  }
+
+  // The server closes the connection after the response
+  std::string received;
+  char buffer[2048];
+  while (true) {
+    long waitMs = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+    struct pollfd pfd = {fd, POLLIN, 0};
+    if (waitMs <= 0 || poll(&pfd, 1, (int)waitMs) <= 0) {
+      close(fd);
+      return HTTPC_ERROR_READ_TIMEOUT;
+    }
+    ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+    if (n <= 0) break;
+    received.append(buffer, n);
+  }
+  close(fd);
+
+  if (received.compare(0, 5, "HTTP/") != 0 || received.size() < 12) return HTTPC_ERROR_CONNECTION_REFUSED;
+  size_t bodyStart = received.find("\r\n\r\n");
+  if (bodyStart != std::string::npos) response = received.substr(bodyStart + 4).c_str();
+  return atoi(received.c_str() + 9);
+}
@@ -0,0 +1,23 @@
+#ifndef LOOPBACK_HTTP_H
+#define LOOPBACK_HTTP_H
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+
+/*
+ * Real HTTP for the emulated HTTPClient, limited to this machine.
+ *
+ * Requests to http://localhost, 127.x.x.x or [::1] go out over a socket
+ * (one request per connection, as the device's HTTPClient does), so the
+ * firmware can talk to a local stand-in such as doughtracker_webhook_sink.
+ * The request timeout is applied in real milliseconds.
+ */
+
+// True if the URL is plain HTTP to a loopback host
+bool isLoopbackURL(const String& url);
+
+// Send the request and read the response body. Returns the HTTP status code
+// or a negative HTTPC_ERROR_* code, like HTTPClient.
+int sendLoopbackRequest(const HTTPClient::HostRequest& request, String& response);
+
+#endif
@@ -0,0 +1,91 @@
+#include "SimulatedSensor.h"
+#include <VL53L1X.h>
+#include "config.h"
+#include <math.h>
+
+SimulatedSensor::SimulatedSensor() : rng(1234) {
+}
+
+void SimulatedSensor::install() {
+  VL53L1X::hostSetSource(readCallback, this);
+}
+
+void SimulatedSensor::setDistance(float distanceMm) {
+  distance = distanceMm;
+}
+
+float SimulatedSensor::getDistance() {
+  return distance;
+}
+
+void SimulatedSensor::setNoise(float stddevMm) {
+  noise = stddevMm < 0 ? 0 : stddevMm;
+}
+
+void SimulatedSensor::setOutlierRate(float rate) {
+  outlierRate = rate;
+}
+
+void SimulatedSensor::setFailureRate(float rate) {
+  failureRate = rate;
+}
+
+void SimulatedSensor::startFerment(const FermentProfile& profile) {
+  ferment = profile;
+  fermentStart = hostClockNow();
+  fermenting = true;
+  distance = ferment.emptyDistance - ferment.doughThickness;
+}
+
+bool SimulatedSensor::isFermenting() {
+  return fermenting;
+}
+
+float SimulatedSensor::riseAt(float hours) {
+  // Logistic curve shifted so the rise is exactly 0 at t = 0
+  float k = ferment.steepness;
+  float mid = ferment.midpointHours;
+  float start = 1.0f / (1.0f + expf(k * mid));
+  float now = 1.0f / (1.0f + expf(-k * (hours - mid)));
+  float rise = ferment.peakRise * (now - start) / (1.0f - start);
+
+  // Past twice the midpoint the starter is spent and starts to fall
+  float plateauEnd = 2.0f * mid;
+  if (ferment.collapseRate > 0 && hours > plateauEnd) {
+    rise -= ferment.collapseRate * (hours - plateauEnd);
+    if (rise < 0) rise = 0;
+  }
+  return rise;
+}
+
+uint16_t SimulatedSensor::read() {
+  if (fermenting) {
+    float hours = (hostClockNow() - fermentStart) / 3600.0f;
+    float thickness = ferment.doughThickness * (1.0f + riseAt(hours) / 100.0f);
+    distance = ferment.emptyDistance - thickness;
+  }
+
+  std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+  if (chance(rng) < failureRate) {
+    return 0;
+  }
+
+  float value = distance;
+  if (noise > 0) {
+    std::normal_distribution<float> jitter(0.0f, noise);
+    value += jitter(rng);
+  }
+
+  // Stray reflections off the container wall read well short or long
+  if (chance(rng) < outlierRate) {
+    value *= chance(rng) < 0.5f ? 0.7f : 1.3f;
+  }
+
+  if (value < 1) value = 1;
+  if (value > MAX_DISTANCE_MM) value = MAX_DISTANCE_MM;
+  return (uint16_t)(value + 0.5f);
+}
+
+uint16_t SimulatedSensor::readCallback(void* context) {
+  return static_cast<SimulatedSensor*>(context)->read();
+}
@@ -0,0 +1,67 @@
+#ifndef SIMULATED_SENSOR_H
+#define SIMULATED_SENSOR_H
+
+#include <Arduino.h>
+#include <random>
+
+/*
+ * Distance source for the emulated VL53L1X.
+ *
+ * Produces the configured distance plus Gaussian noise, with occasional
+ * outliers and failed reads, so SensorManager's filtering runs as on the
+ * device. Once a ferment is started the surface follows a logistic rise
+ * curve over virtual time (hostClockNow), optionally collapsing after the
+ * plateau.
+ */
+
+struct FermentProfile {
+  float emptyDistance = 180.0;   // Sensor to container floor, mm
+  float doughThickness = 40.0;   // Fresh dough layer, mm
+  float peakRise = 150.0;        // Plateau rise in percent
+  float midpointHours = 4.0;     // Time to half of the plateau rise
+  float steepness = 1.2;         // Logistic growth rate, 1/h
+  float collapseRate = 0.0;      // Fall after the plateau, percent per hour
+};
+
+class SimulatedSensor {
+public:
+  SimulatedSensor();
+
+  // Install as the VL53L1X reading source
+  void install();
+
+  // Distance from sensor to surface in mm
+  void setDistance(float distanceMm);
+  float getDistance();
+
+  // Standard deviation of per-sample noise in mm
+  void setNoise(float stddevMm);
+
+  // Probability (0-1) of a sample being a far outlier or a failed read
+  void setOutlierRate(float rate);
+  void setFailureRate(float rate);
+
+  // Start following the profile from the current virtual time
+  void startFerment(const FermentProfile& profile);
+  bool isFermenting();
+
+  // Rise in percent the profile prescribes after the given hours
+  float riseAt(float hours);
+
+  // Take one sample (0 = failed read)
+  uint16_t read();
+
+private:
+  float distance = 150.0;
+  bool fermenting = false;
+  FermentProfile ferment;
+  time_t fermentStart = 0;
+  float noise = 1.0;
+  float outlierRate = 0.02;
+  float failureRate = 0.01;
+  std::mt19937 rng;
+
+  static uint16_t readCallback(void* context);
+};
+
+#endif
@@ -0,0 +1,3 @@
+// Compiles the sketch as an ordinary translation unit so the emulator links the
+// real setup()/loop()/serialEvent() and global manager instances
+#include "../../doughtracker.ino"
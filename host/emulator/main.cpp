@@ -0,0 +1,264 @@
+/*
+ * Dough Tracker device emulator
+ *
+ * Runs the real firmware (doughtracker.ino setup()/loop(), every manager and
+ * MyWebServer) on Linux. The web server is served on a local TCP port, NVS
+ * is backed by a file, the VL53L1X is simulated and serial commands are read
+ * from stdin.
+ *
+ * With --time-scale the whole firmware runs on accelerated virtual time
+ * (scheduler, millis(), time() stamps), and --ferment calibrates through the
+ * real HTTP handlers and then feeds a logistic rise curve to the sensor, so a
+ * full fermentation including webhook thresholds plays out in minutes.
+ * Webhooks to a loopback URL are delivered for real, e.g. to
+ * doughtracker_webhook_sink.
+ *
+ *   doughtracker_emulator [--port 8080] [--state doughtracker-nvs.txt]
+ *                         [--distance 150] [--noise 1.0] [--ap] [--wifi-delay 2000]
+ *                         [--trace] [--quiet]
+ *                         [--time-scale 1] [--ferment] [--hours H] [--webhook URL]
+ */
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <WebServer.h>
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include <malloc.h>
+#include <signal.h>
+#include <unistd.h>
+#include <map>
+#include <string>
+#include "LoopbackHttp.h"
+#include "SimulatedSensor.h"
+#include "config.h"
+
+// Provided by doughtracker.ino
+void setup();
+void loop();
+void serialEvent();
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onSignal(int) {
+  stopRequested = 1;
+}
+
+struct RouteStats {
+  unsigned long count = 0;
+  unsigned long long totalUs = 0;
+  unsigned long maxUs = 0;
+  unsigned long long bytes = 0;
+};
+
+static std::map<std::string, RouteStats> routeStats;
+static bool traceRequests = false;
+
+static const char* methodName(HTTPMethod method) {
+  switch (method) {
+    case HTTP_GET: return "GET";
+    case HTTP_HEAD: return "HEAD";
+    case HTTP_POST: return "POST";
+    case HTTP_PUT: return "PUT";
+    case HTTP_PATCH: return "PATCH";
+    case HTTP_DELETE: return "DELETE";
+    case HTTP_OPTIONS: return "OPTIONS";
+    default: return "ANY";
+  }
+}
+
+static void onRequest(HTTPMethod method, const String& uri, int code, size_t bytes,
+                      unsigned long durationUs, void* context) {
+  (void)context;
+  std::string key = std::string(methodName(method)) + " " + uri.c_str();
+  RouteStats& stats = routeStats[key];
+  stats.count++;
+  stats.totalUs += durationUs;
+  stats.bytes += bytes;
+  if (durationUs > stats.maxUs) stats.maxUs = durationUs;
+
+  if (traceRequests) {
+    struct mallinfo2 info = mallinfo2();
+    fprintf(stderr, "[Emulator] %s -> %d, %zu bytes, %.3f ms, heap in use %zu bytes, free heap %u\n",
+            key.c_str(), code, bytes, durationUs / 1000.0, info.uordblks, ESP.getFreeHeap());
+  }
+}
+
+static void printSummary() {
+  fprintf(stderr, "\n[Emulator] Request summary\n");
+  fprintf(stderr, "  %-28s %8s %10s %10s %12s\n", "route", "count", "mean ms", "max ms", "bytes");
+  for (const auto& entry : routeStats) {
+    const RouteStats& s = entry.second;
+    fprintf(stderr, "  %-28s %8lu %10.3f %10.3f %12llu\n", entry.first.c_str(), s.count,
+            s.totalUs / 1000.0 / s.count, s.maxUs / 1000.0, s.bytes);
+  }
+  fprintf(stderr, "  minimum free heap: %u bytes\n", ESP.getMinFreeHeap());
+}
+
+// Webhook deliveries are logged. Those to a loopback URL (a local sink) are
+// really sent; anything else is acknowledged without leaving the machine.
+static int logWebhook(const HTTPClient::HostRequest& request, String& response, void* context) {
+  response = "";
+  double hours = (hostClockNow() - *(time_t*)context) / 3600.0;
+  int code = 204;
+  if (isLoopbackURL(request.url)) {
+    code = sendLoopbackRequest(request, response);
+  }
+  fprintf(stderr, "[Emulator] +%.2fh webhook %s %s -> %d %s\n", hours, request.method.c_str(),
+          request.url.c_str(), code, request.payload.c_str());
+  return code;
+}
+
+static WebServer::Response request(HTTPMethod method, const char* uri, const char* body = "") {
+  WebServer* server = WebServer::hostFind(WEB_SERVER_PORT);
+  WebServer::Response response = server->dispatch(method, uri, body);
+  fprintf(stderr, "[Emulator] %s -> %d %s\n", uri, response.code, response.body.c_str());
+  return response;
+}
+
+// Walk the calibration flow a user would follow in the UI, then add dough
+static bool startFerment(SimulatedSensor& sensor, const FermentProfile& profile) {
+  sensor.setDistance(profile.emptyDistance);
+  if (request(HTTP_POST, "/api/calibrate").code != 200) return false;
+
+  sensor.startFerment(profile);
+  if (request(HTTP_POST, "/api/calibrate-dough").code != 200) return false;
+  return true;
+}
+
+static void usage(const char* argv0) {
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  --port N        TCP port for the web server (default 8080)\n"
+          "  --state FILE    file backing NVS/Preferences (default doughtracker-nvs.txt)\n"
+          "  --distance MM   simulated sensor distance (default 150)\n"
+          "  --noise MM      simulated sensor noise, std dev (default 1.0)\n"
+          "  --ap            boot without WiFi credentials (AP setup mode)\n"
+          "  --wifi-delay MS time a WiFi connection attempt takes (default 2000)\n"
+          "  --trace         log latency and heap use of every request to stderr\n"
+          "  --quiet         silence firmware serial output\n"
+          "  --time-scale X  run virtual time X times faster than real time\n"
+          "  --ferment       calibrate and simulate a logistic rise after boot\n"
+          "  --peak-rise P   plateau rise in percent (default 150)\n"
+          "  --midpoint H    hours to half the plateau rise (default 4)\n"
+          "  --collapse R    fall after the plateau in percent per hour (default 0)\n"
+          "  --hours H       exit after H hours of virtual time\n"
+          "  --webhook URL   configure the webhook URL through /api/webhook; http://localhost\n"
+          "                  and 127.x URLs are really sent (see doughtracker_webhook_sink)\n",
+          argv0);
+}
+
+int main(int argc, char** argv) {
+  int port = 8080;
+  const char* statePath = "doughtracker-nvs.txt";
+  float distance = 150.0f;
+  float noise = 1.0f;
+  bool apMode = false;
+  bool quiet = false;
+  double timeScale = 1.0;
+  bool ferment = false;
+  FermentProfile profile;
+  double runHours = 0;
+  const char* webhookURL = nullptr;
+  unsigned long wifiDelayMs = 2000;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--port" && hasValue) {
+      port = atoi(argv[++i]);
+    } else if (arg == "--state" && hasValue) {
+      statePath = argv[++i];
+    } else if (arg == "--distance" && hasValue) {
+      distance = atof(argv[++i]);
+    } else if (arg == "--noise" && hasValue) {
+      noise = atof(argv[++i]);
+    } else if (arg == "--ap") {
+      apMode = true;
+    } else if (arg == "--trace") {
+      traceRequests = true;
+    } else if (arg == "--quiet") {
+      quiet = true;
+    } else if (arg == "--time-scale" && hasValue) {
+      timeScale = atof(argv[++i]);
+    } else if (arg == "--ferment") {
+      ferment = true;
+    } else if (arg == "--peak-rise" && hasValue) {
+      profile.peakRise = atof(argv[++i]);
+    } else if (arg == "--midpoint" && hasValue) {
+      profile.midpointHours = atof(argv[++i]);
+    } else if (arg == "--collapse" && hasValue) {
+      profile.collapseRate = atof(argv[++i]);
+    } else if (arg == "--hours" && hasValue) {
+      runHours = atof(argv[++i]);
+    } else if (arg == "--webhook" && hasValue) {
+      webhookURL = argv[++i];
+    } else if (arg == "--wifi-delay" && hasValue) {
+      wifiDelayMs = strtoul(argv[++i], nullptr, 10);
+    } else {
+      usage(argv[0]);
+      return arg == "--help" || arg == "-h" ? 0 : 1;
+    }
+  }
+
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+
+  if (timeScale <= 0) {
+    fprintf(stderr, "--time-scale must be positive\n");
+    return 1;
+  }
+  hostClockSetScale(timeScale);
+
+  Preferences::hostSetStorageFile(statePath);
+
+  static SimulatedSensor sensor;
+  sensor.setDistance(distance);
+  sensor.setNoise(noise);
+  sensor.install();
+
+  // A small radio environment for /api/scan-networks and auto-connect
+  WiFi.hostAddNetwork("EmulatorNet", -52);
+  WiFi.hostAddNetwork("Neighbour", -81, "neighbour-secret");
+  if (!apMode) {
+    WiFi.begin("EmulatorNet");
+  }
+  // Later connection attempts take time, as association does on the device
+  WiFi.hostSetConnectDelay(wifiDelayMs);
+
+  WebServer::hostListen(port);
+  WebServer::hostSetObserver(onRequest, nullptr);
+  Serial.setInput(STDIN_FILENO);
+  if (quiet) Serial.setOutput(nullptr);
+
+  static time_t bootTime = hostClockNow();
+  HTTPClient::hostSetTransport(logWebhook, &bootTime);
+
+  setup();
+
+  if (webhookURL) {
+    String body = String("{\"url\":\"") + webhookURL + "\",\"enabled\":true}";
+    request(HTTP_POST, "/api/webhook", body.c_str());
+  }
+  if (ferment) {
+    // Start from a clean bake so thresholds and history match the curve
+    request(HTTP_POST, "/api/reset-data");
+    if (!startFerment(sensor, profile)) {
+      fprintf(stderr, "[Emulator] Calibration failed, not starting ferment\n");
+      return 1;
+    }
+  }
+
+  time_t endTime = hostClockNow() + (time_t)(runHours * 3600);
+  while (!stopRequested) {
+    loop();
+    if (Serial.available()) serialEvent();
+    if (runHours > 0 && hostClockNow() >= endTime) break;
+  }
+
+  if (ferment) request(HTTP_GET, "/status");
+
+  printSummary();
+  return 0;
+}
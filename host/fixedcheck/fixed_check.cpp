@@ -0,0 +1,122 @@
+/*
+ * Equivalence check for the fixed-point rise pipeline.
+ *
+ * Runs every input the device can produce through the former float code and
+ * through FixedPoint.h, and compares the results exactly:
+ *
+ *   - outlier filter: every sample against every median in sensor range
+ *   - rise: every thickness against every initial thickness, as the JSON
+ *     text /data serves, and against the exact rational result
+ *   - webhook thresholds: whether each rise counts as crossing 50/100/200%
+ *
+ * The fixed-point rise must equal the correctly rounded value everywhere.
+ * The float version may differ from it only by one unit in the last digit,
+ * and only where float's own error is at least the distance from the exact
+ * value to the rounding boundary: half-way ties, and large rises where a
+ * float has too few digits left for the hundredths. Anything else is a
+ * failure. Exit status 0 means equivalent.
+ *
+ *   doughtracker_fixed_check [maxMillimetres]
+ */
+#include "FixedPoint.h"
+#include "JsonWriter.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The float implementations the fixed-point code replaced
+static bool floatWithinDeviation(uint16_t value, uint16_t median) {
+  const float deviationThreshold = 0.12;
+  float deviation = abs((float)value - (float)median) / (float)median;
+  return deviation <= deviationThreshold;
+}
+
+static float floatRise(uint16_t current, uint16_t initial) {
+  if (initial == 0) return 0.0;
+  return ((float)(current - initial) / initial) * 100.0;
+}
+
+static void formatFloat(float rise, char* out, size_t size) {
+  JsonWriter json(out, size);
+  json.value(rise);
+  strcpy(out, json.c_str());
+}
+
+static void formatFixed(RiseFixed rise, char* out, size_t size) {
+  JsonWriter json(out, size);
+  json.valueFixed(rise, RISE_DECIMALS);
+  strcpy(out, json.c_str());
+}
+
+int main(int argc, char** argv) {
+  const long maxMm = argc > 1 ? atol(argv[1]) : 1000;
+  bool ok = true;
+
+  // Outlier filter
+  uint64_t outlierCases = 0, outlierMismatches = 0;
+  for (long median = 1; median <= maxMm; median++) {
+    for (long value = 0; value <= 2 * maxMm; value++) {
+      outlierCases++;
+      if (floatWithinDeviation(value, median) != withinDeviation(value, median, 120)) {
+        if (outlierMismatches++ < 5) {
+          printf("outlier mismatch: value %ld median %ld\n", value, median);
+        }
+      }
+    }
+  }
+  printf("outlier filter: %llu cases, %llu mismatches\n",
+         (unsigned long long)outlierCases, (unsigned long long)outlierMismatches);
+  if (outlierMismatches > 0) ok = false;
+
+  // Rise calculation and its JSON text
+  uint64_t riseCases = 0, exactErrors = 0, floatDifferences = 0, otherDifferences = 0;
+  uint64_t thresholdDifferences = 0;
+  static const long THRESHOLDS[] = {50, 100, 200};
+  for (long initial = 1; initial <= maxMm; initial++) {
+    for (long current = 0; current <= maxMm; current++) {
+      riseCases++;
+      RiseFixed fixed = riseFromThickness(current, initial);
+
+      // Correctly rounded reference: (current - initial) * 10000 / initial
+      int64_t numerator = (int64_t)(current - initial) * 100 * RISE_SCALE;
+      if (fixed != roundedDivide(numerator, (int64_t)initial)) {
+        if (exactErrors++ < 5) printf("fixed rise wrong: %ld / %ld\n", current, initial);
+      }
+
+      char a[32], b[32];
+      float rise = floatRise(current, initial);
+      formatFloat(rise, a, sizeof(a));
+      formatFixed(fixed, b, sizeof(b));
+      if (strcmp(a, b) != 0) {
+        // Distance of the exact value from the nearest rounding boundary,
+        // against the error float made computing it
+        double exact = (double)numerator / initial / RISE_SCALE;
+        double units = fabs(exact) * RISE_SCALE;
+        double boundary = fabs(units - floor(units) - 0.5) / RISE_SCALE;
+        double floatError = fabs((double)rise - exact);
+        long floatUnits = lround(atof(a) * RISE_SCALE);
+        if (labs(floatUnits - fixed) == 1 && floatError >= boundary) {
+          floatDifferences++;
+        } else if (otherDifferences++ < 5) {
+          printf("rise text differs: %ld / %ld float %s fixed %s\n", current, initial, a, b);
+        }
+      }
+
+      // A rise rounding up onto a threshold now counts as reaching it
+      for (long threshold : THRESHOLDS) {
+        if ((rise >= threshold) != (fixed >= threshold * RISE_SCALE)) thresholdDifferences++;
+      }
+    }
+  }
+  printf("rise: %llu cases, %llu differences from float rounding error, "
+         "%llu other differences, %llu fixed-point errors\n",
+         (unsigned long long)riseCases, (unsigned long long)floatDifferences,
+         (unsigned long long)otherDifferences, (unsigned long long)exactErrors);
+  printf("thresholds: %llu cases within 0.005%% below a threshold now count as reached\n",
+         (unsigned long long)thresholdDifferences);
+  if (exactErrors > 0 || otherDifferences > 0) ok = false;
+
+  printf(ok ? "EQUIVALENT\n" : "NOT EQUIVALENT\n");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+/*
+ * Fuzz harness for JsonParser.
+ *
+ * Built with libFuzzer (clang -fsanitize=fuzzer -DDOUGHTRACKER_LIBFUZZER)
+ * only LLVMFuzzerTestOneInput is used. Otherwise main() runs a built-in
+ * mutation loop over the request bodies the web UI sends, which is enough
+ * to shake out memory errors under the address/undefined sanitizers:
+ *
+ *   doughtracker_fuzz_json [iterations] [seed]
+ */
+#include "JsonParser.h"
+#include <assert.h>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+static void checkString(const JsonField& field) {
+  if (!field.present) return;
+  const char* text = (const char*)field.target;
+  size_t length = strnlen(text, field.size);
+  // Always terminated inside the buffer and within the schema bounds
+  assert(length < field.size);
+  assert((long)length >= field.min);
+}
+
+struct ElementTargets {
+  long rise;
+  char message[16];
+  JsonField* fields;
+  uint16_t count;
+};
+
+static bool checkElement(uint16_t index, void* context) {
+  ElementTargets* element = static_cast<ElementTargets*>(context);
+  // Elements arrive in order, within the item limit and the element schema
+  assert(index == element->count && index < 4);
+  assert(element->rise >= -100 && element->rise <= 10000);
+  checkString(element->fields[1]);
+  element->count++;
+  return element->rise != 13;  // Exercise callback rejection
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  char ssid[33];
+  char password[65];
+  char url[256];
+  char action[2];
+  long offset = 0;
+  long index = 0;
+  bool enabled = false;
+  bool falling = false;
+  ElementTargets element = {};
+  JsonField elementFields[] = {
+    JsonParser::intField("rise", &element.rise, -100, 10000),
+    JsonParser::stringField("message", element.message, sizeof(element.message), 1),
+    JsonParser::boolField("falling", &falling, false),
+  };
+  element.fields = elementFields;
+
+  // Union of every request schema, so all field types are exercised
+  JsonField fields[] = {
+    JsonParser::stringField("ssid", ssid, sizeof(ssid), 1, false),
+    JsonParser::stringField("password", password, sizeof(password), 0, false),
+    JsonParser::stringField("url", url, sizeof(url), 0, false),
+    JsonParser::stringField("a", action, sizeof(action), 1, false),
+    JsonParser::intField("offset", &offset, -1000, 1000, false),
+    JsonParser::intField("i", &index, 0, 4, false),
+    JsonParser::boolField("enabled", &enabled, false),
+    JsonParser::arrayField("thresholds", elementFields, 3, 4, checkElement, &element, false),
+  };
+  const uint8_t fieldCount = sizeof(fields) / sizeof(fields[0]);
+
+  JsonParser parser;
+  bool ok = parser.parse((const char*)data, size, fields, fieldCount);
+  if (ok) {
+    for (uint8_t i = 0; i < fieldCount; i++) {
+      if (fields[i].type == JSON_FIELD_STRING) checkString(fields[i]);
+    }
+    if (fields[4].present) assert(offset >= -1000 && offset <= 1000);
+    if (fields[5].present) assert(index >= 0 && index <= 4);
+  } else {
+    assert(parser.error()[0] != '\0');
+  }
+  return 0;
+}
+
+#ifndef DOUGHTRACKER_LIBFUZZER
+
+static const char* SEEDS[] = {
+  "{\"offset\":-3}",
+  "{\"ssid\":\"Home \\\"5G\\\"\",\"password\":\"hunter22\"}",
+  "{\"url\":\"https://discord.com/api/webhooks/1/abc\",\"enabled\":true}",
+  "{\"n\":\"Jar\"}",
+  "{\"i\":2,\"a\":\"d\"}",
+  "{ \"enabled\" : false , \"extra\" : [1, {\"x\": null}, \"\\u00e9\\ud83c\\udf5e\"] }",
+  "{\"offset\":12345678901234567890}",
+  "{\"offset\":1.5e3}",
+  "{\"thresholds\":[{\"rise\":50,\"message\":\"Half\"},{\"rise\":140,\"falling\":true,\"message\":\"x\"}]}",
+  "{\"thresholds\":[]}",
+};
+
+// Fragments that tend to reach error paths
+static const char* TOKENS[] = {
+  "\"", "\\", "\\u", "\\ud800", "{", "}", "[", "]", ":", ",", "-", "0", "1e", "true", "null", "\x01",
+};
+
+int main(int argc, char** argv) {
+  unsigned long iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+  unsigned long seed = argc > 2 ? strtoul(argv[2], nullptr, 10) : 1;
+  std::mt19937 rng(seed);
+
+  std::vector<std::string> corpus(SEEDS, SEEDS + sizeof(SEEDS) / sizeof(SEEDS[0]));
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  for (unsigned long n = 0; n < iterations; n++) {
+    std::string input = corpus[rng() % corpus.size()];
+    unsigned mutations = 1 + rng() % 4;
+    for (unsigned m = 0; m < mutations; m++) {
+      size_t at = input.empty() ? 0 : rng() % (input.size() + 1);
+      switch (rng() % 5) {
+        case 0:  // Flip a bit
+          if (!input.empty()) input[at % input.size()] ^= 1 << (rng() % 8);
+          break;
+        case 1:  // Insert a random byte
+          input.insert(at, 1, (char)(rng() % 256));
+          break;
+        case 2:  // Delete a span
+          if (!input.empty()) input.erase(at % input.size(), 1 + rng() % 4);
+          break;
+        case 3:  // Insert a token
+          input.insert(at, TOKENS[rng() % (sizeof(TOKENS) / sizeof(TOKENS[0]))]);
+          break;
+        default: {  // Splice with the tail of another input
+          const std::string& other = corpus[rng() % corpus.size()];
+          input = input.substr(0, at) + other.substr(rng() % (other.size() + 1));
+          break;
+        }
+      }
+    }
+    LLVMFuzzerTestOneInput((const uint8_t*)input.data(), input.size());
+
+    // Grow the corpus with some mutated inputs as future bases
+    if (corpus.size() < 256 && n % 64 == 0) corpus.push_back(input);
+  }
+
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf("%lu inputs in %.2f s (%.0f/s), corpus %zu\n", iterations, seconds,
+         iterations / seconds, corpus.size());
+  return 0;
+}
+
+#endif
@@ -0,0 +1,415 @@
+/*
+ * Dough Tracker HTTP load generator
+ *
+ * Replays a weighted mix of API requests against the device (or the
+ * emulator) at a target concurrency and rate, then prints latency
+ * percentiles, a latency histogram, errors and throughput as JSON.
+ *
+ *   doughtracker_loadgen [--host dough.local] [--port 80] [--concurrency 4]
+ *                        [--rate 0] [--duration 10] [--requests 0] [--timeout 5000]
+ *                        [--mix "/=1,/data=4,/status=4,/api/webhook=1,/api/presets=1"]
+ *   doughtracker_loadgen --first-paint [--rtt 0] [--requests 20] [--host ...] [--port ...]
+ *
+ * With --rate the schedule is open-loop: latency is measured from each
+ * request's intended start time, so a stalled device shows up as queueing
+ * delay instead of silently lowering the offered load.
+ *
+ * --first-paint replays what the browser does to show the page: GET /, then
+ * either the four separate API requests (issued in parallel, as the old page
+ * did) or the single /api/bootstrap. Both are timed alternately and the time
+ * until the last response is reported. --rtt adds a simulated network round
+ * trip for the TCP handshake and another for the request itself, to
+ * approximate a phone on weak WiFi. Run the emulator without --time-scale so
+ * the firmware loop paces requests as it does on the device.
+ */
+
+#include <errno.h>
+#include <netdb.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+struct MixEntry {
+  std::string method;
+  std::string path;
+  std::string body;
+  unsigned weight;
+};
+
+struct Sample {
+  uint16_t route;
+  bool ok;
+  double latencyMs;
+};
+
+struct Options {
+  std::string host = "dough.local";
+  std::string port = "80";
+  unsigned concurrency = 4;
+  double rate = 0;          // Requests per second across all workers, 0 = closed loop
+  double duration = 10;     // Seconds
+  unsigned long requests = 0;
+  int timeoutMs = 5000;
+  std::string mix = "/=1,/data=4,/status=4,/api/webhook=1,/api/presets=1";
+  bool firstPaint = false;
+  int rttMs = 0;            // Simulated round trip per handshake/exchange
+};
+
+static const unsigned MAX_CONCURRENCY = 256;
+
+// Parse "[METHOD:]path=weight,..."; POST/DELETE entries send an empty JSON body
+static bool parseMix(const std::string& spec, std::vector<MixEntry>& mix) {
+  size_t start = 0;
+  while (start < spec.size()) {
+    size_t end = spec.find(',', start);
+    if (end == std::string::npos) end = spec.size();
+    std::string item = spec.substr(start, end - start);
+    start = end + 1;
+    if (item.empty()) continue;
+
+    MixEntry entry;
+    entry.method = "GET";
+    entry.weight = 1;
+    size_t eq = item.rfind('=');
+    if (eq != std::string::npos) {
+      entry.weight = (unsigned)atoi(item.c_str() + eq + 1);
+      item = item.substr(0, eq);
+    }
+    size_t colon = item.find(':');
+    if (colon != std::string::npos && item[0] != '/') {
+      entry.method = item.substr(0, colon);
+      item = item.substr(colon + 1);
+    }
+    if (item.empty() || item[0] != '/' || entry.weight == 0) return false;
+    entry.path = item;
+    if (entry.method != "GET") entry.body = "{}";
+    mix.push_back(entry);
+  }
+  return !mix.empty();
+}
+
+static int connectTo(const Options& options, int timeoutMs) {
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo* result = nullptr;
+  if (getaddrinfo(options.host.c_str(), options.port.c_str(), &hints, &result) != 0) return -1;
+
+  int fd = -1;
+  for (struct addrinfo* ai = result; ai; ai = ai->ai_next) {
+    fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (fd < 0) continue;
+    struct timeval tv = {timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) break;
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(result);
+  return fd;
+}
+
+// One request on a fresh connection (the device closes after every response).
+// Returns the HTTP status code, or -1 on connection/timeout errors.
+static int runRequest(const Options& options, const MixEntry& entry) {
+  if (options.rttMs > 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(options.rttMs));
+  }
+  int fd = connectTo(options, options.timeoutMs);
+  if (fd < 0) return -1;
+  if (options.rttMs > 0) {
+    std::this_thread::sleep_for(std::chrono::microseconds(options.rttMs * 500));
+  }
+
+  std::string request = entry.method + " " + entry.path + " HTTP/1.1\r\nHost: " + options.host +
+                        "\r\nConnection: close\r\n";
+  if (!entry.body.empty()) {
+    request += "Content-Type: application/json\r\nContent-Length: " +
+               std::to_string(entry.body.size()) + "\r\n";
+  }
+  request += "\r\n" + entry.body;
+
+  const char* data = request.data();
+  size_t remaining = request.size();
+  while (remaining > 0) {
+    ssize_t sent = send(fd, data, remaining, MSG_NOSIGNAL);
+    if (sent <= 0) {
+      close(fd);
+      return -1;
+    }
+    data += sent;
+    remaining -= sent;
+  }
+
+  // Read the whole response so the measured latency includes the body
+  char buffer[4096];
+  std::string head;
+  int status = -1;
+  while (true) {
+    ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+    if (n < 0) {
+      status = -1;
+      break;
+    }
+    if (n == 0) break;
+    if (status == -1 && head.size() < 64) {
+      head.append(buffer, std::min<size_t>(n, 64));
+      if (head.compare(0, 5, "HTTP/") == 0 && head.size() >= 12) {
+        status = atoi(head.c_str() + 9);
+      }
+    }
+  }
+  close(fd);
+  if (options.rttMs > 0) {
+    std::this_thread::sleep_for(std::chrono::microseconds(options.rttMs * 500));
+  }
+  return status;
+}
+
+static double percentile(const std::vector<double>& sorted, double p) {
+  if (sorted.empty()) return 0;
+  size_t index = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+static void printLatency(const std::vector<double>& sorted) {
+  double sum = 0;
+  for (double v : sorted) sum += v;
+  printf("{\"p50\":%.3f,\"p95\":%.3f,\"p99\":%.3f,\"max\":%.3f,\"mean\":%.3f}",
+         percentile(sorted, 50), percentile(sorted, 95), percentile(sorted, 99),
+         sorted.empty() ? 0.0 : sorted.back(), sorted.empty() ? 0.0 : sum / sorted.size());
+}
+
+// Time GET / plus the page's data requests, old layout against /api/bootstrap
+static int runFirstPaint(const Options& options) {
+  const MixEntry page = {"GET", "/", "", 1};
+  const MixEntry separate[] = {
+    {"GET", "/data", "", 1},
+    {"GET", "/status", "", 1},
+    {"GET", "/api/webhook", "", 1},
+    {"GET", "/api/presets", "", 1},
+  };
+  const MixEntry bootstrap = {"GET", "/api/bootstrap", "", 1};
+  const size_t separateCount = sizeof(separate) / sizeof(separate[0]);
+
+  unsigned long iterations = options.requests ? options.requests : 20;
+  std::vector<double> separateMs;
+  std::vector<double> bootstrapMs;
+  unsigned long errors = 0;
+
+  for (unsigned long i = 0; i < iterations; i++) {
+    for (int useBootstrap = 0; useBootstrap < 2; useBootstrap++) {
+      Clock::time_point start = Clock::now();
+      bool ok = runRequest(options, page) == 200;
+      if (useBootstrap) {
+        ok = runRequest(options, bootstrap) == 200 && ok;
+      } else {
+        std::atomic<bool> allOk(true);
+        std::vector<std::thread> threads;
+        for (size_t r = 0; r < separateCount; r++) {
+          threads.emplace_back([&, r]() {
+            if (runRequest(options, separate[r]) != 200) allOk = false;
+          });
+        }
+        for (std::thread& t : threads) t.join();
+        ok = allOk && ok;
+      }
+      double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+      if (!ok) {
+        errors++;
+        continue;
+      }
+      (useBootstrap ? bootstrapMs : separateMs).push_back(elapsed);
+    }
+  }
+
+  std::sort(separateMs.begin(), separateMs.end());
+  std::sort(bootstrapMs.begin(), bootstrapMs.end());
+  printf("{\"target\":\"%s:%s\",\"rtt_ms\":%d,\"iterations\":%lu,\"errors\":%lu,",
+         options.host.c_str(), options.port.c_str(), options.rttMs, iterations, errors);
+  printf("\"first_paint_ms\":{\"separate\":");
+  printLatency(separateMs);
+  printf(",\"bootstrap\":");
+  printLatency(bootstrapMs);
+  printf("}}\n");
+  return errors > 0 ? 2 : 0;
+}
+
+static void usage(const char* argv0) {
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  --host H          device host name or address (default dough.local)\n"
+          "  --port P          port (default 80)\n"
+          "  --concurrency N   parallel connections (default 4)\n"
+          "  --rate R          target requests/s over all connections, 0 = as fast as possible\n"
+          "  --duration S      run time in seconds (default 10)\n"
+          "  --requests N      stop after N requests instead\n"
+          "  --timeout MS      per-request timeout (default 5000)\n"
+          "  --mix SPEC        weighted [METHOD:]path=weight list\n"
+          "                    (default \"/=1,/data=4,/status=4,/api/webhook=1,/api/presets=1\")\n"
+          "  --first-paint     time a page load: separate API requests vs /api/bootstrap\n"
+          "                    (--requests sets the number of page loads, default 20)\n"
+          "  --rtt MS          simulated network round trip per connection and per request\n",
+          argv0);
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--host" && hasValue) {
+      options.host = argv[++i];
+    } else if (arg == "--port" && hasValue) {
+      options.port = argv[++i];
+    } else if (arg == "--concurrency" && hasValue) {
+      options.concurrency = (unsigned)atoi(argv[++i]);
+    } else if (arg == "--rate" && hasValue) {
+      options.rate = atof(argv[++i]);
+    } else if (arg == "--duration" && hasValue) {
+      options.duration = atof(argv[++i]);
+    } else if (arg == "--requests" && hasValue) {
+      options.requests = strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--timeout" && hasValue) {
+      options.timeoutMs = atoi(argv[++i]);
+    } else if (arg == "--mix" && hasValue) {
+      options.mix = argv[++i];
+    } else if (arg == "--first-paint") {
+      options.firstPaint = true;
+    } else if (arg == "--rtt" && hasValue) {
+      options.rttMs = atoi(argv[++i]);
+    } else {
+      usage(argv[0]);
+      return arg == "--help" || arg == "-h" ? 0 : 1;
+    }
+  }
+
+  if (options.firstPaint) return runFirstPaint(options);
+
+  std::vector<MixEntry> mix;
+  if (!parseMix(options.mix, mix)) {
+    fprintf(stderr, "Invalid --mix specification\n");
+    return 1;
+  }
+  if (options.concurrency == 0 || options.concurrency > MAX_CONCURRENCY) {
+    fprintf(stderr, "--concurrency must be between 1 and %u\n", MAX_CONCURRENCY);
+    return 1;
+  }
+
+  // Deterministic weighted round-robin keeps the mix exact for short runs
+  std::vector<uint16_t> schedule;
+  for (size_t i = 0; i < mix.size(); i++) {
+    for (unsigned w = 0; w < mix[i].weight; w++) schedule.push_back((uint16_t)i);
+  }
+
+  std::atomic<unsigned long> nextTicket(0);
+  std::mutex samplesMutex;
+  std::vector<Sample> samples;
+  samples.reserve(options.requests ? options.requests : 4096);
+
+  Clock::time_point start = Clock::now();
+  Clock::time_point deadline = start + std::chrono::duration_cast<Clock::duration>(
+                                           std::chrono::duration<double>(options.duration));
+
+  auto worker = [&]() {
+    std::vector<Sample> local;
+    while (true) {
+      unsigned long ticket = nextTicket++;
+      if (options.requests && ticket >= options.requests) break;
+
+      Clock::time_point intended = Clock::now();
+      if (options.rate > 0) {
+        intended = start + std::chrono::duration_cast<Clock::duration>(
+                               std::chrono::duration<double>(ticket / options.rate));
+        if (!options.requests && intended >= deadline) break;
+        std::this_thread::sleep_until(intended);
+      } else if (!options.requests && intended >= deadline) {
+        break;
+      }
+
+      uint16_t route = schedule[ticket % schedule.size()];
+      int status = runRequest(options, mix[route]);
+      double latency = std::chrono::duration<double, std::milli>(Clock::now() - intended).count();
+      local.push_back({route, status >= 200 && status < 300, latency});
+    }
+    std::lock_guard<std::mutex> lock(samplesMutex);
+    samples.insert(samples.end(), local.begin(), local.end());
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < options.concurrency; i++) threads.emplace_back(worker);
+  for (std::thread& t : threads) t.join();
+
+  double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+  // Aggregate: successful latencies overall and per route
+  std::vector<double> all;
+  std::vector<std::vector<double>> perRoute(mix.size());
+  std::vector<unsigned long> routeErrors(mix.size(), 0);
+  unsigned long errors = 0;
+  for (const Sample& s : samples) {
+    if (!s.ok) {
+      errors++;
+      routeErrors[s.route]++;
+      continue;
+    }
+    all.push_back(s.latencyMs);
+    perRoute[s.route].push_back(s.latencyMs);
+  }
+  std::sort(all.begin(), all.end());
+
+  printf("{\"target\":\"%s:%s\",\"concurrency\":%u,\"rate\":%.1f,\"elapsed_s\":%.3f,",
+         options.host.c_str(), options.port.c_str(), options.concurrency, options.rate, elapsed);
+  printf("\"requests\":%zu,\"errors\":%lu,\"throughput_rps\":%.2f,\"latency_ms\":",
+         samples.size(), errors, elapsed > 0 ? (samples.size() - errors) / elapsed : 0.0);
+  printLatency(all);
+
+  // Power-of-two millisecond buckets: count of requests with latency <= le_ms
+  printf(",\"histogram\":[");
+  double bound = 1;
+  size_t index = 0;
+  bool first = true;
+  while (index < all.size()) {
+    size_t count = 0;
+    while (index < all.size() && all[index] <= bound) {
+      count++;
+      index++;
+    }
+    if (count > 0) {
+      printf("%s{\"le_ms\":%.0f,\"count\":%zu}", first ? "" : ",", bound, count);
+      first = false;
+    }
+    bound *= 2;
+  }
+
+  printf("],\"routes\":{");
+  for (size_t i = 0; i < mix.size(); i++) {
+    std::sort(perRoute[i].begin(), perRoute[i].end());
+    printf("%s\"%s %s\":{\"requests\":%zu,\"errors\":%lu,\"latency_ms\":", i ? "," : "",
+           mix[i].method.c_str(), mix[i].path.c_str(), perRoute[i].size() + routeErrors[i],
+           routeErrors[i]);
+    printLatency(perRoute[i]);
+    printf("}");
+  }
+  printf("}}\n");
+
+  return errors > 0 ? 2 : 0;
+}
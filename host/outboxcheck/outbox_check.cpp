@@ -0,0 +1,59 @@
+/*
+ * Outbox check: notifications queued before NTP has set the clock.
+ *
+ * Boots with time() near the epoch and no WiFi, crosses a threshold so the
+ * notification is queued, then sets the clock to real time as SNTP would and
+ * brings WiFi up. The queued notification must still be delivered, not
+ * dropped as expired. Exit status 0 means it was.
+ *
+ *   doughtracker_outbox_check
+ */
+#include <Arduino.h>
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include "WebhookManager.h"
+#include <stdio.h>
+
+static int deliveries = 0;
+
+static int countDelivery(const HTTPClient::HostRequest& request, String& response, void* context) {
+  (void)request;
+  (void)context;
+  deliveries++;
+  response = "";
+  return 204;
+}
+
+int main() {
+  hostClockSetEpoch(1000);  // Clock not set yet
+  WiFi.hostSetStatus(WL_DISCONNECTED);
+  HTTPClient::hostSetTransport(countDelivery, nullptr);
+
+  WebhookManager webhook;
+  webhook.begin();
+  webhook.setWebhookURL("http://127.0.0.1/webhook");
+  webhook.setEnabled(true);
+  webhook.checkAndNotify(riseFromPercent(60));
+  webhook.handle();
+
+  if (webhook.getOutbox().getCount() != 1) {
+    fprintf(stderr, "FAIL: expected 1 queued notification, have %u\n", webhook.getOutbox().getCount());
+    return 1;
+  }
+
+  // SNTP sets the clock, then WiFi comes up
+  hostClockSetEpoch(1790000000);
+  webhook.handle();
+  WiFi.hostSetStatus(WL_CONNECTED);
+  for (int i = 0; i < 120 && webhook.getOutbox().getCount() > 0; i++) {
+    webhook.handle();
+    hostClockAdvance(1000);
+  }
+
+  if (deliveries != 1 || webhook.getOutbox().getCount() != 0) {
+    fprintf(stderr, "FAIL: %d deliveries, %u still queued\n", deliveries, webhook.getOutbox().getCount());
+    return 1;
+  }
+  printf("OK: notification queued before the clock was set was delivered\n");
+  return 0;
+}
@@ -0,0 +1,268 @@
+#include "Arduino.h"
+#include <chrono>
+#include <thread>
+#include <malloc.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// ---------------------------------------------------------------------------
+// Timing
+// ---------------------------------------------------------------------------
+
+// Virtual time = base + scale * real time elapsed since the last rebase.
+// Rebasing on every scale change keeps millis() monotonic.
+static std::chrono::steady_clock::time_point rebaseTime = std::chrono::steady_clock::now();
+static double virtualBaseUs = 0;
+static double clockScale = 1.0;
+
+// Not time(): under --wrap=time that would resolve to the wrapper below
+static time_t realEpoch() {
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return ts.tv_sec;
+}
+
+static const time_t bootEpoch = realEpoch();
+static time_t epochOffset = 0;  // hostClockSetEpoch()
+
+static double virtualMicros() {
+  double realUs = std::chrono::duration<double, std::micro>(
+      std::chrono::steady_clock::now() - rebaseTime).count();
+  return virtualBaseUs + realUs * clockScale;
+}
+
+void hostClockSetScale(double scale) {
+  if (scale <= 0) return;
+  virtualBaseUs = virtualMicros();
+  rebaseTime = std::chrono::steady_clock::now();
+  clockScale = scale;
+}
+
+double hostClockGetScale() {
+  return clockScale;
+}
+
+void hostClockAdvance(unsigned long ms) {
+  virtualBaseUs += ms * 1000.0;
+}
+
+time_t hostClockNow() {
+  return bootEpoch + epochOffset + (time_t)(virtualMicros() / 1000000.0);
+}
+
+void hostClockSetEpoch(time_t epoch) {
+  epochOffset += epoch - hostClockNow();
+}
+
+// Linked with -Wl,--wrap=time (emulator), firmware time(nullptr) follows the
+// virtual clock so timestamps stay consistent with millis()
+extern "C" time_t __wrap_time(time_t* out) {
+  time_t now = hostClockNow();
+  if (out) *out = now;
+  return now;
+}
+
+unsigned long millis() {
+  return (unsigned long)(virtualMicros() / 1000.0);
+}
+
+unsigned long micros() {
+  return (unsigned long)virtualMicros();
+}
+
+void delay(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(ms / clockScale));
+}
+
+void delayMicroseconds(unsigned int us) {
+  std::this_thread::sleep_for(std::chrono::duration<double, std::micro>(us / clockScale));
+}
+
+void yield() {
+  std::this_thread::yield();
+}
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1,
+                const char* server2, const char* server3) {
+  (void)gmtOffsetSec;
+  (void)daylightOffsetSec;
+  (void)server1;
+  (void)server2;
+  (void)server3;
+}
+
+// ---------------------------------------------------------------------------
+// String
+// ---------------------------------------------------------------------------
+
+static std::string formatInteger(unsigned long long value, bool negative, unsigned char base) {
+  if (base < 2 || base > 36) base = 10;
+  char buffer[72];
+  int pos = sizeof(buffer) - 1;
+  buffer[pos] = '\0';
+  do {
+    unsigned digit = value % base;
+    buffer[--pos] = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+    value /= base;
+  } while (value > 0);
+  if (negative) buffer[--pos] = '-';
+  return std::string(&buffer[pos]);
+}
+
+String::String(unsigned char value, unsigned char base) : str(formatInteger(value, false, base)) {}
+
+String::String(int value, unsigned char base)
+  : str(base == 10 && value < 0 ? formatInteger(-(long long)value, true, base)
+                                : formatInteger((unsigned int)value, false, base)) {}
+
+String::String(unsigned int value, unsigned char base) : str(formatInteger(value, false, base)) {}
+
+String::String(long value, unsigned char base)
+  : str(base == 10 && value < 0 ? formatInteger(-(long long)value, true, base)
+                                : formatInteger((unsigned long)value, false, base)) {}
+
+String::String(unsigned long value, unsigned char base) : str(formatInteger(value, false, base)) {}
+
+String::String(float value, unsigned char decimalPlaces) : String((double)value, decimalPlaces) {}
+
+String::String(double value, unsigned char decimalPlaces) {
+  if (std::isnan(value)) {
+    str = "nan";
+  } else if (std::isinf(value)) {
+    str = "inf";
+  } else {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", decimalPlaces, value);
+    str = buffer;
+  }
+}
+
+int String::indexOf(char c, unsigned int fromIndex) const {
+  size_t pos = str.find(c, fromIndex);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const char* s, unsigned int fromIndex) const {
+  size_t pos = str.find(s, fromIndex);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(char c) const {
+  size_t pos = str.rfind(c);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int beginIndex) const {
+  return substring(beginIndex, str.size());
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const {
+  // Arduino swaps reversed bounds and clamps to the string length
+  if (beginIndex > endIndex) std::swap(beginIndex, endIndex);
+  if (beginIndex >= str.size()) return String();
+  if (endIndex > str.size()) endIndex = str.size();
+  String out;
+  out.str = str.substr(beginIndex, endIndex - beginIndex);
+  return out;
+}
+
+void String::trim() {
+  size_t begin = str.find_first_not_of(" \t\r\n\f\v");
+  if (begin == std::string::npos) {
+    str.clear();
+    return;
+  }
+  size_t end = str.find_last_not_of(" \t\r\n\f\v");
+  str = str.substr(begin, end - begin + 1);
+}
+
+void String::toLowerCase() {
+  for (char& c : str) c = (char)tolower((unsigned char)c);
+}
+
+void String::toUpperCase() {
+  for (char& c : str) c = (char)toupper((unsigned char)c);
+}
+
+// ---------------------------------------------------------------------------
+// Serial
+// ---------------------------------------------------------------------------
+
+size_t HardwareSerial::write(uint8_t c) {
+  if (!output) return 1;
+  fputc(c, output);
+  return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  if (!output) return size;
+  return fwrite(buffer, 1, size, output);
+}
+
+void HardwareSerial::flush() {
+  if (output) fflush(output);
+}
+
+size_t HardwareSerial::printf(const char* format, ...) {
+  if (!output) return 0;
+  va_list args;
+  va_start(args, format);
+  int written = vfprintf(output, format, args);
+  va_end(args);
+  return written < 0 ? 0 : (size_t)written;
+}
+
+void HardwareSerial::setInput(int fd) {
+  inputFd = fd;
+  if (fd >= 0) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+int HardwareSerial::available() {
+  if (peeked >= 0) return 1;
+  if (inputFd < 0) return 0;
+  unsigned char c;
+  if (::read(inputFd, &c, 1) == 1) {
+    peeked = c;
+    return 1;
+  }
+  return 0;
+}
+
+int HardwareSerial::read() {
+  if (!available()) return -1;
+  int c = peeked;
+  peeked = -1;
+  return c;
+}
+
+// ---------------------------------------------------------------------------
+// ESP
+// ---------------------------------------------------------------------------
+
+void EspClass::restart() {
+  Serial.println("[Host] ESP.restart() requested - exiting");
+  Serial.flush();
+  exit(0);
+}
+
+uint32_t EspClass::getFreeHeap() {
+  // The C6 has ~320 KB of usable heap; report what the host allocator has
+  // handed out against that budget so trends are visible on the host too
+  const uint32_t budget = 320 * 1024;
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks >= budget ? 0 : budget - (uint32_t)info.uordblks;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  static uint32_t minimum = UINT32_MAX;
+  uint32_t current = getFreeHeap();
+  if (current < minimum) minimum = current;
+  return minimum;
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+  return getFreeHeap();
+}
@@ -0,0 +1,188 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+/*
+ * Minimal Arduino core stand-in for building the firmware on Linux.
+ *
+ * Only the subset of the ESP32 Arduino API that the Dough Tracker sources
+ * actually use is provided. Behaviour follows the real core closely enough
+ * that handler output (JSON, number formatting) matches the device.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <cmath>
+#include <string>
+#include <algorithm>
+
+using std::abs;
+using std::min;
+using std::max;
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+// Timing
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+// Host only: virtual clock driving millis(), delay() and (in the emulator)
+// time(). The scale runs the firmware faster than real time; advance jumps.
+// Setting the epoch moves time() only, e.g. to a clock NTP has not set yet.
+void hostClockSetScale(double scale);
+double hostClockGetScale();
+void hostClockAdvance(unsigned long ms);
+time_t hostClockNow();
+void hostClockSetEpoch(time_t epoch);
+
+// NTP configuration (no-op on host, system clock is already valid)
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1,
+                const char* server2 = nullptr, const char* server3 = nullptr);
+
+class String {
+public:
+  String() {}
+  String(const char* cstr) : str(cstr ? cstr : "") {}
+  String(const String& other) = default;
+  String(String&& other) = default;
+  explicit String(char c) : str(1, c) {}
+  explicit String(unsigned char value, unsigned char base = 10);
+  explicit String(int value, unsigned char base = 10);
+  explicit String(unsigned int value, unsigned char base = 10);
+  explicit String(long value, unsigned char base = 10);
+  explicit String(unsigned long value, unsigned char base = 10);
+  explicit String(float value, unsigned char decimalPlaces = 2);
+  explicit String(double value, unsigned char decimalPlaces = 2);
+
+  String& operator=(const String& other) = default;
+  String& operator=(String&& other) = default;
+  String& operator=(const char* cstr) { str = cstr ? cstr : ""; return *this; }
+
+  // Memory management
+  bool reserve(unsigned int size) { str.reserve(size); return true; }
+  unsigned int length() const { return str.length(); }
+  bool isEmpty() const { return str.empty(); }
+  const char* c_str() const { return str.c_str(); }
+
+  // Concatenation
+  bool concat(const String& s) { str += s.str; return true; }
+  bool concat(const char* cstr) { if (cstr) str += cstr; return true; }
+  bool concat(const char* cstr, unsigned int length) { if (cstr) str.append(cstr, length); return true; }
+  bool concat(char c) { str += c; return true; }
+  bool concat(unsigned char value) { return concat(String(value)); }
+  bool concat(int value) { return concat(String(value)); }
+  bool concat(unsigned int value) { return concat(String(value)); }
+  bool concat(long value) { return concat(String(value)); }
+  bool concat(unsigned long value) { return concat(String(value)); }
+  bool concat(float value) { return concat(String(value)); }
+  bool concat(double value) { return concat(String(value)); }
+
+  template <typename T>
+  String& operator+=(const T& value) { concat(value); return *this; }
+
+  friend String operator+(const String& lhs, const String& rhs) { String s(lhs); s.concat(rhs); return s; }
+  friend String operator+(const String& lhs, const char* rhs) { String s(lhs); s.concat(rhs); return s; }
+  friend String operator+(const char* lhs, const String& rhs) { String s(lhs); s.concat(rhs); return s; }
+
+  // Comparison
+  bool equals(const String& s) const { return str == s.str; }
+  bool equals(const char* cstr) const { return str == (cstr ? cstr : ""); }
+  bool operator==(const String& s) const { return equals(s); }
+  bool operator==(const char* cstr) const { return equals(cstr); }
+  bool operator!=(const String& s) const { return !equals(s); }
+  bool operator!=(const char* cstr) const { return !equals(cstr); }
+  bool equalsIgnoreCase(const String& other) const { return strcasecmp(str.c_str(), other.str.c_str()) == 0; }
+  bool startsWith(const String& prefix) const { return str.compare(0, prefix.str.size(), prefix.str) == 0; }
+  bool endsWith(const String& suffix) const {
+    return str.size() >= suffix.str.size() &&
+           str.compare(str.size() - suffix.str.size(), suffix.str.size(), suffix.str) == 0;
+  }
+
+  // Character access
+  char charAt(unsigned int index) const { return index < str.size() ? str[index] : 0; }
+  char operator[](unsigned int index) const { return charAt(index); }
+
+  // Search
+  int indexOf(char c, unsigned int fromIndex = 0) const;
+  int indexOf(const char* s, unsigned int fromIndex = 0) const;
+  int indexOf(const String& s, unsigned int fromIndex = 0) const { return indexOf(s.c_str(), fromIndex); }
+  int lastIndexOf(char c) const;
+
+  String substring(unsigned int beginIndex) const;
+  String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+  // Modification
+  void trim();
+  void toLowerCase();
+  void toUpperCase();
+
+  // Parsing
+  long toInt() const { return atol(str.c_str()); }
+  float toFloat() const { return (float)atof(str.c_str()); }
+
+private:
+  std::string str;
+};
+
+class HardwareSerial {
+public:
+  void begin(unsigned long baud) { (void)baud; }
+  void end() {}
+
+  size_t write(uint8_t c);
+  size_t write(const uint8_t* buffer, size_t size);
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+  void flush();
+  // Host output never blocks; report a UART-sized TX buffer
+  int availableForWrite() { return 128; }
+
+  size_t print(const char* s) { return write(s); }
+  size_t print(const String& s) { return write(s.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int value) { return print(String(value)); }
+  size_t print(unsigned int value) { return print(String(value)); }
+  size_t print(long value) { return print(String(value)); }
+  size_t print(unsigned long value) { return print(String(value)); }
+  size_t print(double value, int digits = 2) { return print(String(value, digits)); }
+
+  template <typename T>
+  size_t println(const T& value) { size_t n = print(value); return n + println(); }
+  size_t println() { return write("\r\n"); }
+
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+  int available();
+  int read();
+
+  // Host only: silence output (benchmarks) or redirect it
+  void setOutput(FILE* out) { output = out; }
+
+  // Host only: read serial commands from a file descriptor (e.g. stdin)
+  void setInput(int fd);
+
+private:
+  FILE* output = stdout;
+  int inputFd = -1;
+  int peeked = -1;
+};
+
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+  void restart();
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getMaxAllocHeap();
+};
+
+extern EspClass ESP;
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef HOST_HTTPCLIENT_H
+#define HOST_HTTPCLIENT_H
+
+#include <Arduino.h>
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+/*
+ * Host stand-in for the ESP32 HTTPClient.
+ *
+ * Outgoing requests are handed to a host-installed transport. Without one,
+ * every request fails with HTTPC_ERROR_CONNECTION_REFUSED so nothing leaves
+ * the machine by accident.
+ */
+class HTTPClient {
+public:
+  // One request as the firmware built it
+  struct HostRequest {
+    String method;
+    String url;
+    String headers;       // "Name: value\r\n" per addHeader()
+    String payload;
+    uint16_t timeoutMs;
+  };
+
+  typedef int (*Transport)(const HostRequest& request, String& response, void* context);
+
+  bool begin(const String& url) { requestURL = url; requestHeaders = ""; return url.length() > 0; }
+  void end() { requestURL = ""; requestHeaders = ""; responseBody = ""; }
+  void addHeader(const String& name, const String& value) { requestHeaders += name + ": " + value + "\r\n"; }
+  void setTimeout(uint16_t timeoutMs) { timeout = timeoutMs; }
+
+  int GET() { return sendRequest("GET", String()); }
+  int POST(const String& payload) { return sendRequest("POST", payload); }
+  String getString() { return responseBody; }
+
+  // Host only: install the transport used by every client instance
+  static void hostSetTransport(Transport transport, void* context);
+
+private:
+  String requestURL;
+  String requestHeaders;
+  String responseBody;
+  uint16_t timeout = 5000;
+
+  int sendRequest(const char* method, const String& payload);
+};
+
+#endif
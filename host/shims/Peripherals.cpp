@@ -0,0 +1,53 @@
+#include <Arduino.h>
+#include <ESPmDNS.h>
+#include <Wire.h>
+#include <VL53L1X.h>
+#include <HTTPClient.h>
+
+MDNSResponder MDNS;
+TwoWire Wire;
+
+// ---------------------------------------------------------------------------
+// VL53L1X
+// ---------------------------------------------------------------------------
+
+static VL53L1X::SourceFunction sensorSource = nullptr;
+static void* sensorContext = nullptr;
+
+void VL53L1X::hostSetSource(SourceFunction source, void* context) {
+  sensorSource = source;
+  sensorContext = context;
+}
+
+uint16_t VL53L1X::readRangeSingleMillimeters(bool blocking) {
+  (void)blocking;
+  uint16_t distance = sensorSource ? sensorSource(sensorContext) : 0;
+  didTimeout = (distance == 0);
+  return distance;
+}
+
+bool VL53L1X::timeoutOccurred() {
+  bool result = didTimeout;
+  didTimeout = false;
+  return result;
+}
+
+// ---------------------------------------------------------------------------
+// HTTPClient
+// ---------------------------------------------------------------------------
+
+static HTTPClient::Transport httpTransport = nullptr;
+static void* httpContext = nullptr;
+
+void HTTPClient::hostSetTransport(Transport transport, void* context) {
+  httpTransport = transport;
+  httpContext = context;
+}
+
+int HTTPClient::sendRequest(const char* method, const String& payload) {
+  responseBody = "";
+  if (requestURL.length() == 0) return HTTPC_ERROR_NOT_CONNECTED;
+  if (!httpTransport) return HTTPC_ERROR_CONNECTION_REFUSED;
+  HostRequest request = {String(method), requestURL, requestHeaders, payload, timeout};
+  return httpTransport(request, responseBody, httpContext);
+}
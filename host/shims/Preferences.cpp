@@ -0,0 +1,126 @@
+#include "Preferences.h"
+#include <map>
+#include <string>
+#include <vector>
+
+typedef std::map<std::string, std::vector<uint8_t>> KeyStore;
+
+static std::map<std::string, KeyStore>& store() {
+  static std::map<std::string, KeyStore> namespaces;
+  return namespaces;
+}
+
+static std::string storagePath;
+
+// One "namespace key hexbytes" line per entry; NVS names contain no spaces
+static void persist() {
+  if (storagePath.empty()) return;
+  std::string tmpPath = storagePath + ".tmp";
+  FILE* f = fopen(tmpPath.c_str(), "w");
+  if (!f) return;
+  for (const auto& ns : store()) {
+    for (const auto& entry : ns.second) {
+      fprintf(f, "%s %s ", ns.first.c_str(), entry.first.c_str());
+      for (uint8_t b : entry.second) fprintf(f, "%02x", b);
+      if (entry.second.empty()) fputc('-', f);
+      fputc('\n', f);
+    }
+  }
+  fclose(f);
+  rename(tmpPath.c_str(), storagePath.c_str());
+}
+
+bool Preferences::hostSetStorageFile(const char* path) {
+  storagePath = path ? path : "";
+  store().clear();
+  if (storagePath.empty()) return true;
+
+  FILE* f = fopen(storagePath.c_str(), "r");
+  if (!f) return true;  // First run: start empty
+  char ns[32], key[32];
+  static char hex[8192];
+  while (fscanf(f, "%31s %31s %8191s", ns, key, hex) == 3) {
+    std::vector<uint8_t>& bytes = store()[ns][key];
+    bytes.clear();
+    for (size_t i = 0; hex[i] != '-' && hex[i] && hex[i + 1]; i += 2) {
+      unsigned value;
+      sscanf(&hex[i], "%2x", &value);
+      bytes.push_back((uint8_t)value);
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+bool Preferences::begin(const char* name, bool ro) {
+  // NVS namespace names are limited to 15 characters
+  if (!name || strlen(name) > 15) return false;
+  nameSpace = name;
+  readOnly = ro;
+  opened = true;
+  return true;
+}
+
+void Preferences::end() {
+  opened = false;
+}
+
+bool Preferences::clear() {
+  if (!opened || readOnly) return false;
+  store()[nameSpace.c_str()].clear();
+  persist();
+  return true;
+}
+
+bool Preferences::remove(const char* key) {
+  if (!opened || readOnly) return false;
+  bool removed = store()[nameSpace.c_str()].erase(key) > 0;
+  if (removed) persist();
+  return removed;
+}
+
+bool Preferences::isKey(const char* key) {
+  if (!opened) return false;
+  KeyStore& keys = store()[nameSpace.c_str()];
+  return keys.find(key) != keys.end();
+}
+
+String Preferences::getString(const char* key, const String& defaultValue) {
+  if (!opened) return defaultValue;
+  KeyStore& keys = store()[nameSpace.c_str()];
+  auto it = keys.find(key);
+  if (it == keys.end() || it->second.empty()) return defaultValue;
+  return String((const char*)it->second.data());
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+  if (!opened) return 0;
+  KeyStore& keys = store()[nameSpace.c_str()];
+  auto it = keys.find(key);
+  return it == keys.end() ? 0 : it->second.size();
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t maxLen) {
+  size_t len = getBytesLength(key);
+  if (len == 0 || len > maxLen) return 0;
+  memcpy(buffer, store()[nameSpace.c_str()][key].data(), len);
+  return len;
+}
+
+size_t Preferences::putValue(const char* key, const void* value, size_t len) {
+  // NVS keys are limited to 15 characters
+  if (!opened || readOnly || !key || strlen(key) > 15) return 0;
+  const uint8_t* bytes = (const uint8_t*)value;
+  store()[nameSpace.c_str()][key].assign(bytes, bytes + len);
+  persist();
+  return len;
+}
+
+bool Preferences::readValue(const char* key, void* out, size_t len) {
+  if (!opened) return false;
+  KeyStore& keys = store()[nameSpace.c_str()];
+  auto it = keys.find(key);
+  if (it == keys.end() || it->second.size() != len) return false;
+  memcpy(out, it->second.data(), len);
+  return true;
+}
@@ -0,0 +1,67 @@
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include <Arduino.h>
+
+/*
+ * Host stand-in for the ESP32 NVS Preferences library.
+ *
+ * All namespaces live in one process-wide in-memory store so that separate
+ * Preferences instances opening the same namespace see the same keys, just
+ * like NVS on the device. hostSetStorageFile() makes the store persistent
+ * across runs (the emulator), rewriting the file after every change.
+ */
+class Preferences {
+public:
+  bool begin(const char* name, bool readOnly = false);
+  void end();
+
+  bool clear();
+  bool remove(const char* key);
+  bool isKey(const char* key);
+
+  size_t putBool(const char* key, bool value) { return putValue(key, &value, sizeof(value)); }
+  size_t putUChar(const char* key, uint8_t value) { return putValue(key, &value, sizeof(value)); }
+  size_t putShort(const char* key, int16_t value) { return putValue(key, &value, sizeof(value)); }
+  size_t putUShort(const char* key, uint16_t value) { return putValue(key, &value, sizeof(value)); }
+  size_t putInt(const char* key, int32_t value) { return putValue(key, &value, sizeof(value)); }
+  size_t putUInt(const char* key, uint32_t value) { return putValue(key, &value, sizeof(value)); }
+  size_t putLong(const char* key, int32_t value) { return putValue(key, &value, sizeof(value)); }
+  size_t putULong(const char* key, uint32_t value) { return putValue(key, &value, sizeof(value)); }
+  size_t putFloat(const char* key, float value) { return putValue(key, &value, sizeof(value)); }
+  size_t putString(const char* key, const char* value) { return putValue(key, value, strlen(value) + 1); }
+  size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+  size_t putBytes(const char* key, const void* value, size_t len) { return putValue(key, value, len); }
+
+  bool getBool(const char* key, bool defaultValue = false) { return getValue(key, defaultValue); }
+  uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return getValue(key, defaultValue); }
+  int16_t getShort(const char* key, int16_t defaultValue = 0) { return getValue(key, defaultValue); }
+  uint16_t getUShort(const char* key, uint16_t defaultValue = 0) { return getValue(key, defaultValue); }
+  int32_t getInt(const char* key, int32_t defaultValue = 0) { return getValue(key, defaultValue); }
+  uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return getValue(key, defaultValue); }
+  int32_t getLong(const char* key, int32_t defaultValue = 0) { return getValue(key, defaultValue); }
+  uint32_t getULong(const char* key, uint32_t defaultValue = 0) { return getValue(key, defaultValue); }
+  float getFloat(const char* key, float defaultValue = NAN) { return getValue(key, defaultValue); }
+  String getString(const char* key, const String& defaultValue = String());
+  size_t getBytesLength(const char* key);
+  size_t getBytes(const char* key, void* buffer, size_t maxLen);
+
+  // Host only: back every namespace with a file, loading what it holds
+  static bool hostSetStorageFile(const char* path);
+
+private:
+  String nameSpace;
+  bool opened = false;
+  bool readOnly = false;
+
+  size_t putValue(const char* key, const void* value, size_t len);
+  bool readValue(const char* key, void* out, size_t len);
+
+  template <typename T>
+  T getValue(const char* key, T defaultValue) {
+    T value;
+    return readValue(key, &value, sizeof(value)) ? value : defaultValue;
+  }
+};
+
+#endif
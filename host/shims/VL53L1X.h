@@ -0,0 +1,35 @@
+#ifndef HOST_VL53L1X_H
+#define HOST_VL53L1X_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+/*
+ * Host stand-in for the Pololu VL53L1X driver.
+ *
+ * Readings come from a host-supplied source function so benchmarks and the
+ * emulator can feed deterministic or synthetic distances. A source returning
+ * 0 is reported as a sensor timeout, like a failed single-shot read.
+ */
+class VL53L1X {
+public:
+  enum DistanceMode { Short, Medium, Long, Unknown };
+
+  typedef uint16_t (*SourceFunction)(void* context);
+
+  bool init(bool io_2v8 = true) { (void)io_2v8; return true; }
+  void setTimeout(uint16_t timeout) { (void)timeout; }
+  bool setDistanceMode(DistanceMode mode) { (void)mode; return true; }
+  bool setMeasurementTimingBudget(uint32_t budgetUs) { (void)budgetUs; return true; }
+
+  uint16_t readRangeSingleMillimeters(bool blocking = true);
+  bool timeoutOccurred();
+
+  // Host only: install the distance source shared by every sensor instance
+  static void hostSetSource(SourceFunction source, void* context);
+
+private:
+  bool didTimeout = false;
+};
+
+#endif
@@ -0,0 +1,457 @@
+#include "WebServer.h"
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+static const uint8_t MAX_SERVERS = 4;
+static WebServer* servers[MAX_SERVERS] = {nullptr};
+static int serverPorts[MAX_SERVERS] = {0};
+
+static int listenPort = 0;
+static WebServer::RequestObserver requestObserver = nullptr;
+static void* observerContext = nullptr;
+
+// Requests larger than this are rejected, matching the device's small buffers
+static const size_t MAX_REQUEST_BYTES = 16 * 1024;
+static const int CLIENT_TIMEOUT_MS = 2000;
+
+WebServer::WebServer(int port) : serverPort(port) {
+  for (uint8_t i = 0; i < MAX_SERVERS; i++) {
+    if (!servers[i]) {
+      servers[i] = this;
+      serverPorts[i] = port;
+      break;
+    }
+  }
+}
+
+WebServer::~WebServer() {
+  stop();
+  for (uint8_t i = 0; i < MAX_SERVERS; i++) {
+    if (servers[i] == this) servers[i] = nullptr;
+  }
+}
+
+WebServer* WebServer::hostFind(int port) {
+  for (uint8_t i = 0; i < MAX_SERVERS; i++) {
+    if (servers[i] && serverPorts[i] == port) return servers[i];
+  }
+  return nullptr;
+}
+
+void WebServer::hostListen(int tcpPort) {
+  listenPort = tcpPort;
+}
+
+void WebServer::hostSetObserver(RequestObserver observer, void* context) {
+  requestObserver = observer;
+  observerContext = context;
+}
+
+void WebServer::begin() {
+  running = true;
+  if (listenPort <= 0 || listenFd >= 0) return;
+
+  listenFd = socket(AF_INET, SOCK_STREAM, 0);
+  if (listenFd < 0) {
+    Serial.printf("[Host] WebServer socket() failed: %s\n", strerror(errno));
+    return;
+  }
+
+  int reuse = 1;
+  setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(listenPort);
+
+  if (bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listenFd, 16) < 0) {
+    Serial.printf("[Host] WebServer cannot listen on port %d: %s\n", listenPort, strerror(errno));
+    close(listenFd);
+    listenFd = -1;
+    return;
+  }
+
+  fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL, 0) | O_NONBLOCK);
+  Serial.printf("[Host] WebServer (device port %d) listening on http://localhost:%d\n",
+                serverPort, listenPort);
+}
+
+void WebServer::stop() {
+  running = false;
+  if (listenFd >= 0) {
+    close(listenFd);
+    listenFd = -1;
+  }
+}
+
+void WebServer::handleClient() {
+  if (!running || listenFd < 0) return;
+
+  int fd = accept(listenFd, nullptr, nullptr);
+  if (fd < 0) return;
+
+  int noDelay = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+  // The socket is closed when the last WiFiClient copy is released
+  currentClient = WiFiClient(fd);
+  serveSocketClient(fd);
+  currentClient = WiFiClient();
+}
+
+void WebServer::on(const String& uri, HTTPMethod method, THandlerFunction handler) {
+  if (routeCount >= MAX_ROUTES) {
+    Serial.printf("[Host] WebServer route table full, dropping %s\n", uri.c_str());
+    return;
+  }
+  routes[routeCount].uri = uri;
+  routes[routeCount].method = method;
+  routes[routeCount].handler = handler;
+  routeCount++;
+}
+
+String WebServer::arg(const String& name) {
+  for (int i = 0; i < argCount; i++) {
+    if (argNames[i] == name) return argValues[i];
+  }
+  return String();
+}
+
+bool WebServer::hasArg(const String& name) {
+  for (int i = 0; i < argCount; i++) {
+    if (argNames[i] == name) return true;
+  }
+  return false;
+}
+
+void WebServer::collectHeaders(const char* headerKeys[], const size_t headerKeysCount) {
+  headerCount = 0;
+  for (size_t i = 0; i < headerKeysCount && headerCount < MAX_HEADERS; i++) {
+    headerNames[headerCount] = headerKeys[i];
+    headerValues[headerCount] = "";
+    headerCount++;
+  }
+}
+
+String WebServer::header(const String& name) {
+  for (uint8_t i = 0; i < headerCount; i++) {
+    if (strcasecmp(headerNames[i].c_str(), name.c_str()) == 0) return headerValues[i];
+  }
+  return String();
+}
+
+bool WebServer::hasHeader(const String& name) {
+  return header(name).length() > 0;
+}
+
+void WebServer::storeHeader(const std::string& line) {
+  size_t colon = line.find(':');
+  if (colon == std::string::npos) return;
+  std::string name = line.substr(0, colon);
+  size_t start = line.find_first_not_of(' ', colon + 1);
+  std::string value = start == std::string::npos ? "" : line.substr(start);
+  for (uint8_t i = 0; i < headerCount; i++) {
+    if (strcasecmp(headerNames[i].c_str(), name.c_str()) == 0) {
+      headerValues[i] = value.c_str();
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Response output
+// ---------------------------------------------------------------------------
+
+static const char* reasonPhrase(int code) {
+  switch (code) {
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 413: return "Payload Too Large";
+    case 429: return "Too Many Requests";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default: return "";
+  }
+}
+
+void WebServer::writeClient(const char* data, size_t size) {
+  bytesWritten += size;
+  if (clientFd < 0) {
+    if (currentResponse) currentResponse->body.concat(data, size);
+    return;
+  }
+  while (size > 0) {
+    ssize_t sent = ::send(clientFd, data, size, MSG_NOSIGNAL);
+    if (sent <= 0) {
+      if (sent < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+      clientFd = -1;  // Peer went away; drop the rest of the response
+      return;
+    }
+    data += sent;
+    size -= sent;
+  }
+}
+
+void WebServer::sendStatusAndHeaders(int code, const char* contentType, size_t contentLength) {
+  if (currentResponse) {
+    currentResponse->code = code;
+    currentResponse->contentType = contentType ? contentType : "";
+    currentResponse->headers = pendingHeaders;
+  }
+  headersSent = true;
+  chunked = (contentLength == CONTENT_LENGTH_UNKNOWN);
+  if (clientFd < 0) return;
+
+  String head = "HTTP/1.1 ";
+  head += code;
+  head += " ";
+  head += reasonPhrase(code);
+  head += "\r\n";
+  if (contentType && contentType[0]) {
+    head += "Content-Type: ";
+    head += contentType;
+    head += "\r\n";
+  }
+  head += pendingHeaders;
+  if (chunked) {
+    head += "Transfer-Encoding: chunked\r\n";
+  } else {
+    head += "Content-Length: ";
+    head += (unsigned long)contentLength;
+    head += "\r\n";
+  }
+  head += "Connection: close\r\n\r\n";
+  writeClient(head.c_str(), head.length());
+}
+
+void WebServer::send(int code, const char* contentType, const String& content) {
+  if (headersSent) return;
+  size_t length = pendingContentLength != 0 ? pendingContentLength : content.length();
+  sendStatusAndHeaders(code, contentType, length);
+  if (content.length() > 0) sendContent(content.c_str(), content.length());
+}
+
+void WebServer::send_P(int code, const char* contentType, const char* content, size_t contentLength) {
+  if (headersSent) return;
+  sendStatusAndHeaders(code, contentType, contentLength);
+  writeClient(content, contentLength);
+}
+
+void WebServer::sendHeader(const String& name, const String& value, bool first) {
+  String line = name + ": " + value + "\r\n";
+  pendingHeaders = first ? line + pendingHeaders : pendingHeaders + line;
+}
+
+void WebServer::sendContent(const char* content, size_t size) {
+  if (!chunked || clientFd < 0) {
+    writeClient(content, size);
+    return;
+  }
+  // An empty chunk terminates the chunked body
+  char sizeLine[16];
+  int n = snprintf(sizeLine, sizeof(sizeLine), "%zx\r\n", size);
+  writeClient(sizeLine, n);
+  if (size == 0) {
+    writeClient("\r\n", 2);
+    chunked = false;
+    return;
+  }
+  writeClient(content, size);
+  writeClient("\r\n", 2);
+}
+
+// ---------------------------------------------------------------------------
+// Request handling
+// ---------------------------------------------------------------------------
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+static String urlDecode(const String& text) {
+  String decoded;
+  decoded.reserve(text.length());
+  for (unsigned int i = 0; i < text.length(); i++) {
+    char c = text.charAt(i);
+    if (c == '+') {
+      decoded += ' ';
+    } else if (c == '%' && i + 2 < text.length() &&
+               hexValue(text.charAt(i + 1)) >= 0 && hexValue(text.charAt(i + 2)) >= 0) {
+      decoded += (char)(hexValue(text.charAt(i + 1)) * 16 + hexValue(text.charAt(i + 2)));
+      i += 2;
+    } else {
+      decoded += c;
+    }
+  }
+  return decoded;
+}
+
+void WebServer::parseArguments(const String& query) {
+  argCount = 0;
+  unsigned int start = 0;
+  while (start < query.length() && argCount < MAX_ARGS - 1) {
+    int end = query.indexOf('&', start);
+    if (end == -1) end = query.length();
+    String pair = query.substring(start, end);
+    if (pair.length() > 0) {
+      int eq = pair.indexOf('=');
+      argNames[argCount] = urlDecode(eq == -1 ? pair : pair.substring(0, eq));
+      argValues[argCount] = eq == -1 ? String() : urlDecode(pair.substring(eq + 1));
+      argCount++;
+    }
+    start = end + 1;
+  }
+}
+
+void WebServer::runHandler(HTTPMethod method, const String& uri, const String& body, Response& response) {
+  // Real (not virtual) time, so latency is comparable at any clock scale
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  int queryPos = uri.indexOf('?');
+  currentURI = queryPos == -1 ? uri : uri.substring(0, queryPos);
+  currentMethod = method;
+  parseArguments(queryPos == -1 ? String() : uri.substring(queryPos + 1));
+
+  // Like the ESP32 core, a request body is exposed as the "plain" argument
+  if (body.length() > 0 && argCount < MAX_ARGS) {
+    argNames[argCount] = "plain";
+    argValues[argCount] = body;
+    argCount++;
+  }
+
+  currentResponse = &response;
+  pendingContentLength = 0;
+  pendingHeaders = "";
+  headersSent = false;
+  chunked = false;
+  bytesWritten = 0;
+
+  THandlerFunction handler = notFoundHandler;
+  for (uint8_t i = 0; i < routeCount; i++) {
+    if (routes[i].uri == currentURI && (routes[i].method == HTTP_ANY || routes[i].method == method)) {
+      handler = routes[i].handler;
+      break;
+    }
+  }
+
+  if (handler) {
+    handler();
+  } else {
+    send(404, "text/plain", "Not Found");
+  }
+
+  // Close a chunked body the handler left open
+  if (chunked) sendContent("", 0);
+
+  currentResponse = nullptr;
+
+  if (requestObserver) {
+    requestObserver(method, currentURI, response.code, bytesWritten,
+                    (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start).count(),
+                    observerContext);
+  }
+}
+
+WebServer::Response WebServer::dispatch(HTTPMethod method, const String& uri, const String& body) {
+  Response response;
+  clientFd = -1;
+  for (uint8_t i = 0; i < headerCount; i++) headerValues[i] = "";
+  runHandler(method, uri, body, response);
+  return response;
+}
+
+static HTTPMethod parseMethod(const String& name) {
+  if (name == "GET") return HTTP_GET;
+  if (name == "HEAD") return HTTP_HEAD;
+  if (name == "POST") return HTTP_POST;
+  if (name == "PUT") return HTTP_PUT;
+  if (name == "PATCH") return HTTP_PATCH;
+  if (name == "DELETE") return HTTP_DELETE;
+  if (name == "OPTIONS") return HTTP_OPTIONS;
+  return HTTP_ANY;
+}
+
+// Read from the socket until the predicate on the accumulated data is met
+static bool readUntil(int fd, std::string& data, size_t wantBytes, bool wantHeaders) {
+  char buffer[2048];
+  while (true) {
+    if (wantHeaders && data.find("\r\n\r\n") != std::string::npos) return true;
+    if (!wantHeaders && data.size() >= wantBytes) return true;
+    if (data.size() > MAX_REQUEST_BYTES) return false;
+
+    struct pollfd pfd = {fd, POLLIN, 0};
+    if (poll(&pfd, 1, CLIENT_TIMEOUT_MS) <= 0) return false;
+    ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+    if (n <= 0) return false;
+    data.append(buffer, n);
+  }
+}
+
+void WebServer::serveSocketClient(int fd) {
+  std::string request;
+  if (!readUntil(fd, request, 0, true)) return;
+
+  size_t headerEnd = request.find("\r\n\r\n");
+  size_t lineEnd = request.find("\r\n");
+  std::string requestLine = request.substr(0, lineEnd);
+
+  size_t sp1 = requestLine.find(' ');
+  size_t sp2 = requestLine.find(' ', sp1 + 1);
+  if (sp1 == std::string::npos || sp2 == std::string::npos) return;
+  HTTPMethod method = parseMethod(String(requestLine.substr(0, sp1).c_str()));
+  String uri(requestLine.substr(sp1 + 1, sp2 - sp1 - 1).c_str());
+
+  // Only Content-Length bodies are supported, as on the device
+  size_t contentLength = 0;
+  std::string headers = request.substr(lineEnd + 2, headerEnd - lineEnd - 2);
+  for (uint8_t i = 0; i < headerCount; i++) headerValues[i] = "";
+  size_t pos = 0;
+  while (pos < headers.size()) {
+    size_t end = headers.find("\r\n", pos);
+    if (end == std::string::npos) end = headers.size();
+    std::string line = headers.substr(pos, end - pos);
+    if (strncasecmp(line.c_str(), "Content-Length:", 15) == 0) {
+      contentLength = strtoul(line.c_str() + 15, nullptr, 10);
+    }
+    storeHeader(line);
+    pos = end + 2;
+  }
+
+  clientFd = fd;
+  Response response;
+  if (contentLength > MAX_REQUEST_BYTES) {
+    currentResponse = &response;
+    headersSent = false;
+    pendingHeaders = "";
+    pendingContentLength = 0;
+    send(413, "text/plain", "Payload Too Large");
+    currentResponse = nullptr;
+    clientFd = -1;
+    return;
+  }
+
+  std::string body = request.substr(headerEnd + 4);
+  if (body.size() < contentLength && !readUntil(fd, body, contentLength, false)) {
+    clientFd = -1;
+    return;
+  }
+  body.resize(contentLength);
+
+  runHandler(method, uri, String(body.c_str()), response);
+  clientFd = -1;
+}
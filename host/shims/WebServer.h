@@ -0,0 +1,140 @@
+#ifndef HOST_WEBSERVER_H
+#define HOST_WEBSERVER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <functional>
+
+typedef enum {
+  HTTP_ANY,
+  HTTP_GET,
+  HTTP_HEAD,
+  HTTP_POST,
+  HTTP_PUT,
+  HTTP_PATCH,
+  HTTP_DELETE,
+  HTTP_OPTIONS
+} HTTPMethod;
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+
+/*
+ * Host stand-in for the ESP32 synchronous WebServer.
+ *
+ * Routes are registered exactly as on the device. Requests are either
+ * injected with dispatch(), which runs the matching handler and captures the
+ * response in-process, or served over a real POSIX socket once hostListen()
+ * has been called (the emulator). Like the device, one client is accepted per
+ * handleClient() call and the connection is closed after the response.
+ */
+class WebServer {
+public:
+  typedef std::function<void(void)> THandlerFunction;
+  typedef void (*RequestObserver)(HTTPMethod method, const String& uri, int code,
+                                  size_t bytes, unsigned long durationUs, void* context);
+
+  struct Response {
+    int code = 0;
+    String contentType;
+    String headers;
+    String body;
+  };
+
+  explicit WebServer(int port = 80);
+  ~WebServer();
+
+  void begin();
+  void stop();
+  void handleClient();
+
+  void on(const String& uri, HTTPMethod method, THandlerFunction handler);
+  void on(const String& uri, THandlerFunction handler) { on(uri, HTTP_ANY, handler); }
+  void onNotFound(THandlerFunction handler) { notFoundHandler = handler; }
+
+  // Request accessors (valid inside a handler)
+  String uri() { return currentURI; }
+  HTTPMethod method() { return currentMethod; }
+  int args() { return argCount; }
+  String arg(const String& name);
+  String arg(int index) { return index < argCount ? argValues[index] : String(); }
+  String argName(int index) { return index < argCount ? argNames[index] : String(); }
+  bool hasArg(const String& name);
+
+  // Request headers; only the names passed to collectHeaders() are kept
+  void collectHeaders(const char* headerKeys[], const size_t headerKeysCount);
+  String header(const String& name);
+  bool hasHeader(const String& name);
+
+  // The connection being served. A handler may keep a copy to take the
+  // socket over (e.g. a WebSocket upgrade); it then outlives the request.
+  WiFiClient& client() { return currentClient; }
+
+  // Responses
+  void send(int code, const char* contentType = nullptr, const String& content = String());
+  void send(int code, const String& contentType, const String& content) { send(code, contentType.c_str(), content); }
+  void send_P(int code, const char* contentType, const char* content) { send_P(code, contentType, content, strlen(content)); }
+  void send_P(int code, const char* contentType, const char* content, size_t contentLength);
+  void sendHeader(const String& name, const String& value, bool first = false);
+  void setContentLength(size_t contentLength) { pendingContentLength = contentLength; }
+  void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+  void sendContent(const char* content, size_t size);
+
+  // Host only: run one request through the routing table
+  Response dispatch(HTTPMethod method, const String& uri, const String& body = String());
+
+  // Host only: look up the server created for a device port
+  static WebServer* hostFind(int port);
+
+  // Host only: serve the device port on a real TCP port from begin() onwards
+  static void hostListen(int tcpPort);
+
+  // Host only: called after every request (emulator latency tracing)
+  static void hostSetObserver(RequestObserver observer, void* context);
+
+private:
+  struct Route {
+    String uri;
+    HTTPMethod method;
+    THandlerFunction handler;
+  };
+
+  static const uint8_t MAX_ROUTES = 48;
+  static const uint8_t MAX_ARGS = 16;
+  static const uint8_t MAX_HEADERS = 8;
+
+  int serverPort;
+  bool running = false;
+  Route routes[MAX_ROUTES];
+  uint8_t routeCount = 0;
+  THandlerFunction notFoundHandler;
+
+  String currentURI;
+  HTTPMethod currentMethod = HTTP_GET;
+  String argNames[MAX_ARGS];
+  String argValues[MAX_ARGS];
+  int argCount = 0;
+  String headerNames[MAX_HEADERS];
+  String headerValues[MAX_HEADERS];
+  uint8_t headerCount = 0;
+  WiFiClient currentClient;
+
+  size_t pendingContentLength = 0;
+  Response* currentResponse = nullptr;
+  String pendingHeaders;
+
+  // Socket transport (emulator only)
+  int listenFd = -1;
+  int clientFd = -1;
+  bool headersSent = false;
+  bool chunked = false;
+  size_t bytesWritten = 0;
+
+  void parseArguments(const String& query);
+  void runHandler(HTTPMethod method, const String& uri, const String& body, Response& response);
+  void writeClient(const char* data, size_t size);
+  void sendStatusAndHeaders(int code, const char* contentType, size_t contentLength);
+  void serveSocketClient(int fd);
+  void storeHeader(const std::string& line);
+};
+
+#endif
@@ -0,0 +1,158 @@
+#include "WiFi.h"
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+
+WiFiClass WiFi;
+
+String IPAddress::toString() const {
+  char buffer[16];
+  snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+  return String(buffer);
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* passphrase) {
+  if (currentMode == WIFI_OFF) currentMode = WIFI_STA;
+
+  bool known = (networkCount == 0);
+  bool authorized = true;
+  for (uint8_t i = 0; i < networkCount; i++) {
+    if (networkSSIDs[i] == ssid) {
+      known = true;
+      rssi = networkRSSIs[i];
+      authorized = networkPasswords[i].length() == 0 ||
+                   networkPasswords[i] == (passphrase ? passphrase : "");
+    }
+  }
+
+  connectedSSID = "";
+  currentStatus = WL_DISCONNECTED;
+  pendingSSID = ssid;
+  pendingReason = !known ? WIFI_REASON_NO_AP_FOUND : !authorized ? WIFI_REASON_AUTH_FAIL : 0;
+  connectPending = true;
+  connectAt = millis() + connectDelayMs;
+  completeConnect();
+  return currentStatus;
+}
+
+void WiFiClass::completeConnect() {
+  if (!connectPending || (long)(millis() - connectAt) < 0) return;
+  connectPending = false;
+
+  if (pendingReason == 0) {
+    connectedSSID = pendingSSID;
+    currentStatus = WL_CONNECTED;
+    raise(ARDUINO_EVENT_WIFI_STA_CONNECTED);
+    raise(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  } else {
+    currentStatus = pendingReason == WIFI_REASON_NO_AP_FOUND ? WL_NO_SSID_AVAIL : WL_CONNECT_FAILED;
+    raise(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, pendingReason);
+  }
+}
+
+void WiFiClass::raise(WiFiEvent_t event, uint8_t reason) {
+  WiFiEventInfo_t info;
+  info.wifi_sta_disconnected.reason = reason;
+  for (uint8_t i = 0; i < handlerCount; i++) {
+    handlers[i](event, info);
+  }
+}
+
+int WiFiClass::onEvent(WiFiEventFuncCb handler) {
+  if (handlerCount >= MAX_HANDLERS) return -1;
+  handlers[handlerCount] = handler;
+  return handlerCount++;
+}
+
+bool WiFiClass::disconnect(bool wifioff) {
+  bool wasConnected = currentStatus == WL_CONNECTED;
+  connectPending = false;
+  connectedSSID = "";
+  currentStatus = WL_DISCONNECTED;
+  if (wifioff) currentMode = WIFI_OFF;
+  if (wasConnected) raise(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, WIFI_REASON_ASSOC_LEAVE);
+  return true;
+}
+
+bool WiFiClass::softAP(const char* ssid, const char* passphrase) {
+  (void)ssid;
+  (void)passphrase;
+  currentMode = (currentMode == WIFI_STA || currentMode == WIFI_AP_STA) ? WIFI_AP_STA : WIFI_AP;
+  return true;
+}
+
+bool WiFiClass::softAPdisconnect(bool wifioff) {
+  if (currentMode == WIFI_AP_STA) {
+    currentMode = WIFI_STA;
+  } else if (currentMode == WIFI_AP && wifioff) {
+    currentMode = WIFI_OFF;
+  }
+  return true;
+}
+
+int16_t WiFiClass::scanNetworks() {
+  return networkCount;
+}
+
+String WiFiClass::SSID(uint8_t index) {
+  return index < networkCount ? networkSSIDs[index] : String();
+}
+
+int32_t WiFiClass::RSSI(uint8_t index) {
+  return index < networkCount ? networkRSSIs[index] : 0;
+}
+
+void WiFiClass::hostAddNetwork(const char* ssid, int32_t networkRssi, const char* password) {
+  if (networkCount >= MAX_NETWORKS) return;
+  networkSSIDs[networkCount] = ssid;
+  networkPasswords[networkCount] = password ? password : "";
+  networkRSSIs[networkCount] = networkRssi;
+  networkCount++;
+}
+
+WiFiClient::WiFiClient(int fd) : socket(std::make_shared<Socket>(fd)) {}
+
+WiFiClient::Socket::~Socket() {
+  close(fd);
+}
+
+uint8_t WiFiClient::connected() {
+  if (!socket) return 0;
+  char probe;
+  ssize_t n = recv(socket->fd, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+  if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+    return 0;
+  }
+  return 1;
+}
+
+int WiFiClient::available() {
+  if (!socket) return 0;
+  int pending = 0;
+  if (ioctl(socket->fd, FIONREAD, &pending) < 0) return 0;
+  return pending;
+}
+
+int WiFiClient::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t size) {
+  if (!socket) return -1;
+  ssize_t n = recv(socket->fd, buffer, size, MSG_DONTWAIT);
+  return n < 0 ? -1 : (int)n;
+}
+
+size_t WiFiClient::write(const uint8_t* buffer, size_t size) {
+  if (!socket) return 0;
+  size_t total = 0;
+  while (total < size) {
+    ssize_t n = send(socket->fd, buffer + total, size - total, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) break;
+    total += n;
+  }
+  return total;
+}
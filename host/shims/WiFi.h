@@ -0,0 +1,161 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include <Arduino.h>
+#include <functional>
+#include <memory>
+
+typedef enum {
+  WIFI_OFF = 0,
+  WIFI_STA = 1,
+  WIFI_AP = 2,
+  WIFI_AP_STA = 3
+} wifi_mode_t;
+
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+// Station events delivered to WiFi.onEvent() handlers (subset of the core's)
+typedef enum {
+  ARDUINO_EVENT_WIFI_STA_CONNECTED,
+  ARDUINO_EVENT_WIFI_STA_DISCONNECTED,
+  ARDUINO_EVENT_WIFI_STA_GOT_IP
+} arduino_event_id_t;
+
+// Disconnect reasons (esp_wifi_types.h)
+typedef enum {
+  WIFI_REASON_ASSOC_LEAVE = 8,
+  WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT = 15,
+  WIFI_REASON_NO_AP_FOUND = 201,
+  WIFI_REASON_AUTH_FAIL = 202,
+  WIFI_REASON_HANDSHAKE_TIMEOUT = 204
+} wifi_err_reason_t;
+
+typedef union {
+  struct {
+    uint8_t reason;
+  } wifi_sta_disconnected;
+} arduino_event_info_t;
+
+typedef arduino_event_id_t WiFiEvent_t;
+typedef arduino_event_info_t WiFiEventInfo_t;
+typedef std::function<void(WiFiEvent_t event, WiFiEventInfo_t info)> WiFiEventFuncCb;
+
+class IPAddress {
+public:
+  IPAddress() {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : octets{a, b, c, d} {}
+  String toString() const;
+  uint8_t operator[](int index) const { return octets[index]; }
+
+private:
+  uint8_t octets[4] = {0, 0, 0, 0};
+};
+
+/*
+ * Host stand-in for the ESP32 WiFiClient: a connected TCP socket shared by
+ * all copies and closed when the last copy goes away, as on the device.
+ */
+class WiFiClient {
+public:
+  WiFiClient() {}
+  // Host only: adopt a connected socket
+  explicit WiFiClient(int fd);
+
+  int fd() const { return socket ? socket->fd : -1; }
+  uint8_t connected();
+  int available();
+  int read();
+  int read(uint8_t* buffer, size_t size);
+  size_t write(const uint8_t* buffer, size_t size);
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+  void stop() { socket.reset(); }
+  explicit operator bool() const { return fd() >= 0; }
+
+private:
+  struct Socket {
+    int fd;
+    explicit Socket(int fd) : fd(fd) {}
+    ~Socket();
+  };
+  std::shared_ptr<Socket> socket;
+};
+
+/*
+ * Host stand-in for the ESP32 WiFi class.
+ *
+ * Connections succeed for any SSID in the simulated scan list (or any SSID
+ * at all when the list is empty) and a matching password, if the network
+ * has one. By default begin() connects immediately; with a connect delay
+ * the station stays disconnected for that long (virtual time) and the
+ * outcome is raised as onEvent() events, as the core does from its event
+ * task. Here they are raised on the caller's task, from the first WiFi call
+ * after the delay.
+ */
+class WiFiClass {
+public:
+  bool mode(wifi_mode_t m) { currentMode = m; return true; }
+  wifi_mode_t getMode() { return currentMode; }
+
+  wl_status_t begin(const char* ssid, const char* passphrase = nullptr);
+  bool disconnect(bool wifioff = false);
+  wl_status_t status() { completeConnect(); return currentStatus; }
+
+  String SSID() { completeConnect(); return connectedSSID; }
+  int32_t RSSI() { return status() == WL_CONNECTED ? rssi : 0; }
+  IPAddress localIP() { return status() == WL_CONNECTED ? stationIP : IPAddress(); }
+
+  bool softAP(const char* ssid, const char* passphrase = nullptr);
+  bool softAPdisconnect(bool wifioff = false);
+  IPAddress softAPIP() { return IPAddress(192, 168, 4, 1); }
+
+  int onEvent(WiFiEventFuncCb handler);
+
+  int16_t scanNetworks();
+  String SSID(uint8_t index);
+  int32_t RSSI(uint8_t index);
+
+  // Host only: control the simulated radio environment
+  void hostSetStatus(wl_status_t status) { currentStatus = status; }
+  void hostSetRSSI(int32_t value) { rssi = value; }
+  void hostAddNetwork(const char* ssid, int32_t networkRssi, const char* password = nullptr);
+  void hostSetConnectDelay(unsigned long ms) { connectDelayMs = ms; }
+
+private:
+  wifi_mode_t currentMode = WIFI_OFF;
+  wl_status_t currentStatus = WL_DISCONNECTED;
+  String connectedSSID;
+  int32_t rssi = -55;
+  IPAddress stationIP = IPAddress(127, 0, 0, 1);
+
+  static const uint8_t MAX_NETWORKS = 8;
+  String networkSSIDs[MAX_NETWORKS];
+  String networkPasswords[MAX_NETWORKS];
+  int32_t networkRSSIs[MAX_NETWORKS] = {0};
+  uint8_t networkCount = 0;
+
+  static const uint8_t MAX_HANDLERS = 4;
+  WiFiEventFuncCb handlers[MAX_HANDLERS];
+  uint8_t handlerCount = 0;
+
+  // Connection in progress: outcome and when it happens (millis)
+  unsigned long connectDelayMs = 0;
+  bool connectPending = false;
+  unsigned long connectAt = 0;
+  String pendingSSID;
+  uint8_t pendingReason = 0;  // 0 = success, else a wifi_err_reason_t
+
+  void completeConnect();
+  void raise(WiFiEvent_t event, uint8_t reason = 0);
+};
+
+extern WiFiClass WiFi;
+
+#endif
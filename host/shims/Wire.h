@@ -0,0 +1,15 @@
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include <Arduino.h>
+
+// I2C bus stand-in; the simulated VL53L1X does not talk over it
+class TwoWire {
+public:
+  bool begin(int sda = -1, int scl = -1) { (void)sda; (void)scl; return true; }
+  bool setClock(uint32_t frequency) { (void)frequency; return true; }
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef HOST_LWIP_SOCKETS_H
+#define HOST_LWIP_SOCKETS_H
+
+// lwIP exposes the BSD socket API; on the host it is the real one
+#include <sys/socket.h>
+
+#endif
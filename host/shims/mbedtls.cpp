@@ -0,0 +1,101 @@
+#include "mbedtls/sha1.h"
+#include "mbedtls/base64.h"
+#include <stdint.h>
+#include <string.h>
+
+static uint32_t rotateLeft(uint32_t value, int bits) {
+  return (value << bits) | (value >> (32 - bits));
+}
+
+static void sha1Block(uint32_t state[5], const unsigned char block[64]) {
+  uint32_t w[80];
+  for (int i = 0; i < 16; i++) {
+    w[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16 |
+           (uint32_t)block[i * 4 + 2] << 8 | block[i * 4 + 3];
+  }
+  for (int i = 16; i < 80; i++) {
+    w[i] = rotateLeft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+  }
+
+  uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+  for (int i = 0; i < 80; i++) {
+    uint32_t f, k;
+    if (i < 20) {
+      f = (b & c) | (~b & d);
+      k = 0x5A827999;
+    } else if (i < 40) {
+      f = b ^ c ^ d;
+      k = 0x6ED9EBA1;
+    } else if (i < 60) {
+      f = (b & c) | (b & d) | (c & d);
+      k = 0x8F1BBCDC;
+    } else {
+      f = b ^ c ^ d;
+      k = 0xCA62C1D6;
+    }
+    uint32_t temp = rotateLeft(a, 5) + f + e + k + w[i];
+    e = d;
+    d = c;
+    c = rotateLeft(b, 30);
+    b = a;
+    a = temp;
+  }
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+}
+
+int mbedtls_sha1(const unsigned char* input, size_t ilen, unsigned char output[20]) {
+  uint32_t state[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+  size_t offset = 0;
+  for (; offset + 64 <= ilen; offset += 64) {
+    sha1Block(state, input + offset);
+  }
+
+  // Final block(s): remaining bytes, 0x80, zero padding, bit length
+  unsigned char tail[128] = {0};
+  size_t rest = ilen - offset;
+  memcpy(tail, input + offset, rest);
+  tail[rest] = 0x80;
+  size_t tailLength = rest + 1 + 8 <= 64 ? 64 : 128;
+  uint64_t bits = (uint64_t)ilen * 8;
+  for (int i = 0; i < 8; i++) {
+    tail[tailLength - 1 - i] = (unsigned char)(bits >> (i * 8));
+  }
+  sha1Block(state, tail);
+  if (tailLength == 128) sha1Block(state, tail + 64);
+
+  for (int i = 0; i < 5; i++) {
+    output[i * 4] = state[i] >> 24;
+    output[i * 4 + 1] = state[i] >> 16;
+    output[i * 4 + 2] = state[i] >> 8;
+    output[i * 4 + 3] = state[i];
+  }
+  return 0;
+}
+
+int mbedtls_base64_encode(unsigned char* dst, size_t dlen, size_t* olen,
+                          const unsigned char* src, size_t slen) {
+  static const char alphabet[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  size_t needed = (slen + 2) / 3 * 4 + 1;
+  *olen = needed;
+  if (dlen < needed) return MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL;
+
+  size_t out = 0;
+  for (size_t i = 0; i < slen; i += 3) {
+    uint32_t chunk = (uint32_t)src[i] << 16;
+    if (i + 1 < slen) chunk |= (uint32_t)src[i + 1] << 8;
+    if (i + 2 < slen) chunk |= src[i + 2];
+    dst[out++] = alphabet[(chunk >> 18) & 0x3F];
+    dst[out++] = alphabet[(chunk >> 12) & 0x3F];
+    dst[out++] = i + 1 < slen ? alphabet[(chunk >> 6) & 0x3F] : '=';
+    dst[out++] = i + 2 < slen ? alphabet[chunk & 0x3F] : '=';
+  }
+  dst[out] = '\0';
+  *olen = out;
+  return 0;
+}
@@ -0,0 +1,9 @@
+#ifndef HOST_MBEDTLS_SHA1_H
+#define HOST_MBEDTLS_SHA1_H
+
+#include <stddef.h>
+
+// Host stand-in for the one-shot SHA-1 of the mbedTLS bundled with the ESP32 core
+int mbedtls_sha1(const unsigned char* input, size_t ilen, unsigned char output[20]);
+
+#endif
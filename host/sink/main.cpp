@@ -0,0 +1,543 @@
+/*
+ * Dough Tracker webhook sink
+ *
+ * A local stand-in for Discord, ntfy, Home Assistant or any other webhook
+ * receiver, so notification delivery can be tested without the internet.
+ * Every request is recorded (method, path, notification headers, body) and
+ * answered after an optional injected delay, with an injected 429 or 5xx
+ * where configured. Each request is logged with the time since the previous
+ * one to the same path, which shows the device's retry backoff directly.
+ *
+ *   doughtracker_webhook_sink [--port 9090] [--status 204] [--latency 0] [--jitter 0]
+ *                             [--error-rate 0] [--error-code 503] [--fail-first 0]
+ *                             [--rate-limit 0] [--window 60] [--record FILE] [--seed 1]
+ *
+ * Point a notification target at it through /api/webhook, e.g.
+ * {"url":"http://localhost:9090/discord"}. The emulator sends loopback
+ * webhooks for real; a device on the LAN can use the host's address.
+ *
+ * Control endpoints, for scripted regression tests:
+ *   GET  /_sink/requests   recorded requests as JSON (the last MAX_RECORDS)
+ *   GET  /_sink/stats      counts per path and status, request gaps, delays
+ *   POST /_sink/config?... change the injection for a path prefix
+ *                          (path, status, latency, jitter, errorRate, errorCode,
+ *                          failNext, rateLimit, window)
+ *   POST /_sink/reset      forget requests, stats and per-path settings
+ * The stats are also printed as JSON on Ctrl+C.
+ */
+
+#include <netdb.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+// What the sink does with requests to one path prefix
+struct Profile {
+  int status = 204;          // Normal answer (Discord's; ntfy answers 200)
+  int latencyMs = 0;         // Delay before answering
+  int jitterMs = 0;          // Plus up to this much, uniformly
+  double errorRate = 0;      // Fraction answered with errorCode
+  int errorCode = 503;
+  unsigned failNext = 0;     // The next N requests get errorCode
+  unsigned rateLimit = 0;    // Requests allowed per window, then 429
+  int windowSeconds = 60;
+
+  // Rate limit window state
+  Clock::time_point windowStart;
+  unsigned windowCount = 0;
+};
+
+struct Record {
+  unsigned long seq;
+  double atMs;               // Since the sink started
+  double gapMs;              // Since the previous request to the path, -1 for the first
+  std::string method;
+  std::string path;
+  std::string headers;       // Content-Type, Authorization, Title, Tags as received
+  std::string body;
+  int status;
+  int delayMs;
+};
+
+struct PathStats {
+  unsigned long requests = 0;
+  std::map<int, unsigned long> statuses;
+  double lastAtMs = -1;
+  double minGapMs = 0;
+  double maxGapMs = 0;
+  double totalGapMs = 0;
+  unsigned long gaps = 0;
+  unsigned long long totalDelayMs = 0;
+  size_t maxBody = 0;
+};
+
+static const size_t MAX_RECORDS = 1000;
+static const size_t MAX_REQUEST = 64 * 1024;
+
+static std::mutex stateMutex;
+static std::map<std::string, Profile> profiles;  // By path prefix, from /_sink/config
+static Profile defaultProfile;
+static std::vector<Record> records;
+static std::map<std::string, PathStats> pathStats;
+static unsigned long nextSeq = 1;
+static Clock::time_point startTime;
+static std::mt19937 rng(1);
+static FILE* recordFile = nullptr;
+static bool quiet = false;
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onSignal(int) {
+  stopRequested = 1;
+}
+
+static double sinceStartMs() {
+  return std::chrono::duration<double, std::milli>(Clock::now() - startTime).count();
+}
+
+static std::string jsonEscape(const std::string& text) {
+  std::string out;
+  for (unsigned char c : text) {
+    switch (c) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if (c < 0x20) {
+          char escape[8];
+          snprintf(escape, sizeof(escape), "\\u%04x", c);
+          out += escape;
+        } else {
+          out += (char)c;
+        }
+    }
+  }
+  return out;
+}
+
+static const char* reasonPhrase(int status) {
+  switch (status) {
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 429: return "Too Many Requests";
+    case 500: return "Internal Server Error";
+    case 502: return "Bad Gateway";
+    case 503: return "Service Unavailable";
+    case 504: return "Gateway Timeout";
+    default: return "Status";
+  }
+}
+
+// Settings of the longest matching configured prefix, else the default
+static Profile& profileFor(const std::string& path) {
+  const std::string* best = nullptr;
+  for (auto& entry : profiles) {
+    if (path.compare(0, entry.first.size(), entry.first) == 0 &&
+        (!best || entry.first.size() > best->size())) {
+      best = &entry.first;
+    }
+  }
+  if (best) return profiles[*best];
+  return defaultProfile;
+}
+
+// Decide the answer for a webhook request; called with stateMutex held
+static int chooseStatus(Profile& profile, int* delayMs, int* retryAfter) {
+  *delayMs = profile.latencyMs;
+  if (profile.jitterMs > 0) {
+    *delayMs += std::uniform_int_distribution<int>(0, profile.jitterMs)(rng);
+  }
+  *retryAfter = 0;
+
+  if (profile.failNext > 0) {
+    profile.failNext--;
+    return profile.errorCode;
+  }
+  if (profile.rateLimit > 0) {
+    Clock::time_point now = Clock::now();
+    std::chrono::seconds window(profile.windowSeconds);
+    if (profile.windowCount == 0 || now - profile.windowStart >= window) {
+      profile.windowStart = now;
+      profile.windowCount = 0;
+    }
+    if (profile.windowCount >= profile.rateLimit) {
+      *retryAfter = (int)std::chrono::duration_cast<std::chrono::seconds>(
+                        profile.windowStart + window - now).count() + 1;
+      return 429;
+    }
+    profile.windowCount++;
+  }
+  if (profile.errorRate > 0 && std::uniform_real_distribution<double>(0, 1)(rng) < profile.errorRate) {
+    return profile.errorCode;
+  }
+  return profile.status;
+}
+
+static std::string queryValue(const std::string& query, const char* key) {
+  std::string prefix = std::string(key) + "=";
+  size_t start = 0;
+  while (start <= query.size()) {
+    size_t end = query.find('&', start);
+    if (end == std::string::npos) end = query.size();
+    if (query.compare(start, prefix.size(), prefix) == 0) {
+      return query.substr(start + prefix.size(), end - start - prefix.size());
+    }
+    start = end + 1;
+  }
+  return "";
+}
+
+// Apply "key=value&..." to the profile of query's path (default profile
+// without one); returns the affected prefix
+static std::string configure(const std::string& query) {
+  std::string prefix = queryValue(query, "path");
+  if (!prefix.empty() && profiles.find(prefix) == profiles.end()) {
+    profiles[prefix] = defaultProfile;  // A new prefix starts from the defaults
+  }
+  Profile& profile = prefix.empty() ? defaultProfile : profiles[prefix];
+  std::string value;
+  if (!(value = queryValue(query, "status")).empty()) profile.status = atoi(value.c_str());
+  if (!(value = queryValue(query, "latency")).empty()) profile.latencyMs = atoi(value.c_str());
+  if (!(value = queryValue(query, "jitter")).empty()) profile.jitterMs = atoi(value.c_str());
+  if (!(value = queryValue(query, "errorRate")).empty()) profile.errorRate = atof(value.c_str());
+  if (!(value = queryValue(query, "errorCode")).empty()) profile.errorCode = atoi(value.c_str());
+  if (!(value = queryValue(query, "failNext")).empty()) profile.failNext = (unsigned)atoi(value.c_str());
+  if (!(value = queryValue(query, "rateLimit")).empty()) profile.rateLimit = (unsigned)atoi(value.c_str());
+  if (!(value = queryValue(query, "window")).empty()) profile.windowSeconds = std::max(1, atoi(value.c_str()));
+  profile.windowCount = 0;
+  return prefix;
+}
+
+static std::string statsJSON() {
+  std::string out = "{\"uptime_ms\":" + std::to_string((long long)sinceStartMs()) + ",\"paths\":{";
+  bool firstPath = true;
+  for (const auto& entry : pathStats) {
+    const PathStats& s = entry.second;
+    char numbers[256];
+    snprintf(numbers, sizeof(numbers),
+             "\"requests\":%lu,\"gap_ms\":{\"min\":%.1f,\"mean\":%.1f,\"max\":%.1f},"
+             "\"mean_delay_ms\":%.1f,\"max_body\":%zu,\"statuses\":{",
+             s.requests, s.minGapMs, s.gaps ? s.totalGapMs / s.gaps : 0.0, s.maxGapMs,
+             s.requests ? (double)s.totalDelayMs / s.requests : 0.0, s.maxBody);
+    out += std::string(firstPath ? "" : ",") + "\"" + jsonEscape(entry.first) + "\":{" + numbers;
+    bool firstStatus = true;
+    for (const auto& status : s.statuses) {
+      out += std::string(firstStatus ? "" : ",") + "\"" + std::to_string(status.first) + "\":" +
+             std::to_string(status.second);
+      firstStatus = false;
+    }
+    out += "}}";
+    firstPath = false;
+  }
+  return out + "}}";
+}
+
+static std::string recordJSON(const Record& r) {
+  char numbers[160];
+  snprintf(numbers, sizeof(numbers), "{\"seq\":%lu,\"at_ms\":%.1f,\"gap_ms\":%.1f,\"status\":%d,\"delay_ms\":%d,",
+           r.seq, r.atMs, r.gapMs, r.status, r.delayMs);
+  return std::string(numbers) + "\"method\":\"" + jsonEscape(r.method) + "\",\"path\":\"" +
+         jsonEscape(r.path) + "\",\"headers\":\"" + jsonEscape(r.headers) + "\",\"body\":\"" +
+         jsonEscape(r.body) + "\"}";
+}
+
+static std::string requestsJSON() {
+  std::string out = "[";
+  for (size_t i = 0; i < records.size(); i++) {
+    out += (i ? "," : "") + recordJSON(records[i]);
+  }
+  return out + "]";
+}
+
+static void sendResponse(int fd, int status, const std::string& body, const char* contentType,
+                         int retryAfter) {
+  std::string response = "HTTP/1.1 " + std::to_string(status) + " " + reasonPhrase(status) +
+                         "\r\nConnection: close\r\n";
+  if (retryAfter > 0) response += "Retry-After: " + std::to_string(retryAfter) + "\r\n";
+  if (status != 204) {
+    response += std::string("Content-Type: ") + contentType + "\r\nContent-Length: " +
+                std::to_string(body.size()) + "\r\n\r\n" + body;
+  } else {
+    response += "\r\n";
+  }
+  const char* data = response.data();
+  size_t remaining = response.size();
+  while (remaining > 0) {
+    ssize_t sent = send(fd, data, remaining, MSG_NOSIGNAL);
+    if (sent <= 0) return;
+    data += sent;
+    remaining -= sent;
+  }
+}
+
+// Read one request: head up to the blank line, then Content-Length bytes
+static bool readRequest(int fd, std::string& head, std::string& body) {
+  std::string data;
+  char buffer[4096];
+  size_t headEnd = std::string::npos;
+  size_t contentLength = 0;
+  while (true) {
+    if (headEnd == std::string::npos) {
+      headEnd = data.find("\r\n\r\n");
+      if (headEnd != std::string::npos) {
+        head = data.substr(0, headEnd);
+        std::string lower = head;
+        std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+        size_t cl = lower.find("\r\ncontent-length:");
+        if (cl != std::string::npos) contentLength = strtoul(head.c_str() + cl + 17, nullptr, 10);
+        if (contentLength > MAX_REQUEST) return false;
+      }
+    }
+    if (headEnd != std::string::npos && data.size() >= headEnd + 4 + contentLength) {
+      body = data.substr(headEnd + 4, contentLength);
+      return true;
+    }
+    if (data.size() > MAX_REQUEST) return false;
+    ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+    if (n <= 0) return false;
+    data.append(buffer, n);
+  }
+}
+
+// The headers a notification formatter sets, one "Name: value" per line
+static std::string notificationHeaders(const std::string& head) {
+  static const char* NAMES[] = {"content-type:", "authorization:", "title:", "tags:"};
+  std::string out;
+  size_t start = head.find("\r\n");
+  while (start != std::string::npos) {
+    size_t end = head.find("\r\n", start + 2);
+    std::string line = head.substr(start + 2, end == std::string::npos ? std::string::npos : end - start - 2);
+    std::string lower = line;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    for (const char* name : NAMES) {
+      if (lower.compare(0, strlen(name), name) == 0) {
+        out += (out.empty() ? "" : "\n") + line;
+      }
+    }
+    start = end;
+  }
+  return out;
+}
+
+static void handleConnection(int fd) {
+  std::string head, body;
+  if (!readRequest(fd, head, body)) {
+    close(fd);
+    return;
+  }
+  size_t methodEnd = head.find(' ');
+  size_t targetEnd = head.find(' ', methodEnd + 1);
+  if (methodEnd == std::string::npos || targetEnd == std::string::npos) {
+    sendResponse(fd, 400, "bad request\n", "text/plain", 0);
+    close(fd);
+    return;
+  }
+  std::string method = head.substr(0, methodEnd);
+  std::string target = head.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+  size_t question = target.find('?');
+  std::string path = target.substr(0, question);
+  std::string query = question == std::string::npos ? "" : target.substr(question + 1);
+
+  if (path.compare(0, 7, "/_sink/") == 0) {
+    std::string response;
+    int status = 200;
+    {
+      std::lock_guard<std::mutex> lock(stateMutex);
+      if (path == "/_sink/requests") {
+        response = requestsJSON();
+      } else if (path == "/_sink/stats") {
+        response = statsJSON();
+      } else if (path == "/_sink/config" && method == "POST") {
+        std::string prefix = configure(query);
+        response = "{\"path\":\"" + jsonEscape(prefix) + "\"}";
+      } else if (path == "/_sink/reset" && method == "POST") {
+        records.clear();
+        pathStats.clear();
+        profiles.clear();
+        response = "{}";
+      } else {
+        status = 404;
+        response = "{\"error\":\"unknown control endpoint\"}";
+      }
+    }
+    sendResponse(fd, status, response, "application/json", 0);
+    close(fd);
+    return;
+  }
+
+  Record record;
+  int retryAfter = 0;
+  {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    record.seq = nextSeq++;
+    record.atMs = sinceStartMs();
+    record.method = method;
+    record.path = path;
+    record.headers = notificationHeaders(head);
+    record.body = body;
+    record.status = chooseStatus(profileFor(path), &record.delayMs, &retryAfter);
+
+    PathStats& s = pathStats[path];
+    record.gapMs = s.lastAtMs < 0 ? -1 : record.atMs - s.lastAtMs;
+    if (record.gapMs >= 0) {
+      if (s.gaps == 0 || record.gapMs < s.minGapMs) s.minGapMs = record.gapMs;
+      if (record.gapMs > s.maxGapMs) s.maxGapMs = record.gapMs;
+      s.totalGapMs += record.gapMs;
+      s.gaps++;
+    }
+    s.lastAtMs = record.atMs;
+    s.requests++;
+    s.statuses[record.status]++;
+    s.totalDelayMs += record.delayMs;
+    s.maxBody = std::max(s.maxBody, body.size());
+
+    if (records.size() == MAX_RECORDS) records.erase(records.begin());
+    records.push_back(record);
+    if (recordFile) {
+      fprintf(recordFile, "%s\n", recordJSON(record).c_str());
+      fflush(recordFile);
+    }
+    if (!quiet) {
+      char gap[32] = "first";
+      if (record.gapMs >= 0) snprintf(gap, sizeof(gap), "+%.1f s", record.gapMs / 1000.0);
+      fprintf(stderr, "[Sink] %8.3f s #%lu %s %s -> %d (delay %d ms, %s) %s\n", record.atMs / 1000.0,
+              record.seq, method.c_str(), path.c_str(), record.status, record.delayMs, gap, body.c_str());
+    }
+  }
+
+  if (record.delayMs > 0) std::this_thread::sleep_for(std::chrono::milliseconds(record.delayMs));
+  const char* answer = record.status >= 200 && record.status < 300 ? "ok\n" : "injected failure\n";
+  sendResponse(fd, record.status, answer, "text/plain", retryAfter);
+  close(fd);
+}
+
+static void usage(const char* argv0) {
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  --port N          port to listen on (default 9090)\n"
+          "  --status CODE     answer to accepted requests (default 204)\n"
+          "  --latency MS      delay before every answer (default 0)\n"
+          "  --jitter MS       plus a uniform random delay up to MS\n"
+          "  --error-rate P    fraction of requests answered with --error-code (0-1)\n"
+          "  --error-code N    injected error status (default 503)\n"
+          "  --fail-first N    answer the first N requests with --error-code\n"
+          "  --rate-limit N    allow N requests per --window, then answer 429 with Retry-After\n"
+          "  --window S        rate limit window in seconds (default 60)\n"
+          "  --record FILE     append every request to FILE as a JSON line\n"
+          "  --seed N          random seed for jitter and --error-rate (default 1)\n"
+          "  --quiet           do not log requests to stderr\n",
+          argv0);
+}
+
+int main(int argc, char** argv) {
+  std::string port = "9090";
+  const char* recordPath = nullptr;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--port" && hasValue) {
+      port = argv[++i];
+    } else if (arg == "--status" && hasValue) {
+      defaultProfile.status = atoi(argv[++i]);
+    } else if (arg == "--latency" && hasValue) {
+      defaultProfile.latencyMs = atoi(argv[++i]);
+    } else if (arg == "--jitter" && hasValue) {
+      defaultProfile.jitterMs = atoi(argv[++i]);
+    } else if (arg == "--error-rate" && hasValue) {
+      defaultProfile.errorRate = atof(argv[++i]);
+    } else if (arg == "--error-code" && hasValue) {
+      defaultProfile.errorCode = atoi(argv[++i]);
+    } else if (arg == "--fail-first" && hasValue) {
+      defaultProfile.failNext = (unsigned)atoi(argv[++i]);
+    } else if (arg == "--rate-limit" && hasValue) {
+      defaultProfile.rateLimit = (unsigned)atoi(argv[++i]);
+    } else if (arg == "--window" && hasValue) {
+      defaultProfile.windowSeconds = std::max(1, atoi(argv[++i]));
+    } else if (arg == "--record" && hasValue) {
+      recordPath = argv[++i];
+    } else if (arg == "--seed" && hasValue) {
+      rng.seed((unsigned)atoi(argv[++i]));
+    } else if (arg == "--quiet") {
+      quiet = true;
+    } else {
+      usage(argv[0]);
+      return arg == "--help" || arg == "-h" ? 0 : 1;
+    }
+  }
+
+  if (recordPath) {
+    recordFile = fopen(recordPath, "a");
+    if (!recordFile) {
+      fprintf(stderr, "Cannot open %s\n", recordPath);
+      return 1;
+    }
+  }
+
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET6;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE;
+  struct addrinfo* result = nullptr;
+  int listenFd = -1;
+  if (getaddrinfo(nullptr, port.c_str(), &hints, &result) == 0) {
+    listenFd = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+    int on = 1;
+    int off = 0;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    setsockopt(listenFd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));  // IPv4 too
+    if (bind(listenFd, result->ai_addr, result->ai_addrlen) != 0 || listen(listenFd, 64) != 0) {
+      close(listenFd);
+      listenFd = -1;
+    }
+    freeaddrinfo(result);
+  }
+  if (listenFd < 0) {
+    fprintf(stderr, "Cannot listen on port %s\n", port.c_str());
+    return 1;
+  }
+
+  // No SA_RESTART, so accept() returns on Ctrl+C
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = onSignal;
+  sigaction(SIGINT, &action, nullptr);
+  sigaction(SIGTERM, &action, nullptr);
+
+  startTime = Clock::now();
+  fprintf(stderr, "[Sink] Listening on port %s\n", port.c_str());
+
+  while (!stopRequested) {
+    int fd = accept(listenFd, nullptr, nullptr);
+    if (fd < 0) continue;
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    // A thread per connection: an injected delay must not hold up the
+    // device's other targets, which it sends to concurrently
+    std::thread(handleConnection, fd).detach();
+  }
+  close(listenFd);
+
+  std::lock_guard<std::mutex> lock(stateMutex);
+  printf("%s\n", statsJSON().c_str());
+  if (recordFile) fclose(recordFile);
+  return 0;
+}